@@ -0,0 +1,89 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/grammar/flat_ast.hpp"
+#include "lust/grammar/operator_expr.hpp"
+#include "source_generator.hpp"
+
+#include <string>
+
+using namespace lust::grammar;
+
+// Name collection over the node tree, through the traversal tooling uses
+void collect_names(const IASTNode* node, uint64_t& checksum) {
+    if (node->get_type() == GrammarRule::QUALIFIED_NAME_USAGE) {
+        checksum += static_cast<const ASTNode_QualifiedName*>(node)->qualified_name.name.id;
+    }
+    node->for_each_child([&checksum] (const IASTNode* child) {
+        collect_names(child, checksum);
+    });
+}
+
+void entry() {
+    constexpr size_t source_size = 16 << 20;
+    const std::string source = make_program_source(source_size);
+
+    lust::lexer::TokenStream lexer = lust::lexer::ITokenizer::create(source);
+    const lust::lexer::TokenBuffer tokens = lexer->tokenize_all();
+    const Ast program = IParser::create(tokens)->parse();
+
+    FlatAst flat;
+    const double build_ns = measure_best_ns(3, [&] {
+        flat = FlatAst::build(*program);
+        do_not_optimize(flat.size());
+    });
+    report("FlatAst::build()", build_ns, flat.size());
+
+    uint64_t tree_checksum = 0;
+    const double tree_ns = measure_best_ns(3, [&] {
+        tree_checksum = 0;
+        collect_names(program.get(), tree_checksum);
+        do_not_optimize(tree_checksum);
+    });
+    report("names, node tree", tree_ns, flat.size());
+
+    uint64_t flat_checksum = 0;
+    const double flat_ns = measure_best_ns(3, [&] {
+        flat_checksum = 0;
+        const uint8_t* kinds = flat.kinds().data();
+        for (NodeIndex node = 0; node < flat.size(); ++node) {
+            if (kinds[node] == static_cast<uint8_t>(GrammarRule::QUALIFIED_NAME_USAGE)) {
+                flat_checksum += flat.qualified_name(node).back().id;
+            }
+        }
+        do_not_optimize(flat_checksum);
+    });
+    report("names, flat scan", flat_ns, flat.size());
+
+    // Operands come after their operator, a backwards scan folds them first
+    size_t folded = 0;
+    lust::vector<uint64_t> values;
+    lust::vector<uint8_t> is_constant;
+    const double fold_ns = measure_best_ns(3, [&] {
+        values.resize(flat.size());
+        is_constant.resize(flat.size());
+        folded = 0;
+        for (NodeIndex node = static_cast<NodeIndex>(flat.size()); node-- > 0;) {
+            is_constant[node] = 0;
+            if (flat.kind(node) == GrammarRule::INTEGER_LITERAL) {
+                is_constant[node] = 1;
+                values[node] = flat.integer_value(node);
+            } else if (flat.kind(node) == GrammarRule::OPERATOR && flat.child_count(node) == 2) {
+                const NodeIndex left = flat.first_child(node);
+                const NodeIndex right = flat.next_sibling(left);
+                if (is_constant[left] && is_constant[right] && flat.operator_type(node) == OperatorType::ARITHMETIC_MULTIPLY) {
+                    is_constant[node] = 1;
+                    values[node] = values[left] * values[right];
+                    ++folded;
+                }
+            }
+        }
+        do_not_optimize(folded);
+    });
+    report("constant folding, flat scan", fold_ns, flat.size());
+
+    const size_t flat_bytes = flat.size() * (3 * sizeof(uint8_t) + 3 * sizeof(uint32_t)) + flat.symbols().size() * sizeof(lust::Symbol);
+    std::cout << "  " << flat.size() << " nodes, " << static_cast<double>(flat_bytes) / flat.size() << " bytes per node flat vs "
+        << static_cast<double>(program.arena().bytes_reserved()) / flat.size() << " in the arena, scan speedup: " << tree_ns / flat_ns << "x"
+        << (tree_checksum == flat_checksum ? "" : ", CHECKSUM MISMATCH") << std::endl;
+}
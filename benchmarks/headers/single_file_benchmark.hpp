@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+void entry();
+
+int main() {
+    std::cout << "Running benchmark '" << LUST_BENCHMARK_NAME << "'" << std::endl;
+    entry();
+    return 0;
+}
+
+/**
+ * @brief Keep `value` alive so the measured work can't be optimized out
+ */
+template <typename T>
+void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief Run `fn` `repeat` times and return the best wall time in nanoseconds
+ */
+template <typename Fn>
+double measure_best_ns(size_t repeat, Fn&& fn) {
+    double best = 0;
+    for (size_t i = 0; i < repeat; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+        if (i == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+inline void report(std::string_view label, double total_ns, size_t operations) {
+    std::cout << "  " << label << ": " << total_ns / 1e6 << " ms";
+    if (operations > 0) {
+        std::cout << ", " << total_ns / static_cast<double>(operations) << " ns/op";
+    }
+    std::cout << std::endl;
+}
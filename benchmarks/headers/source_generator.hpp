@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+/**
+ * @brief Generated code style: long identifiers, deep indentation, comments and string literals
+ * @param multi_line_strings Also emit string literals spanning several lines
+ */
+inline std::string make_source(size_t bytes, bool multi_line_strings = false) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> ident_length(4, 40);
+    std::uniform_int_distribution<size_t> indent(0, 24);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<int> kind(0, 9);
+
+    auto ident = [&] {
+        std::string s(ident_length(rng), 'a');
+        for (char& c : s) {
+            c = static_cast<char>('a' + letter(rng));
+        }
+        return s;
+    };
+
+    std::string source;
+    source.reserve(bytes + 256);
+    while (source.size() < bytes) {
+        source.append(indent(rng), ' ');
+        switch (kind(rng)) {
+            case 0:
+                source += "// " + ident() + " " + ident() + " " + ident() + "\n";
+                break;
+            case 1:
+                source += "let " + ident() + " = \"" + ident() + " " + ident() + "\\n\";\n";
+                break;
+            case 2:
+                if (multi_line_strings) {
+                    source += "let " + ident() + " = \"" + ident() + "\n" + ident() + "\n\";\n";
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                source += "let mut " + ident() + ": " + ident() + " = " + ident() + " + 1234567 * " + ident() + ";\n";
+                break;
+        }
+    }
+    return source;
+}
+
+/**
+ * @brief Declarations the parser accepts: attributed functions with parameters, statements and calls, structs and constants
+ */
+inline std::string make_program_source(size_t bytes) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> ident_length(3, 16);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<size_t> statement_count(2, 12);
+    std::uniform_int_distribution<int> kind(0, 5);
+
+    // No keyword starts with `q`
+    auto ident = [&] {
+        std::string s(ident_length(rng), 'q');
+        for (size_t i = 1; i < s.size(); ++i) {
+            s[i] = static_cast<char>('a' + letter(rng));
+        }
+        return s;
+    };
+
+    std::string source;
+    source.reserve(bytes + 1024);
+    while (source.size() < bytes) {
+        switch (kind(rng)) {
+            case 0:
+                source += "struct " + ident() + "<T> {\n    " + ident() + ": u32,\n    " + ident() + ": Option<T>,\n}\n";
+                break;
+            case 1:
+                source += "const " + ident() + " = 123.5;\n";
+                break;
+            default: {
+                source += "#[inline]\npub fn " + ident() + "(" + ident() + ": u32, " + ident() + ": Vec<u8>) -> u32 {\n";
+                const size_t count = statement_count(rng);
+                for (size_t i = 0; i < count; ++i) {
+                    const std::string a = ident();
+                    const std::string b = ident();
+                    switch (i % 4) {
+                        case 0: source += "    let " + a + ": u32 = " + b + " + " + ident() + " * 3;\n"; break;
+                        case 1: source += "    let mut " + a + " = " + ident() + "(" + b + ", 12) - " + b + " / 2;\n"; break;
+                        case 2: source += "    " + a + " += " + ident() + "::" + b + "(" + a + ");\n"; break;
+                        default: source += "    let " + a + " = { " + b + " + 1 };\n"; break;
+                    }
+                }
+                source += "    " + ident() + "\n}\n";
+                break;
+            }
+        }
+    }
+    return source;
+}
@@ -0,0 +1,46 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "source_generator.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+void entry() {
+    // About 100k lines
+    constexpr size_t source_size = 5 << 20;
+    const std::string source = make_source(source_size);
+    const size_t line_count = std::count(source.begin(), source.end(), '\n');
+
+    double full_ns = measure_best_ns(3, [&] {
+        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(source);
+        do_not_optimize(tokens->tokenize_all().size());
+    });
+    report("full relex", full_ns, 1);
+
+    // Typing: insert a space then delete it again, at random places
+    // A letter right after a number is a lexing error, the document ends there and the next edit relexes the whole tail
+    constexpr size_t keystroke_count = 1000;
+    std::mt19937 rng(3);
+    std::vector<int64_t> offsets(keystroke_count);
+    for (int64_t& offset : offsets) {
+        offset = std::uniform_int_distribution<int64_t>(0, source.size() - 1)(rng);
+    }
+
+    lust::lexer::TokenStream editor = lust::lexer::ITokenizer::create(source);
+    editor->document_tokens();
+    size_t relexed = 0;
+    double edit_ns = measure_best_ns(1, [&] {
+        relexed = 0;
+        for (int64_t offset : offsets) {
+            relexed += editor->apply_edit(offset, 0, " ").inserted_count;
+            relexed += editor->apply_edit(offset, 1, "").inserted_count;
+        }
+        do_not_optimize(relexed);
+    });
+    report("apply_edit()", edit_ns, keystroke_count * 2);
+
+    std::cout << "  " << line_count << " lines, " << static_cast<double>(relexed) / (keystroke_count * 2) << " tokens relexed per keystroke, speedup: "
+        << full_ns / (edit_ns / (keystroke_count * 2)) << "x" << std::endl;
+}
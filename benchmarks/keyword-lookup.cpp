@@ -0,0 +1,87 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "lust/lexer/keyword_table.hpp"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // The previous implementation of Tokenizer::lookup_keyword, kept as the baseline
+    lust::lexer::TerminalTokenType lookup_keyword_with_map(std::string_view text) {
+        static const std::unordered_map<std::string, lust::lexer::TerminalTokenType> keywords = [] {
+            std::unordered_map<std::string, lust::lexer::TerminalTokenType> map;
+            for (const lust::lexer::KeywordSpec& spec : lust::lexer::keyword_specs) {
+                map.emplace(std::string(spec.spelling), spec.type);
+            }
+            return map;
+        }();
+
+        if (auto it = keywords.find(std::string(text)); it != keywords.end()) {
+            return it->second;
+        }
+
+        return lust::lexer::TerminalTokenType::IDENT;
+    }
+
+    // Roughly a quarter keywords, the rest identifiers from 1 to 32 chars
+    std::vector<std::string> make_corpus(size_t count) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> keyword_pick(0, lust::lexer::keyword_count - 1);
+        std::uniform_int_distribution<int> kind(0, 3);
+        std::uniform_int_distribution<size_t> length(1, 32);
+        std::uniform_int_distribution<int> letter(0, 25);
+
+        std::vector<std::string> corpus;
+        corpus.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (kind(rng) == 0) {
+                corpus.emplace_back(lust::lexer::keyword_specs[keyword_pick(rng)].spelling);
+            } else {
+                std::string ident(length(rng), 'a');
+                for (char& c : ident) {
+                    c = static_cast<char>('a' + letter(rng));
+                }
+                corpus.push_back(std::move(ident));
+            }
+        }
+        return corpus;
+    }
+}
+
+void entry() {
+    constexpr size_t corpus_size = 1 << 20;
+    const std::vector<std::string> corpus = make_corpus(corpus_size);
+
+    std::vector<std::string_view> views(corpus.begin(), corpus.end());
+
+    for (std::string_view v : views) {
+        if (lookup_keyword_with_map(v) != lust::lexer::lookup_keyword(v)) {
+            std::cerr << "Mismatched lookup result for '" << v << "'" << std::endl;
+            return;
+        }
+    }
+
+    size_t keyword_hits = 0;
+    double map_ns = measure_best_ns(5, [&] {
+        keyword_hits = 0;
+        for (std::string_view v : views) {
+            keyword_hits += lookup_keyword_with_map(v) != lust::lexer::TerminalTokenType::IDENT;
+        }
+        do_not_optimize(keyword_hits);
+    });
+    report("std::unordered_map<std::string>", map_ns, corpus_size);
+
+    double perfect_hash_ns = measure_best_ns(5, [&] {
+        keyword_hits = 0;
+        for (std::string_view v : views) {
+            keyword_hits += lust::lexer::lookup_keyword(v) != lust::lexer::TerminalTokenType::IDENT;
+        }
+        do_not_optimize(keyword_hits);
+    });
+    report("perfect hash", perfect_hash_ns, corpus_size);
+
+    std::cout << "  keywords: " << keyword_hits << "/" << corpus_size << ", speedup: " << map_ns / perfect_hash_ns << "x" << std::endl;
+}
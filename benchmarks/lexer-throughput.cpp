@@ -0,0 +1,47 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "lust/simd_scan.hpp"
+#include "source_generator.hpp"
+
+#include <string>
+
+void entry() {
+    constexpr size_t source_size = 64 << 20;
+    const std::string source = make_source(source_size);
+
+    const lust::simd::SimdLevel supported = lust::simd::detect_simd_level();
+    for (uint32_t level = 0; level <= static_cast<uint32_t>(supported); ++level) {
+        lust::simd::set_simd_level(static_cast<lust::simd::SimdLevel>(level));
+
+        size_t token_count = 0;
+        double ns = measure_best_ns(3, [&] {
+            lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(source);
+            token_count = 0;
+            while (tokens->next_token().type != lust::lexer::TerminalTokenType::END) {
+                ++token_count;
+            }
+            do_not_optimize(token_count);
+        });
+
+        report(lust::simd::simd_level_to_name(static_cast<lust::simd::SimdLevel>(level)), ns, token_count);
+        std::cout << "    " << static_cast<double>(source.size()) / (ns / 1e9) / (1 << 20) << " MiB/s" << std::endl;
+
+        double validate_ns = measure_best_ns(3, [&] {
+            do_not_optimize(lust::simd::find_invalid_utf8(source.data(), source.data() + source.size()));
+        });
+        std::cout << "    UTF-8 validation: " << static_cast<double>(source.size()) / (validate_ns / 1e9) / (1 << 20) << " MiB/s" << std::endl;
+    }
+
+    lust::simd::set_simd_level(supported);
+
+    size_t buffered_tokens = 0;
+    double batch_ns = measure_best_ns(3, [&] {
+        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(source);
+        lust::lexer::TokenBuffer buffer = tokens->tokenize_all();
+        buffered_tokens = buffer.size();
+        do_not_optimize(buffered_tokens);
+    });
+    report("tokenize_all", batch_ns, buffered_tokens);
+    std::cout << "    token storage: " << buffered_tokens * (sizeof(uint8_t) + 3 * sizeof(uint32_t)) / (1 << 20) << " MiB in a TokenBuffer, "
+        << buffered_tokens * sizeof(lust::lexer::Token) / (1 << 20) << " MiB as Token structs" << std::endl;
+}
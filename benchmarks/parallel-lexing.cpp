@@ -0,0 +1,31 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "source_generator.hpp"
+
+#include <string>
+#include <thread>
+
+void entry() {
+    constexpr size_t source_size = 100 << 20;
+    const std::string source = make_source(source_size, true);
+
+    std::cout << "  hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    double single_ns = 0;
+    for (uint32_t threads : { 1u, 2u, 4u, 8u, 16u }) {
+        size_t token_count = 0;
+        double ns = measure_best_ns(3, [&] {
+            lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(source);
+            lust::lexer::TokenBuffer buffer = tokens->tokenize_all_parallel(threads);
+            token_count = buffer.size();
+            do_not_optimize(token_count);
+        });
+        if (threads == 1) {
+            single_ns = ns;
+        }
+
+        report(std::to_string(threads) + " threads", ns, token_count);
+        std::cout << "    " << static_cast<double>(source.size()) / (ns / 1e9) / (1 << 20) << " MiB/s, "
+            << single_ns / ns << "x over 1 thread" << std::endl;
+    }
+}
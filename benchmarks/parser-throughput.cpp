@@ -0,0 +1,85 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "source_generator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+
+// Replacing the global operator new here also counts the allocations made inside the frontend library
+static std::atomic<size_t> allocation_count{ 0 };
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void entry() {
+    constexpr size_t source_size = 16 << 20;
+    const std::string source = make_program_source(source_size);
+
+    lust::lexer::TokenStream lexer = lust::lexer::ITokenizer::create(source);
+    const lust::lexer::TokenBuffer tokens = lexer->tokenize_all();
+
+    // Parsing and tearing the tree down are timed apart, the best run of each is kept
+    bool error_occurred = false;
+    double parse_ns = 0;
+    double teardown_ns = 0;
+    for (size_t run = 0; run < 3; ++run) {
+        lust::UniquePtr<lust::grammar::IParser> parser = lust::grammar::IParser::create(tokens);
+        std::optional<lust::grammar::Ast> program;
+
+        const auto begin = std::chrono::steady_clock::now();
+        program.emplace(parser->parse());
+        const auto parsed = std::chrono::steady_clock::now();
+        do_not_optimize(program->get());
+        program.reset();
+        const auto destroyed = std::chrono::steady_clock::now();
+
+        error_occurred = parser->is_error_occurred();
+        const double run_parse_ns = std::chrono::duration<double, std::nano>(parsed - begin).count();
+        const double run_teardown_ns = std::chrono::duration<double, std::nano>(destroyed - parsed).count();
+        parse_ns = run == 0 ? run_parse_ns : std::min(parse_ns, run_parse_ns);
+        teardown_ns = run == 0 ? run_teardown_ns : std::min(teardown_ns, run_teardown_ns);
+    }
+
+    report("parse()", parse_ns, tokens.size());
+    std::cout << "    " << static_cast<double>(source.size()) / (parse_ns / 1e9) / (1 << 20) << " MiB/s, " << tokens.size() << " tokens"
+        << (error_occurred ? ", with errors" : "") << std::endl;
+    report("teardown", teardown_ns, tokens.size());
+
+    // Every statement and declaration of the generated program ends with `;` or `}`
+    size_t statement_count = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const lust::lexer::TerminalTokenType type = tokens.type_at(i);
+        statement_count += type == lust::lexer::TerminalTokenType::SEMICOLON || type == lust::lexer::TerminalTokenType::RBRACE;
+    }
+    // Arena blocks are taken from malloc directly, they are reported apart
+    const size_t allocations_before = allocation_count.load();
+    size_t arena_blocks = 0;
+    {
+        lust::UniquePtr<lust::grammar::IParser> parser = lust::grammar::IParser::create(tokens);
+        lust::grammar::Ast program = parser->parse();
+        arena_blocks = program.arena().block_count();
+        do_not_optimize(program.get());
+    }
+    const size_t allocations = allocation_count.load() - allocations_before;
+    std::cout << "    " << allocations << " allocations, " << static_cast<double>(allocations) / statement_count << " per statement, "
+        << arena_blocks << " arena blocks" << std::endl;
+}
@@ -0,0 +1,133 @@
+#include "single_file_benchmark.hpp"
+#include "lust/lexer.hpp"
+#include "lust/lexer/token_table.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using lust::lexer::PunctuatorDfa;
+using lust::lexer::TerminalTokenType;
+
+namespace
+{
+    /**
+     * @brief The previous hand-written switch of Tokenizer::next_token(), kept as the baseline.
+     * `/=` is added, the switch used to lex it as SLASH then EQ.
+     */
+    PunctuatorDfa::Match match_with_switch(const char* p, const char* end) {
+        auto next_is = [&](char c) { return p + 1 < end && p[1] == c; };
+        auto next2_is = [&](char c) { return p + 2 < end && p[2] == c; };
+
+        switch (*p) {
+            case '=': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::EQEQ, 2 } : PunctuatorDfa::Match{ TerminalTokenType::EQ, 1 };
+            case '!': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::NEQ, 2 } : PunctuatorDfa::Match{ TerminalTokenType::NOT, 1 };
+            case '<': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::LTE, 2 } : PunctuatorDfa::Match{ TerminalTokenType::LT, 1 };
+            case '>': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::GTE, 2 } : PunctuatorDfa::Match{ TerminalTokenType::GT, 1 };
+            case '+':
+                return next_is('+') ? PunctuatorDfa::Match{ TerminalTokenType::PLUSPLUS, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::PLUS_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::PLUS, 1 };
+            case '-':
+                return next_is('-') ? PunctuatorDfa::Match{ TerminalTokenType::MINUSMINUS, 2 }
+                    : next_is('>') ? PunctuatorDfa::Match{ TerminalTokenType::ARROW, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::MINUS_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::MINUS, 1 };
+            case '*':
+                return next_is('*') ? PunctuatorDfa::Match{ TerminalTokenType::STARSTAR, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::STAR_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::STAR, 1 };
+            case '/':
+                return next_is('/') ? PunctuatorDfa::Match{ TerminalTokenType::COMMENT, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::SLASH_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::SLASH, 1 };
+            case '(': return { TerminalTokenType::LPAREN, 1 };
+            case ')': return { TerminalTokenType::RPAREN, 1 };
+            case '{': return { TerminalTokenType::LBRACE, 1 };
+            case '}': return { TerminalTokenType::RBRACE, 1 };
+            case ';': return { TerminalTokenType::SEMICOLON, 1 };
+            case ':': return next_is(':') ? PunctuatorDfa::Match{ TerminalTokenType::COLONCOLON, 2 } : PunctuatorDfa::Match{ TerminalTokenType::COLON, 1 };
+            case '.':
+                return next_is('.') ? (next2_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::RANGEEQ, 3 } : PunctuatorDfa::Match{ TerminalTokenType::RANGE, 2 })
+                    : PunctuatorDfa::Match{ TerminalTokenType::DOT, 1 };
+            case ',': return { TerminalTokenType::COMMA, 1 };
+            case '\'': return { TerminalTokenType::SQ, 1 };
+            case '"': return { TerminalTokenType::DQ, 1 };
+            case '[': return { TerminalTokenType::LBRACKET, 1 };
+            case ']': return { TerminalTokenType::RBRACKET, 1 };
+            case '|':
+                return next_is('|') ? PunctuatorDfa::Match{ TerminalTokenType::OR, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::OR_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::BITOR, 1 };
+            case '&':
+                return next_is('&') ? PunctuatorDfa::Match{ TerminalTokenType::AND, 2 }
+                    : next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::AND_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::BITAND, 1 };
+            case '^': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::XOR_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::BITXOR, 1 };
+            case '~': return { TerminalTokenType::BITINV, 1 };
+            case '#':
+                return next_is('[') ? PunctuatorDfa::Match{ TerminalTokenType::ATTRIBUTE_START, 2 }
+                    : next_is('!') ? PunctuatorDfa::Match{ TerminalTokenType::GLOBAL_ATTRIBUTE_START, 2 } : PunctuatorDfa::Match{ TerminalTokenType::HASH, 1 };
+            case '%': return next_is('=') ? PunctuatorDfa::Match{ TerminalTokenType::PRECENTAGE_EQUAL, 2 } : PunctuatorDfa::Match{ TerminalTokenType::PRECENTAGE, 1 };
+            default: return {};
+        }
+    }
+
+    // Every punctuator of the token table with the same odds, one space between them
+    std::string make_corpus(size_t count) {
+        std::vector<std::string_view> spellings;
+        for (const lust::lexer::TokenSpec& spec : lust::lexer::token_specs) {
+            if (spec.kind == lust::lexer::TokenKind::PUNCTUATOR) {
+                spellings.push_back(spec.spelling);
+            }
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, spellings.size() - 1);
+        std::string corpus;
+        for (size_t i = 0; i < count; ++i) {
+            corpus += spellings[pick(rng)];
+            corpus += ' ';
+        }
+        return corpus;
+    }
+
+    template <typename Matcher>
+    size_t scan(const std::string& corpus, Matcher&& matcher) {
+        const char* p = corpus.data();
+        const char* const end = p + corpus.size();
+        size_t checksum = 0;
+        while (p < end) {
+            const PunctuatorDfa::Match match = matcher(p, end);
+            checksum += static_cast<size_t>(match.type);
+            p += match.length + 1;
+        }
+        return checksum;
+    }
+}
+
+void entry() {
+    constexpr size_t corpus_size = 1 << 20;
+    const std::string corpus = make_corpus(corpus_size);
+
+    auto with_dfa = [](const char* p, const char* end) { return lust::lexer::punctuator_dfa.match(p, end); };
+
+    for (const char* p = corpus.data(); p < corpus.data() + corpus.size();) {
+        const PunctuatorDfa::Match expected = match_with_switch(p, corpus.data() + corpus.size());
+        const PunctuatorDfa::Match actual = with_dfa(p, corpus.data() + corpus.size());
+        if (expected.type != actual.type || expected.length != actual.length) {
+            std::cerr << "Mismatched match at offset " << (p - corpus.data()) << std::endl;
+            return;
+        }
+        p += actual.length + 1;
+    }
+
+    size_t checksum = 0;
+    const double switch_ns = measure_best_ns(5, [&] {
+        checksum = scan(corpus, match_with_switch);
+        do_not_optimize(checksum);
+    });
+    report("hand-written switch", switch_ns, corpus_size);
+
+    const double dfa_ns = measure_best_ns(5, [&] {
+        checksum = scan(corpus, with_dfa);
+        do_not_optimize(checksum);
+    });
+    report("table-driven DFA", dfa_ns, corpus_size);
+
+    std::cout << "  " << lust::lexer::punctuator_dfa.state_count() << " states, speedup: " << switch_ns / dfa_ns << "x" << std::endl;
+}
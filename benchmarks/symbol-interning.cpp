@@ -0,0 +1,103 @@
+#include "single_file_benchmark.hpp"
+#include "lust/symbol.hpp"
+#include "lust/container/simple_string.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // `distinct` identifiers from 4 to 24 chars, repeated in random order like names in real code
+    std::vector<std::string> make_names(size_t count, size_t distinct) {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<size_t> length(4, 24);
+        std::uniform_int_distribution<int> letter(0, 25);
+
+        std::vector<std::string> pool;
+        for (size_t i = 0; i < distinct; ++i) {
+            std::string ident(length(rng), 'a');
+            for (char& c : ident) {
+                c = static_cast<char>('a' + letter(rng));
+            }
+            pool.push_back(std::move(ident));
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, distinct - 1);
+        std::vector<std::string> names;
+        names.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back(pool[pick(rng)]);
+        }
+        return names;
+    }
+}
+
+void entry() {
+    constexpr size_t name_count = 1 << 20;
+
+    for (size_t distinct : { size_t(500), size_t(50000), name_count }) {
+        const std::vector<std::string> names = make_names(name_count, distinct);
+        std::cout << "  " << distinct << " distinct names" << std::endl;
+
+        double cold_ns = measure_best_ns(1, [&] {
+            lust::SymbolTable table;
+            for (const std::string& name : names) {
+                do_not_optimize(table.intern(name));
+            }
+        });
+        report("intern into an empty table", cold_ns, name_count);
+
+        lust::SymbolTable table;
+        std::vector<lust::Symbol> symbols;
+        for (const std::string& name : names) {
+            symbols.push_back(table.intern(name));
+        }
+
+        double warm_ns = measure_best_ns(3, [&] {
+            for (const std::string& name : names) {
+                do_not_optimize(table.intern(name));
+            }
+        });
+        report("intern existing names", warm_ns, name_count);
+
+        const uint32_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+        double shared_ns = measure_best_ns(3, [&] {
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = t; i < names.size(); i += thread_count) {
+                        do_not_optimize(table.intern(names[i]));
+                    }
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        });
+        report("intern existing names, shared by " + std::to_string(thread_count) + " threads", shared_ns, name_count);
+
+        // What the AST paid per name before: an owned copy, compared with memcmp
+        std::vector<lust::simple_string> strings(names.begin(), names.end());
+        size_t equal = 0;
+        double string_compare_ns = measure_best_ns(3, [&] {
+            equal = 0;
+            for (size_t i = 1; i < strings.size(); ++i) {
+                equal += strings[i] == strings[i - 1];
+            }
+            do_not_optimize(equal);
+        });
+        report("simple_string ==", string_compare_ns, name_count);
+
+        double symbol_compare_ns = measure_best_ns(3, [&] {
+            equal = 0;
+            for (size_t i = 1; i < symbols.size(); ++i) {
+                equal += symbols[i] == symbols[i - 1];
+            }
+            do_not_optimize(equal);
+        });
+        report("Symbol ==", symbol_compare_ns, name_count);
+    }
+}
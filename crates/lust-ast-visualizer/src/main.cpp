@@ -2,27 +2,29 @@
 #include "graphviz/gvc.h"
 #include "graphviz/cgraph.h"
 #include "graphviz/gvcext.h"
+#include "lust/container/string_builder.hpp"
 #include "lust/container/unique_ptr.hpp"
 #include "lust/container/vector.hpp"
 #include "lust/grammar.hpp"
+#include "lust/grammar/ast_visitor.hpp"
 #include "lust/lexer.hpp"
 #include "lust/parser.hpp"
 #include <exception>
-#include <functional>
 #include <iostream>
 #include <cstdio>
-#include <sstream>
 #include <exception>
 #include <atomic>
 #include <string>
+#include <utility>
 
 std::string read_stdin() {
-    std::stringstream ss;
-    char c;
-    while ((c = getchar()) != EOF) {
-        ss << c;
+    std::string text;
+    char chunk[1 << 16];
+    size_t read_size;
+    while ((read_size = std::fread(chunk, 1, sizeof(chunk), stdin)) > 0) {
+        text.append(chunk, read_size);
     }
-    return ss.str();
+    return text;
 }
 
 size_t get_unique_id() {
@@ -30,12 +32,28 @@ size_t get_unique_id() {
     return at.fetch_add(1);
 }
 
-std::string get_unique_name(std::string_view sv) {
-    std::stringstream ss;
-    ss << sv << '_' << get_unique_id();
-    return ss.str();
+lust::simple_string get_unique_name(std::string_view sv) {
+    // Graphviz copies the names, one buffer serves every node
+    static lust::string_builder builder;
+    builder << sv << '_' << get_unique_id();
+    return builder.build();
 }
 
+// Adds a graph node per AST node, linked to the graph node of its parent
+struct GraphBuilder : lust::grammar::ASTVisitor<GraphBuilder> {
+    Agraph_t* graph;
+    Agnode_t* parent_node;
+
+    void visit_node(const lust::grammar::IASTNode& node) {
+        Agnode_t* new_node = agnode(graph, get_unique_name(node.get_name()).data(), 1);
+        agedge(graph, parent_node, new_node, get_unique_name("CHILD").data(), 1);
+
+        Agnode_t* const outer = std::exchange(parent_node, new_node);
+        visit_children(node);
+        parent_node = outer;
+    }
+};
+
 int main(int argc, char* argv[]) {
     try {
         cxxopts::Options options("Lust-ASTVisualizer", "Visualize the AST nodes");
@@ -60,30 +78,33 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
+        // The AST has no place for comments, don't even lex them as tokens
+        lust::lexer::TokenizerOptions tokenizer_options;
+        tokenizer_options.comments = lust::lexer::CommentMode::SKIP;
+
+        lust::lexer::TokenStream tokens = nullptr;
         if (cli_args.count("file")) {
-            std::freopen(cli_args["file"].as<std::string>().c_str(), "r", stdin);
+            // Lexed in place from a memory mapping, the file is never copied
+            const std::string path = cli_args["file"].as<std::string>();
+            tokens = lust::lexer::ITokenizer::create_from_file(path.c_str(), tokenizer_options);
+            if (!tokens) {
+                std::cerr << "Can't open file: " << path << std::endl;
+                return 1;
+            }
+        } else {
+            tokens = lust::lexer::ITokenizer::create(read_stdin(), tokenizer_options);
         }
-
-        std::string code = read_stdin();
-        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(code);
-        lust::UniquePtr<lust::grammar::ASTNode_Program> program = lust::grammar::IParser::create(tokens)->parse();
+        lust::grammar::Ast program = lust::grammar::IParser::create(tokens)->parse();
 
         {
             GVC_t* gv_context = gvContext();
             Agraph_t* graph = agopen(get_unique_name("AST").data(), Agdirected, nullptr);
             
             Agnode_t* root_node = agnode(graph, get_unique_name("PROGRAM").data(), 1);
-            std::function<void(Agnode_t*, const lust::vector<const lust::grammar::IASTNode*>&)> add_nodes = [graph, &add_nodes] (Agnode_t* parent_node, const lust::vector<const lust::grammar::IASTNode*>& nodes) {
-                for (const lust::grammar::IASTNode* n : nodes) {
-                    if (nullptr == n) {
-                        continue;
-                    }
-                    Agnode_t* new_node = agnode(graph, get_unique_name(n->get_name()).data(), 1);
-                    agedge(graph, parent_node, new_node, get_unique_name("CHILD").data(), 1);
-                    add_nodes(new_node, n->collect_self_nodes());
-                }
-            };
-            add_nodes(root_node, program->collect_self_nodes());
+            GraphBuilder builder;
+            builder.graph = graph;
+            builder.parent_node = root_node;
+            builder.visit_children(*program);
 
             gvLayout(gv_context, graph, "dot");
             gvRenderFilename(gv_context, graph, "png", cli_args["output"].as<std::string>().c_str());
@@ -1,18 +1,29 @@
 #include "container/simple_string.hpp"
 #include "lust/defines.hpp"
 
+#include <bit>
 #include <cstring>
-#include <execution>
 #include <string_view>
 #include <algorithm>
 
 namespace lust
 {
+    namespace
+    {
+        // Set in the last byte of the string for the heap layout, an inline length never reaches it
+        constexpr uint8_t HEAP_FLAG = 0x80;
+        static_assert(SSO_BUFFER_SIZE < HEAP_FLAG, "Inline length must leave the heap flag clear");
+
+        // The last byte is the highest byte of `heap_rep::capacity` on little-endian, the lowest one on big-endian
+        constexpr bool IS_LITTLE_ENDIAN = std::endian::native == std::endian::little;
+        constexpr size_t CAPACITY_FLAG_SHIFT = IS_LITTLE_ENDIAN ? (sizeof(size_t) - 1) * 8 : 0;
+        constexpr size_t CAPACITY_SHIFT = IS_LITTLE_ENDIAN ? 0 : 8;
+        constexpr size_t CAPACITY_MASK = IS_LITTLE_ENDIAN ? ~(size_t(HEAP_FLAG) << CAPACITY_FLAG_SHIFT) : ~size_t(0);
+    }
+
     simple_string::simple_string()
-        : m_length(0)
-        , m_is_heap(false)
     {
-        m_ss_buffer[0] = '\0';
+        set_inline_empty();
     }
 
     simple_string::simple_string(const char* s) : simple_string() {
@@ -29,24 +40,15 @@ namespace lust
 
     simple_string::simple_string(const simple_string &other) : simple_string() {
         if (!other.is_empty()) {
-            set_data(other.data(), other.m_length);
+            set_data(other.data(), other.length());
         }
     }
 
     simple_string::simple_string(simple_string &&other)
-        : m_length(other.m_length)
-        , m_capacity(other.m_capacity)
-        , m_is_heap(other.m_is_heap)
     {
-        if (m_is_heap) {
-            m_heap_data = other.m_heap_data;
-            other.m_heap_data = nullptr;
-        } else {
-            std::memcpy(m_ss_buffer, other.m_ss_buffer, m_length + 1);
-        }
-        other.m_length = 0;
-        other.m_capacity = SSO_BUFFER_SIZE;
-        other.m_is_heap = false;
+        // Both layouts are plain bytes, the heap buffer changes hands with them
+        std::memcpy(static_cast<void*>(this), &other, sizeof(simple_string));
+        other.set_inline_empty();
     }
 
     simple_string &simple_string::operator=(const simple_string &other) noexcept
@@ -60,32 +62,17 @@ namespace lust
     simple_string &simple_string::operator=(simple_string &&other) noexcept
     {
         if (this != &other) {
-            if (m_is_heap) {
-                delete[] m_heap_data;
-            }
-            m_length = other.m_length;
-            m_capacity = other.m_capacity;
-            m_is_heap = other.m_is_heap;
-
-            if (m_is_heap) {
-                m_heap_data = other.m_heap_data;
-                other.m_heap_data = nullptr;
-            } else {
-                std::memcpy(m_ss_buffer, other.m_ss_buffer, m_length + 1);
+            if (is_heap()) {
+                delete[] m_heap.data;
             }
-
-            other.m_length = 0;
-            other.m_capacity = SSO_BUFFER_SIZE;
-            other.m_is_heap = false;
+            std::memcpy(static_cast<void*>(this), &other, sizeof(simple_string));
+            other.set_inline_empty();
         }
         return *this;
     }
 
     bool simple_string::operator==(const simple_string& other) const noexcept {
-        if (m_length != other.m_length) {
-            return false;
-        }
-        return std::memcmp(data(), other.data(), m_length) == 0;
+        return static_cast<std::string_view>(*this) == static_cast<std::string_view>(other);
     }
 
     bool simple_string::operator!=(const simple_string& other) const noexcept {
@@ -96,11 +83,7 @@ namespace lust
         if (nullptr == other) {
              return false;
         }
-        size_t len = std::strlen(other);
-        if (m_length != len) {
-            return false;
-        }
-        return std::memcmp(data(), other, m_length) == 0;
+        return static_cast<std::string_view>(*this) == std::string_view(other);
     }
 
     bool simple_string::operator!=(const char* other) const noexcept {
@@ -109,47 +92,29 @@ namespace lust
 
     simple_string::~simple_string()
     {
-        if (m_is_heap) {
-            delete[] m_heap_data;
+        if (is_heap()) {
+            delete[] m_heap.data;
         }
     }
 
     bool simple_string::is_empty() const noexcept
     {
-        return 0 == m_length;
+        return is_heap() ? m_heap.length == 0 : m_inline.length == 0;
     }
 
     void simple_string::swap(simple_string &other)
     {
-        using std::swap;
         if (&other != this) {
-            if (m_is_heap && other.m_is_heap) {
-                swap(m_heap_data, other.m_heap_data);
-            } else if (m_is_heap) {
-                char temp[SSO_BUFFER_SIZE + 1];
-                std::memcpy(temp, other.m_ss_buffer, SSO_BUFFER_SIZE + 1);
-                other.m_heap_data = m_heap_data;
-                m_heap_data = nullptr;
-                std::memcpy(m_ss_buffer, temp, SSO_BUFFER_SIZE + 1);
-                swap(m_is_heap, other.m_is_heap);
-            } else if (other.m_is_heap) {
-                char temp[SSO_BUFFER_SIZE + 1];
-                std::memcpy(temp, m_ss_buffer, SSO_BUFFER_SIZE + 1);
-                m_heap_data = other.m_heap_data;
-                other.m_heap_data = nullptr;
-                std::memcpy(other.m_ss_buffer, temp, SSO_BUFFER_SIZE + 1);
-                swap(m_is_heap, other.m_is_heap);
-            } else {
-                std::swap_ranges(LUST_EXECUTION_CAN_VECTORIZATION , m_ss_buffer, m_ss_buffer + SSO_BUFFER_SIZE + 1, other.m_ss_buffer);
-            }
-            swap(m_capacity, other.m_capacity);
-            swap(m_length, other.m_length);
+            alignas(simple_string) unsigned char temp[sizeof(simple_string)];
+            std::memcpy(temp, static_cast<void*>(this), sizeof(simple_string));
+            std::memcpy(static_cast<void*>(this), &other, sizeof(simple_string));
+            std::memcpy(static_cast<void*>(&other), temp, sizeof(simple_string));
         }
     }
 
-    simple_string::operator std::string_view() noexcept
+    simple_string::operator std::string_view() const noexcept
     {
-        return m_is_heap ? std::string_view(m_heap_data, m_length) : std::string_view(m_ss_buffer, m_length);
+        return is_heap() ? std::string_view(m_heap.data, m_heap.length) : std::string_view(m_inline.data, m_inline.length);
     }
 
     simple_string::operator const char*() const noexcept
@@ -164,54 +129,55 @@ namespace lust
 
     char *simple_string::data()
     {
-        return m_is_heap ? m_heap_data : m_ss_buffer;
+        return is_heap() ? m_heap.data : m_inline.data;
     }
 
     const char* simple_string::data() const {
-        return m_is_heap ? m_heap_data : m_ss_buffer;
+        return is_heap() ? m_heap.data : m_inline.data;
+    }
+
+    size_t simple_string::length() const noexcept {
+        return is_heap() ? m_heap.length : m_inline.length;
     }
 
-    size_t simple_string::length() {
-        return m_length;
+    size_t simple_string::size() const noexcept {
+        return length();
     }
 
     void simple_string::ensure_capacity(size_t new_length) {
-        if (new_length <= SSO_BUFFER_SIZE || new_length <= m_capacity) {
+        const size_t old_capacity = capacity();
+        if (new_length <= old_capacity) {
             return;
         }
+        reallocate(std::max(new_length, old_capacity * 2));
+    }
 
-        if (!m_is_heap) {
-            m_is_heap = true;
-            m_capacity = new_length;
-            char* new_data = new char[m_capacity + 1];
-            std::memcpy(new_data, m_ss_buffer, m_length + 1);
-            m_heap_data = new_data;
-        } else {
-            m_capacity = new_length;
-            char* new_data = new char[m_capacity + 1];
-            std::memcpy(new_data, m_heap_data, m_length + 1);
-            delete[] m_heap_data;
-            m_heap_data = new_data;
+    void simple_string::reserve(size_t new_capacity) {
+        if (new_capacity > capacity()) {
+            reallocate(new_capacity);
         }
     }
 
+    void simple_string::clear() noexcept {
+        data()[0] = '\0';
+        set_length(0);
+    }
+
     simple_string& simple_string::append(const char* s) {
         if (s) {
-            size_t new_length = m_length + std::strlen(s);
-            ensure_capacity(new_length);
-            std::memcpy(data() + m_length, s, std::strlen(s) + 1);
-            m_length = new_length;
+            append(std::string_view(s));
         }
         return *this;
     }
 
     simple_string& simple_string::append(const std::string_view s) {
         if (!s.empty()) {
-            size_t new_length = m_length + s.size();
+            const size_t len = length();
+            size_t new_length = len + s.size();
             ensure_capacity(new_length);
-            std::memcpy(data() + m_length, s.data(), s.size());
-            m_length = new_length;
-            data()[m_length] = '\0';
+            std::memcpy(data() + len, s.data(), s.size());
+            data()[new_length] = '\0';
+            set_length(new_length);
         }
         return *this;
     }
@@ -225,24 +191,65 @@ namespace lust
     }
 
     simple_string& simple_string::operator+=(const simple_string& other) {
-        return append(const_cast<simple_string&>(other).operator std::string_view());
+        return append(static_cast<std::string_view>(other));
+    }
+
+    bool simple_string::is_heap() const noexcept
+    {
+        // The last byte is shared by both layouts, reading it through `unsigned char` is always allowed
+        return (reinterpret_cast<const unsigned char*>(this)[sizeof(simple_string) - 1] & HEAP_FLAG) != 0;
+    }
+
+    size_t simple_string::capacity() const noexcept
+    {
+        return is_heap() ? (m_heap.capacity & CAPACITY_MASK) >> CAPACITY_SHIFT : SSO_BUFFER_SIZE;
+    }
+
+    void simple_string::set_length(size_t len) noexcept
+    {
+        if (is_heap()) {
+            m_heap.length = len;
+        } else {
+            m_inline.length = static_cast<uint8_t>(len);
+        }
+    }
+
+    void simple_string::set_heap(char* data, size_t len, size_t capacity) noexcept
+    {
+        m_heap.data = data;
+        m_heap.length = len;
+        m_heap.capacity = (capacity << CAPACITY_SHIFT) | (size_t(HEAP_FLAG) << CAPACITY_FLAG_SHIFT);
+    }
+
+    void simple_string::set_inline_empty() noexcept
+    {
+        m_inline.data[0] = '\0';
+        m_inline.length = 0;
+    }
+
+    void simple_string::reallocate(size_t new_capacity) {
+        const size_t len = length();
+        char* new_data = new char[new_capacity + 1];
+        std::memcpy(new_data, data(), len + 1);
+        if (is_heap()) {
+            delete[] m_heap.data;
+        }
+        set_heap(new_data, len, new_capacity);
     }
 
     void simple_string::set_data(const char* s, size_t len) {
         if (len <= SSO_BUFFER_SIZE) {
-            if (m_is_heap) {
-                delete[] m_heap_data;
-                m_is_heap = false;
+            if (is_heap()) {
+                delete[] m_heap.data;
             }
-            std::memcpy(m_ss_buffer, s, len);
-            m_ss_buffer[len] = '\0';
-            m_length = len;
-            m_capacity = SSO_BUFFER_SIZE;
+            std::memcpy(m_inline.data, s, len);
+            m_inline.data[len] = '\0';
+            m_inline.length = static_cast<uint8_t>(len);
         } else {
-            ensure_capacity(len);
+            reserve(len);
             std::memcpy(data(), s, len);
             data()[len] = '\0';
-            m_length = len;
+            set_length(len);
         }
     }
 }
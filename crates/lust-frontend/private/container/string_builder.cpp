@@ -0,0 +1,76 @@
+#include "container/string_builder.hpp"
+
+#include <charconv>
+
+namespace lust
+{
+    string_builder::string_builder(size_t initial_capacity)
+    {
+        m_buffer.reserve(initial_capacity);
+    }
+
+    string_builder& string_builder::append(std::string_view s)
+    {
+        m_buffer.append(s);
+        return *this;
+    }
+
+    string_builder& string_builder::append(const char* s)
+    {
+        m_buffer.append(s);
+        return *this;
+    }
+
+    string_builder& string_builder::append(const simple_string& s)
+    {
+        m_buffer += s;
+        return *this;
+    }
+
+    string_builder& string_builder::append(char c)
+    {
+        m_buffer.append(std::string_view(&c, 1));
+        return *this;
+    }
+
+    string_builder& string_builder::append(int64_t value)
+    {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        return append(std::string_view(digits, result.ptr - digits));
+    }
+
+    string_builder& string_builder::append(uint64_t value)
+    {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        return append(std::string_view(digits, result.ptr - digits));
+    }
+
+    std::string_view string_builder::view() const noexcept
+    {
+        return m_buffer;
+    }
+
+    size_t string_builder::size() const noexcept
+    {
+        return m_buffer.size();
+    }
+
+    bool string_builder::is_empty() const noexcept
+    {
+        return m_buffer.is_empty();
+    }
+
+    simple_string string_builder::build()
+    {
+        simple_string result(view());
+        m_buffer.clear();
+        return result;
+    }
+
+    void string_builder::clear() noexcept
+    {
+        m_buffer.clear();
+    }
+}
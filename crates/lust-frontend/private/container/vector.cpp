@@ -1,194 +1,149 @@
 #include "container/vector.hpp"
-#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
 #include <utility> // for std::move
-// #include <stdexcept> // for std::out_of_range
+#include <stdexcept> // for std::out_of_range
 #include <type_traits>
 
 #include "container/simple_string.hpp"
 #include "container/unique_ptr.hpp"
 #include "grammar.hpp"
-#include "grammar/type_expr.hpp"
-#include "grammar/operator_expr.hpp"
+#include "lexer.hpp"
 
 namespace lust {
-    template <typename T>
-    class vector<T>::Impl {
-    public:
-        std::vector<T> data;
-    };
-
-    template <typename T>
-    vector<T>::vector() : pimpl(new Impl()) {}
-
-    template <typename T>
-    vector<T>::vector(const vector<T>& other)  {
-        if constexpr (std::is_copy_constructible<T>::value) {
-            pimpl = new Impl(*other.pimpl);
-        } else {
-            pimpl = new Impl(std::move(*other.pimpl));
+    namespace
+    {
+        template <typename T>
+        T* allocate_slots(size_t count) {
+            return std::allocator<T>().allocate(count);
         }
-    }
 
-    template <typename T>
-    vector<T>::vector(vector<T>&& other) noexcept : pimpl(other.pimpl) {
-        other.pimpl = nullptr;
+        template <typename T>
+        void deallocate_slots(T* data, size_t count) {
+            std::allocator<T>().deallocate(data, count);
+        }
     }
 
     template <typename T>
-    vector<T>& vector<T>::operator=(const vector<T>& other) {
-        if constexpr (std::is_copy_assignable<T>::value) {
-            if (this != &other) {  // 防止自赋值
-                *pimpl = *other.pimpl;
-            }
+    vector<T>::vector(const vector<T>& other) requires std::is_copy_constructible_v<T> {
+        if (other.m_size > 0) {
+            m_data = allocate_slots<T>(other.m_size);
+            std::uninitialized_copy(other.m_data, other.m_data + other.m_size, m_data);
+            m_size = other.m_size;
+            m_capacity = other.m_size;
         }
-        return *this;
     }
 
     template <typename T>
-    vector<T>& vector<T>::operator=(vector<T>&& other) noexcept {
-        std::swap(pimpl, other.pimpl);
+    vector<T>& vector<T>::operator=(const vector<T>& other) requires std::is_copy_constructible_v<T> {
+        if (this != &other) {  // 防止自赋值
+            vector<T>(other).swap(*this);
+        }
         return *this;
     }
 
     template <typename T>
-    vector<T>::~vector() {
-        delete pimpl;
+    void vector<T>::release() noexcept {
+        std::destroy(m_data, m_data + m_size);
+        deallocate_slots(m_data, m_capacity);
+        m_data = nullptr;
+        m_size = 0;
+        m_capacity = 0;
     }
 
     template <typename T>
-    bool vector<T>::empty() const {
-        return pimpl->data.empty();
-    }
-
-    template <typename T>
-    size_t vector<T>::size() const {
-        return pimpl->data.size();
+    void vector<T>::grow(size_t min_capacity) {
+        const size_t new_capacity = std::max({ min_capacity, m_capacity * 2, size_t(4) });
+        T* new_data = allocate_slots<T>(new_capacity);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (m_size > 0) {
+                std::memcpy(static_cast<void*>(new_data), m_data, m_size * sizeof(T));
+            }
+        } else {
+            std::uninitialized_move(m_data, m_data + m_size, new_data);
+            std::destroy(m_data, m_data + m_size);
+        }
+        if (m_data) {
+            deallocate_slots(m_data, m_capacity);
+        }
+        m_data = new_data;
+        m_capacity = new_capacity;
     }
 
     template <typename T>
     void vector<T>::resize(size_t count) {
-        pimpl->data.resize(count);
+        if (count < m_size) {
+            std::destroy(m_data + count, m_data + m_size);
+        } else if (count > m_size) {
+            if (count > m_capacity) {
+                grow(count);
+            }
+            std::uninitialized_value_construct(m_data + m_size, m_data + count);
+        }
+        m_size = count;
     }
 
     template <typename T>
     void vector<T>::reserve(size_t new_cap) {
-        pimpl->data.reserve(new_cap);
-    }
-
-    template <typename T>
-    size_t vector<T>::capacity() const {
-        return pimpl->data.capacity();
+        if (new_cap > m_capacity) {
+            grow(new_cap);
+        }
     }
 
     template <typename T>
     void vector<T>::clear() {
-        pimpl->data.clear();
-    }
-
-    template <typename T>
-    T& vector<T>::operator[](size_t pos) {
-        return pimpl->data[pos];
-    }
-
-    template <typename T>
-    const T& vector<T>::operator[](size_t pos) const {
-        return pimpl->data[pos];
+        std::destroy(m_data, m_data + m_size);
+        m_size = 0;
     }
 
     template <typename T>
     T& vector<T>::at(size_t pos) {
-        return pimpl->data.at(pos);  // at() 会检查边界并可能抛出 std::out_of_range 异常
+        if (pos >= m_size) {
+            throw std::out_of_range("lust::vector::at");
+        }
+        return m_data[pos];
     }
 
     template <typename T>
     const T& vector<T>::at(size_t pos) const {
-        return pimpl->data.at(pos);
-    }
-
-    template <typename T>
-    T& vector<T>::front() {
-        return pimpl->data.front();
-    }
-
-    template <typename T>
-    const T& vector<T>::front() const {
-        return pimpl->data.front();
-    }
-
-    template <typename T>
-    T& vector<T>::back() {
-        return pimpl->data.back();
-    }
-
-    template <typename T>
-    const T& vector<T>::back() const {
-        return pimpl->data.back();
-    }
-
-    template <typename T>
-    void vector<T>::push_back(const T& value) {
-        if constexpr (std::is_copy_constructible<T>::value) {
-            pimpl->data.push_back(value);
+        if (pos >= m_size) {
+            throw std::out_of_range("lust::vector::at");
         }
-    }
-
-    template <typename T>
-    void vector<T>::push_back(T&& value) {
-        pimpl->data.push_back(std::move(value));
+        return m_data[pos];
     }
 
     template <typename T>
     void vector<T>::pop_back() {
-        pimpl->data.pop_back();
+        std::destroy_at(m_data + --m_size);
     }
 
     template <typename T>
     void vector<T>::extend(vector &&other) {
-        for (int32_t i = 0; i < other.size(); ++i) {
-            push_back(std::move(other.at(i)));
+        if (m_size == 0) {
+            swap(other);
+            return;
         }
+        reserve(m_size + other.m_size);
+        std::uninitialized_move(other.m_data, other.m_data + other.m_size, m_data + m_size);
+        m_size += other.m_size;
+        other.clear();
     }
 
     template <typename T>
-    template <typename... Args>
-    void vector<T>::emplace_back(Args &&...args)
-    {
-        pimpl->data.emplace_back(std::forward<Args>(args)...);
-    }
-
-    template <typename T>
-    T* vector<T>::begin() {
-        return &front();
-    }
-
-    template <typename T>
-    T* vector<T>::end() {
-        return &front() + size();
-    }
-
-    template <typename T>
-    vector<T> vector<T>::slice(size_t begin_pos, size_t end_pos) const
+    vector<T> vector<T>::slice(size_t begin_pos, size_t end_pos) const requires std::is_copy_constructible_v<T>
     {
         vector<T> vec;
-
-        for (int i = begin_pos; i < end_pos; ++i) {
-            vec.push_back(at(i));
+        if (end_pos > begin_pos) {
+            vec.reserve(end_pos - begin_pos);
+            for (size_t i = begin_pos; i < end_pos; ++i) {
+                vec.push_back(at(i));
+            }
         }
-
         return vec;
     }
 
-    template <typename T>
-    const T *vector<T>::begin() const
-    {
-        return &front();
-    }
-
-    template <typename T>
-    const T* vector<T>::end() const {
-        return &front() + size();
-    }
-
     // 显式实例化模板
     template class vector<int8_t>;
     template class vector<int16_t>;
@@ -201,18 +156,12 @@ namespace lust {
     template class vector<double>;
     template class vector<float>;
     template class vector<simple_string>;
-    template class vector<UniquePtr<grammar::ASTNode_Statement>>;
-    template class vector<UniquePtr<grammar::ASTNode_Attribute>>;
-    template class vector<grammar::QualifiedName>;
-    template class vector<UniquePtr<grammar::ASTNode_GenericParam>>;
-    template class vector<UniquePtr<grammar::ASTNode_TypeExpr>>;
-    template class vector<UniquePtr<grammar::ASTNode_ParamDecl>>;
-    template class vector<UniquePtr<grammar::ASTNode_Expr>>;
+    template class vector<std::string_view>;
+    template class vector<Symbol>;
+    template class vector<lexer::NumberLiteral>;
+    template class vector<lexer::CommentSpan>;
+    template class vector<UniquePtr<simple_string>>;
     template class vector<const grammar::IASTNode*>;
-    template class vector<UniquePtr<grammar::ASTNode_StructField>>;
-    template class vector<UniquePtr<grammar::ASTNode_MorphismsType>>;
-    template class vector<UniquePtr<grammar::ASTNode_MorphismsConstant>>;
-    template class vector<UniquePtr<grammar::ASTNode_FunctionDecl>>;
     // 添加其他需要支持的类型
 
 } // namespace lust
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "grammar.hpp"
 #include "container/simple_string.hpp"
-#include "container/unique_ptr.hpp"
 #include "container/vector.hpp"
 #include "grammar/type_expr.hpp"
 #include "grammar/operator_expr.hpp"
@@ -43,57 +42,59 @@ namespace grammar
         return "Unknown";
     }
 
-    IASTNode::~IASTNode() = default;
+    string_builder& append_qualified_name(string_builder& builder, const QualifiedName& name) {
+        return append_qualified_name(builder, std::span<const Symbol>(name.name_spaces.data(), name.name_spaces.size()), name.name);
+    }
+
+    string_builder& append_qualified_name(string_builder& builder, std::span<const Symbol> name_spaces, Symbol name) {
+        for (const Symbol name_space : name_spaces) {
+            builder << name_space.str() << "::";
+        }
+        return builder << name.str();
+    }
+
+    void IASTNode::for_each_child(ChildCallback) const {
+    }
 
     vector<const IASTNode*> IASTNode::collect_self_nodes() const {
-        return {};
+        vector<const IASTNode*> res;
+        for_each_child([&res] (const IASTNode* child) {
+            res.push_back(child);
+        });
+        return res;
     }
 
     simple_string IASTNode::get_name() const {
         return grammar_rule_to_name(get_type());
     }
 
-    vector<const IASTNode*> ASTNode_ParamDecl::collect_self_nodes() const {
-            vector<const IASTNode*> res = Super::collect_self_nodes();
-            res.push_back(type.get());
-            return res;
+    void ASTNode_ParamDecl::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(type);
     }
 
-    vector<const IASTNode*> ASTNode_ParamList::collect_self_nodes() const {
-            vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const UniquePtr<ASTNode_ParamDecl>& n : params) {
-            res.push_back(n.get());
-        }
-        return res;
+    void ASTNode_ParamList::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(params);
     }
 
-    vector<const IASTNode*> ASTNode_InvokeParameters::collect_self_nodes() const {
-            vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const auto& n : parameter_expressions) {
-            res.push_back(n.get());
-        }
-        return res;
+    void ASTNode_InvokeParameters::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(parameter_expressions);
     }
-    vector<const IASTNode*> ASTNode_Attribute::collect_self_nodes() const {
-        return Super::collect_self_nodes();
-    }
-    
-    vector<const IASTNode*> ASTNode_GenericParam::collect_self_nodes() const {
-        auto res = Super::collect_self_nodes();
 
-        for (auto& n : types) {
-            res.push_back(n.get());
-        }
+    void ASTNode_Attribute::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+    }
 
-        return res;
+    void ASTNode_GenericParam::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(types);
     }
 
-    vector<const IASTNode*> ASTNode_Statement::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const UniquePtr<ASTNode_Attribute>& attr : attributes) {
-            res.push_back(attr.get());
-        }
-        return res;
+    void ASTNode_Statement::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(attributes);
     }
 
     simple_string ASTNode_Statement::get_name() const {
@@ -104,97 +105,62 @@ namespace grammar
         return name;
     }
 
-    vector<const IASTNode*> ASTNode_ExprStatement::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        res.push_back(expression.get());
-        return res;
+    void ASTNode_ExprStatement::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(expression);
     }
 
-    vector<const IASTNode*> ASTNode_Program::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const UniquePtr<ASTNode_Attribute>& attr : attributes) {
-            res.push_back(attr.get());
-        }
-        for (const UniquePtr<ASTNode_Statement>& statement : statements) {
-            res.push_back(statement.get());
-        }
-        return res;
+    void ASTNode_Program::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(attributes);
+        callback(statements);
     }
 
-    vector<const IASTNode*> ASTNode_VarDecl::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        res.push_back(specified_type.get());
-        res.push_back(evaluate_expression.get());
-        return res;
+    void ASTNode_VarDecl::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(specified_type);
+        callback(evaluate_expression);
     }
 
-    vector<const IASTNode*> ASTNode_FunctionDecl::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-
-        for (auto& generic_param : generic_params) {
-            res.push_back(generic_param.get());
-        }
-        res.push_back(params.get());
-        res.push_back(ret_type.get());
-        res.push_back(body.get());
-
-        return res;
+    void ASTNode_FunctionDecl::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(generic_params);
+        callback(params);
+        callback(ret_type);
+        callback(body);
     }
 
-    vector<const IASTNode*> ASTNode_Block::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const UniquePtr<ASTNode_Statement>& statement : statements) {
-            res.push_back(statement.get());
-        }
-        return res;
+    void ASTNode_Block::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(statements);
     }
 
-    vector<const IASTNode*> ASTNode_StructField::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        res.push_back(field_type.get());
-        return res;
+    void ASTNode_StructField::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(field_type);
     }
 
-    vector<const IASTNode*> ASTNode_StructDecl::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        for (const UniquePtr<ASTNode_StructField>& field : fields) {
-            res.push_back(field.get());
-        }
-        return res;
+    void ASTNode_StructDecl::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(fields);
     }
 
-    vector<const IASTNode*> ASTNode_MorphismsType::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        res.push_back(value.get());
-        return res;
+    void ASTNode_MorphismsType::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(value);
     }
 
-    vector<const IASTNode*> ASTNode_MorphismsConstant::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-        res.push_back(value.get());
-        return res;
+    void ASTNode_MorphismsConstant::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(value);
     }
 
-    vector<const IASTNode*> ASTNode_TraitDecl::collect_self_nodes() const {
-        vector<const IASTNode*> res = Super::collect_self_nodes();
-
-        for (const auto& n : generic_params) {
-            res.push_back(n.get());
-        }
-
-        for (const auto& n : morphisms_types) {
-            res.push_back(n.get());
-        }
-
-        for (const auto& n : morphisms_constants) {
-            res.push_back(n.get());
-        }
-
-        for (const auto& n : functions) {
-            res.push_back(n.get());
-        }
-
-        return res;
+    void ASTNode_TraitDecl::for_each_child(ChildCallback callback) const {
+        Super::for_each_child(callback);
+        callback(generic_params);
+        callback(morphisms_types);
+        callback(morphisms_constants);
+        callback(functions);
     }
 }
 }
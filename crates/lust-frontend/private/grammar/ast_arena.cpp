@@ -0,0 +1,89 @@
+#include "grammar/ast_arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace lust
+{
+namespace grammar
+{
+    // Blocks are chained from the newest one, their memory follows the header
+    struct AstArena::Block {
+        Block* previous;
+        size_t size;
+
+        char* begin() { return reinterpret_cast<char*>(this + 1); }
+        char* end() { return begin() + size; }
+    };
+
+    AstArena::AstArena(AstArena&& other) noexcept
+        : m_head(std::exchange(other.m_head, nullptr))
+        , m_cursor(std::exchange(other.m_cursor, nullptr))
+        , m_end(std::exchange(other.m_end, nullptr))
+        , m_block_count(std::exchange(other.m_block_count, 0))
+        , m_bytes_reserved(std::exchange(other.m_bytes_reserved, 0))
+    { }
+
+    AstArena& AstArena::operator=(AstArena&& other) noexcept
+    {
+        if (this != &other) {
+            release_blocks_after(nullptr);
+            m_head = std::exchange(other.m_head, nullptr);
+            m_cursor = std::exchange(other.m_cursor, nullptr);
+            m_end = std::exchange(other.m_end, nullptr);
+            m_block_count = std::exchange(other.m_block_count, 0);
+            m_bytes_reserved = std::exchange(other.m_bytes_reserved, 0);
+        }
+        return *this;
+    }
+
+    AstArena::~AstArena()
+    {
+        release_blocks_after(nullptr);
+    }
+
+    void* AstArena::allocate_slow(size_t size, size_t alignment)
+    {
+        // Oversized objects get a block of their own
+        const size_t block_size = std::max(BLOCK_SIZE, size + alignment);
+        Block* block = static_cast<Block*>(std::malloc(sizeof(Block) + block_size));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        block->previous = m_head;
+        block->size = block_size;
+        m_head = block;
+        m_cursor = block->begin();
+        m_end = block->end();
+        ++m_block_count;
+        m_bytes_reserved += block_size;
+
+        return allocate(size, alignment);
+    }
+
+    void AstArena::rollback(const Mark& mark) noexcept
+    {
+        Block* const block = static_cast<Block*>(mark.block);
+        release_blocks_after(block);
+        m_cursor = mark.cursor;
+        m_end = block ? block->end() : nullptr;
+    }
+
+    void AstArena::release_blocks_after(Block* keep) noexcept
+    {
+        while (m_head && m_head != keep) {
+            Block* const previous = m_head->previous;
+            m_bytes_reserved -= m_head->size;
+            --m_block_count;
+            std::free(m_head);
+            m_head = previous;
+        }
+        if (!m_head) {
+            m_cursor = nullptr;
+            m_end = nullptr;
+        }
+    }
+}
+}
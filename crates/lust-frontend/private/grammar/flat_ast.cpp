@@ -0,0 +1,459 @@
+#include "grammar/flat_ast.hpp"
+#include "grammar.hpp"
+#include "grammar/operator_expr.hpp"
+#include "grammar/type_expr.hpp"
+
+#include <charconv>
+
+namespace lust
+{
+namespace grammar
+{
+    /*
+     * Layout of `data` per kind:
+     * - declarations with an identifier and PARAMETER: index in m_symbols
+     * - QUALIFIED_NAME_USAGE, trivial and generic TYPE_EXPR: m_extra[data] = first symbol, m_extra[data + 1] = count
+     * - ATTRIBUTE: the name range then the arguments range
+     * - GENERIC_PARAM: m_extra[data] = number of constraints, followed by one range per constraint
+     * - INTEGER_LITERAL and array TYPE_EXPR: index in m_integers, FLOAT_LITERAL: m_floats
+     * - STRING_LITERAL: m_extra[data] = offset in m_string_text, m_extra[data + 1] = length
+     * - anything else: 0
+     */
+    namespace
+    {
+        bool is_operator_rule(GrammarRule rule) {
+            switch (rule) {
+                case GrammarRule::OPERATOR:
+                case GrammarRule::INTEGER_LITERAL:
+                case GrammarRule::FLOAT_LITERAL:
+                case GrammarRule::STRING_LITERAL:
+                case GrammarRule::QUALIFIED_NAME_USAGE:
+                case GrammarRule::BLOCK_EXPR:
+                case GrammarRule::IF_BLOCK_EXPR:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Nodes deriving from ASTNode_Statement, they carry a visibility and the semicolon flag
+        bool is_statement_rule(GrammarRule rule) {
+            switch (rule) {
+                case GrammarRule::STATEMENT:
+                case GrammarRule::NAMED_STATEMENT:
+                case GrammarRule::EXPR_STATEMENT:
+                case GrammarRule::VAR_DECL:
+                case GrammarRule::FUNCTION_DECL:
+                case GrammarRule::BLOCK:
+                case GrammarRule::STRUCT_FIELD:
+                case GrammarRule::STRUCT:
+                case GrammarRule::MORPHISMS_TYPE:
+                case GrammarRule::MORPHISMS_CONSTANT:
+                case GrammarRule::TRAIT:
+                case GrammarRule::EXPRESSION:
+                    return true;
+                default:
+                    return is_operator_rule(rule);
+            }
+        }
+
+        bool has_identifier(GrammarRule rule) {
+            switch (rule) {
+                case GrammarRule::NAMED_STATEMENT:
+                case GrammarRule::VAR_DECL:
+                case GrammarRule::FUNCTION_DECL:
+                case GrammarRule::STRUCT_FIELD:
+                case GrammarRule::STRUCT:
+                case GrammarRule::MORPHISMS_TYPE:
+                case GrammarRule::MORPHISMS_CONSTANT:
+                case GrammarRule::TRAIT:
+                case GrammarRule::PARAMETER:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        TypeExprKind type_expr_kind(const ASTNode_TypeExpr* node) {
+            // The is_*_type() queries are not const and is_array_type() is false for arrays
+            if (dynamic_cast<const ASTNode_TypeExpr_Trivial*>(node)) return TypeExprKind::TRIVIAL;
+            if (dynamic_cast<const ASTNode_TypeExpr_Tuple*>(node)) return TypeExprKind::TUPLE;
+            if (dynamic_cast<const ASTNode_TypeExpr_Reference*>(node)) return TypeExprKind::REFERENCE;
+            if (dynamic_cast<const ASTNode_TypeExpr_Generic*>(node)) return TypeExprKind::GENERIC;
+            if (dynamic_cast<const ASTNode_TypeExpr_Function*>(node)) return TypeExprKind::FUNCTION;
+            if (dynamic_cast<const ASTNode_TypeExpr_Array*>(node)) return TypeExprKind::ARRAY;
+            return TypeExprKind::NONE;
+        }
+    }
+
+    class FlatAstEncoder {
+    public:
+        explicit FlatAstEncoder(FlatAst& out) : m_out(out) {}
+
+        void encode(const IASTNode* node, NodeIndex parent) {
+            if (nullptr == node) {
+                return;
+            }
+
+            const GrammarRule rule = node->get_type();
+            const NodeIndex index = static_cast<NodeIndex>(m_out.m_kinds.size());
+            m_out.m_kinds.push_back(static_cast<uint8_t>(rule));
+            m_out.m_tags.push_back(0);
+            m_out.m_flags.push_back(0);
+            m_out.m_parents.push_back(parent);
+            m_out.m_ends.push_back(0);
+            m_out.m_data.push_back(0);
+
+            uint8_t flags = 0;
+            uint8_t tag = 0;
+            uint32_t data = 0;
+
+            if (is_statement_rule(rule)) {
+                const auto* statement = static_cast<const ASTNode_Statement*>(node);
+                flags |= static_cast<uint8_t>(statement->visibility) & FLAT_VISIBILITY_MASK;
+                if (statement->is_end_with_semicolon) {
+                    flags |= FLAT_END_WITH_SEMICOLON;
+                }
+                for (const auto& attribute : statement->attributes) {
+                    encode(attribute.get(), index);
+                }
+            }
+            if (is_operator_rule(rule)) {
+                const auto* op = static_cast<const ASTNode_Operator*>(node);
+                tag = static_cast<uint8_t>(op->operator_type);
+                encode(op->left_oprand.get(), index);
+                encode(op->right_oprand.get(), index);
+            }
+            if (has_identifier(rule)) {
+                data = push_symbol(rule == GrammarRule::PARAMETER
+                    ? static_cast<const ASTNode_ParamDecl*>(node)->identifier
+                    : rule == GrammarRule::VAR_DECL
+                        ? static_cast<const ASTNode_VarDecl*>(node)->identifier
+                        : static_cast<const ASTNode_NamedStatement*>(node)->identifier);
+            }
+
+            switch (rule) {
+                case GrammarRule::PROGRAM: {
+                    const auto* program = static_cast<const ASTNode_Program*>(node);
+                    encode_all(program->attributes, index);
+                    encode_all(program->statements, index);
+                    break;
+                }
+                case GrammarRule::EXPR_STATEMENT:
+                    encode(static_cast<const ASTNode_ExprStatement*>(node)->expression.get(), index);
+                    break;
+                case GrammarRule::VAR_DECL: {
+                    const auto* var = static_cast<const ASTNode_VarDecl*>(node);
+                    flags |= (var->is_mutable ? FLAT_MUTABLE : 0) | (var->is_const ? FLAT_CONST : 0)
+                        | (var->is_forward_decl_only ? FLAT_FORWARD_DECL_ONLY : 0);
+                    encode(var->specified_type.get(), index);
+                    encode(var->evaluate_expression.get(), index);
+                    break;
+                }
+                case GrammarRule::FUNCTION_DECL: {
+                    const auto* function = static_cast<const ASTNode_FunctionDecl*>(node);
+                    flags |= function->is_async ? FLAT_ASYNC : 0;
+                    encode_all(function->generic_params, index);
+                    encode(function->params.get(), index);
+                    encode(function->ret_type.get(), index);
+                    encode(function->body.get(), index);
+                    break;
+                }
+                case GrammarRule::BLOCK:
+                    encode_all(static_cast<const ASTNode_Block*>(node)->statements, index);
+                    break;
+                case GrammarRule::STRUCT_FIELD: {
+                    const auto* field = static_cast<const ASTNode_StructField*>(node);
+                    flags |= field->is_field_mutable ? FLAT_MUTABLE : 0;
+                    encode(field->field_type.get(), index);
+                    break;
+                }
+                case GrammarRule::STRUCT:
+                    encode_all(static_cast<const ASTNode_StructDecl*>(node)->fields, index);
+                    break;
+                case GrammarRule::MORPHISMS_TYPE:
+                    encode(static_cast<const ASTNode_MorphismsType*>(node)->value.get(), index);
+                    break;
+                case GrammarRule::MORPHISMS_CONSTANT:
+                    encode(static_cast<const ASTNode_MorphismsConstant*>(node)->value.get(), index);
+                    break;
+                case GrammarRule::TRAIT: {
+                    const auto* trait = static_cast<const ASTNode_TraitDecl*>(node);
+                    encode_all(trait->generic_params, index);
+                    encode_all(trait->morphisms_types, index);
+                    encode_all(trait->morphisms_constants, index);
+                    encode_all(trait->functions, index);
+                    break;
+                }
+                case GrammarRule::PARAMETER: {
+                    const auto* param = static_cast<const ASTNode_ParamDecl*>(node);
+                    flags |= param->is_instance_function ? FLAT_INSTANCE_FUNCTION : 0;
+                    encode(param->type.get(), index);
+                    break;
+                }
+                case GrammarRule::PARAMETERS_LIST:
+                    encode_all(static_cast<const ASTNode_ParamList*>(node)->params, index);
+                    break;
+                case GrammarRule::INVOKE_PARAMETERS:
+                    encode_all(static_cast<const ASTNode_InvokeParameters*>(node)->parameter_expressions, index);
+                    break;
+                case GrammarRule::ATTRIBUTE: {
+                    const auto* attribute = static_cast<const ASTNode_Attribute*>(node);
+                    data = push_name(attribute->name);
+                    push_range(attribute->args.begin(), attribute->args.end());
+                    break;
+                }
+                case GrammarRule::GENERIC_PARAM: {
+                    const auto* param = static_cast<const ASTNode_GenericParam*>(node);
+                    data = static_cast<uint32_t>(m_out.m_extra.size());
+                    m_out.m_extra.push_back(static_cast<uint32_t>(param->constraints.size()));
+                    for (const QualifiedName& constraint : param->constraints) {
+                        push_name(constraint);
+                    }
+                    encode_all(param->types, index);
+                    break;
+                }
+                case GrammarRule::TYPE_EXPR: {
+                    const auto* type = static_cast<const ASTNode_TypeExpr*>(node);
+                    const TypeExprKind kind = type_expr_kind(type);
+                    tag = static_cast<uint8_t>(kind);
+                    switch (kind) {
+                        case TypeExprKind::TRIVIAL:
+                            data = push_name(static_cast<const ASTNode_TypeExpr_Trivial*>(type)->type_name);
+                            break;
+                        case TypeExprKind::TUPLE:
+                            encode_all(static_cast<const ASTNode_TypeExpr_Tuple*>(type)->composite_types, index);
+                            break;
+                        case TypeExprKind::REFERENCE:
+                            encode(static_cast<const ASTNode_TypeExpr_Reference*>(type)->referenced_type.get(), index);
+                            break;
+                        case TypeExprKind::GENERIC: {
+                            const auto* generic = static_cast<const ASTNode_TypeExpr_Generic*>(type);
+                            data = push_name(generic->base_type);
+                            encode_all(generic->params, index);
+                            break;
+                        }
+                        case TypeExprKind::FUNCTION: {
+                            const auto* function = static_cast<const ASTNode_TypeExpr_Function*>(type);
+                            encode_all(function->param_types, index);
+                            encode(function->return_type.get(), index);
+                            break;
+                        }
+                        case TypeExprKind::ARRAY: {
+                            const auto* array = static_cast<const ASTNode_TypeExpr_Array*>(type);
+                            data = static_cast<uint32_t>(m_out.m_integers.size());
+                            m_out.m_integers.push_back(array->array_size);
+                            encode(array->array_type.get(), index);
+                            break;
+                        }
+                        default:
+                            break;
+                    }
+                    break;
+                }
+                case GrammarRule::INTEGER_LITERAL: {
+                    const auto* literal = static_cast<const ASTNode_IntegerExpr*>(node);
+                    flags |= static_cast<uint8_t>(literal->suffix) << FLAT_NUMBER_SUFFIX_SHIFT;
+                    data = static_cast<uint32_t>(m_out.m_integers.size());
+                    m_out.m_integers.push_back(literal->value);
+                    break;
+                }
+                case GrammarRule::FLOAT_LITERAL: {
+                    const auto* literal = static_cast<const ASTNode_FloatExpr*>(node);
+                    flags |= static_cast<uint8_t>(literal->suffix) << FLAT_NUMBER_SUFFIX_SHIFT;
+                    data = static_cast<uint32_t>(m_out.m_floats.size());
+                    m_out.m_floats.push_back(literal->value);
+                    break;
+                }
+                case GrammarRule::STRING_LITERAL: {
+                    const std::string_view text = static_cast<const ASTNode_StringExpr*>(node)->value;
+                    data = static_cast<uint32_t>(m_out.m_extra.size());
+                    m_out.m_extra.push_back(static_cast<uint32_t>(m_out.m_string_text.size()));
+                    m_out.m_extra.push_back(static_cast<uint32_t>(text.size()));
+                    m_out.m_string_text.append(text);
+                    break;
+                }
+                case GrammarRule::QUALIFIED_NAME_USAGE: {
+                    const auto* name = static_cast<const ASTNode_QualifiedName*>(node);
+                    data = push_name(name->qualified_name);
+                    encode_all(name->generic_params, index);
+                    encode(name->passing_parameters.get(), index);
+                    break;
+                }
+                case GrammarRule::BLOCK_EXPR:
+                case GrammarRule::IF_BLOCK_EXPR: {
+                    const auto* block = static_cast<const ASTNode_BlockExpr*>(node);
+                    encode(block->left_code_block.get(), index);
+                    encode(block->right_code_block.get(), index);
+                    if (rule == GrammarRule::IF_BLOCK_EXPR) {
+                        encode(static_cast<const ASTNode_ConditionalBlockExpr*>(node)->condition.get(), index);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            m_out.m_tags[index] = tag;
+            m_out.m_flags[index] = flags;
+            m_out.m_data[index] = data;
+            m_out.m_ends[index] = static_cast<NodeIndex>(m_out.m_kinds.size());
+        }
+
+    private:
+        FlatAst& m_out;
+
+        template <typename List>
+        void encode_all(const List& nodes, NodeIndex parent) {
+            for (const auto& node : nodes) {
+                encode(node.get(), parent);
+            }
+        }
+
+        uint32_t push_symbol(Symbol symbol) {
+            m_out.m_symbols.push_back(symbol);
+            return static_cast<uint32_t>(m_out.m_symbols.size() - 1);
+        }
+
+        // Appends a (first, count) pair to the extra words, returns where it starts
+        uint32_t push_range(const Symbol* begin, const Symbol* end) {
+            const uint32_t extra_index = static_cast<uint32_t>(m_out.m_extra.size());
+            m_out.m_extra.push_back(static_cast<uint32_t>(m_out.m_symbols.size()));
+            m_out.m_extra.push_back(static_cast<uint32_t>(end - begin));
+            for (const Symbol* symbol = begin; symbol != end; ++symbol) {
+                m_out.m_symbols.push_back(*symbol);
+            }
+            return extra_index;
+        }
+
+        uint32_t push_name(const QualifiedName& name) {
+            const uint32_t extra_index = push_range(name.name_spaces.begin(), name.name_spaces.end());
+            m_out.m_symbols.push_back(name.name);
+            ++m_out.m_extra[extra_index + 1];
+            return extra_index;
+        }
+    };
+
+    FlatAst FlatAst::build(const ASTNode_Program& program) {
+        FlatAst flat;
+        FlatAstEncoder(flat).encode(&program, NO_NODE);
+        return flat;
+    }
+
+    OperatorType FlatAst::operator_type(NodeIndex node) const {
+        return is_operator_rule(kind(node)) ? static_cast<OperatorType>(m_tags[node]) : OperatorType::INVALID;
+    }
+
+    TypeExprKind FlatAst::type_kind(NodeIndex node) const {
+        return kind(node) == GrammarRule::TYPE_EXPR ? static_cast<TypeExprKind>(m_tags[node]) : TypeExprKind::NONE;
+    }
+
+    NodeIndex FlatAst::next_sibling(NodeIndex node) const {
+        const NodeIndex parent_node = m_parents[node];
+        if (parent_node == NO_NODE || m_ends[node] >= m_ends[parent_node]) {
+            return NO_NODE;
+        }
+        return m_ends[node];
+    }
+
+    size_t FlatAst::child_count(NodeIndex node) const {
+        size_t count = 0;
+        for (NodeIndex child = node + 1; child < m_ends[node]; child = m_ends[child]) {
+            ++count;
+        }
+        return count;
+    }
+
+    Symbol FlatAst::identifier(NodeIndex node) const {
+        return has_identifier(kind(node)) ? m_symbols[m_data[node]] : Symbol{};
+    }
+
+    std::span<const Symbol> FlatAst::qualified_name(NodeIndex node) const {
+        switch (kind(node)) {
+            case GrammarRule::QUALIFIED_NAME_USAGE:
+            case GrammarRule::ATTRIBUTE:
+                return symbol_range(m_data[node]);
+            case GrammarRule::TYPE_EXPR:
+                if (type_kind(node) == TypeExprKind::TRIVIAL || type_kind(node) == TypeExprKind::GENERIC) {
+                    return symbol_range(m_data[node]);
+                }
+                break;
+            default:
+                break;
+        }
+        return {};
+    }
+
+    std::span<const Symbol> FlatAst::attribute_args(NodeIndex node) const {
+        return kind(node) == GrammarRule::ATTRIBUTE ? symbol_range(m_data[node] + 2) : std::span<const Symbol>();
+    }
+
+    size_t FlatAst::constraint_count(NodeIndex node) const {
+        return kind(node) == GrammarRule::GENERIC_PARAM ? m_extra[m_data[node]] : 0;
+    }
+
+    std::span<const Symbol> FlatAst::constraint(NodeIndex node, size_t index) const {
+        return symbol_range(m_data[node] + 1 + index * 2);
+    }
+
+    string_builder& FlatAst::append_name(string_builder& builder, NodeIndex node) const {
+        const std::span<const Symbol> name = qualified_name(node);
+        return append_qualified_name(builder, name.first(name.size() - 1), name.back());
+    }
+
+    simple_string FlatAst::get_name(NodeIndex node) const {
+        const GrammarRule rule = kind(node);
+        if (rule == GrammarRule::QUALIFIED_NAME_USAGE) {
+            thread_local string_builder builder;
+            builder << operator_type_to_name(operator_type(node)) << ' ';
+            append_name(builder, node);
+            return builder.build();
+        }
+        if (is_operator_rule(rule)) {
+            return operator_type_to_name(operator_type(node));
+        }
+
+        simple_string name = grammar_rule_to_name(rule);
+        if (is_statement_rule(rule) && !(m_flags[node] & FLAT_END_WITH_SEMICOLON)) {
+            name += "(RET)";
+        }
+        return name;
+    }
+
+    void FlatAst::serialize(string_builder& builder) const {
+        // Ends of the subtrees enclosing the current node, its depth is the stack size
+        vector<NodeIndex> open_ends;
+        for (NodeIndex node = 0; node < size(); ++node) {
+            while (!open_ends.empty() && node >= open_ends.back()) {
+                open_ends.pop_back();
+            }
+            for (size_t i = 0; i < open_ends.size(); ++i) {
+                builder << "  ";
+            }
+            builder << get_name(node);
+
+            const GrammarRule rule = kind(node);
+            if (has_identifier(rule)) {
+                builder << ' ' << identifier(node).str();
+            } else if (rule == GrammarRule::INTEGER_LITERAL) {
+                builder << ' ' << integer_value(node);
+            } else if (rule == GrammarRule::FLOAT_LITERAL) {
+                char digits[32];
+                const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), float_value(node));
+                builder << ' ' << std::string_view(digits, result.ptr - digits);
+            } else if (rule == GrammarRule::STRING_LITERAL) {
+                builder << " \"" << string_value(node) << '"';
+            } else if (rule == GrammarRule::TYPE_EXPR || rule == GrammarRule::ATTRIBUTE) {
+                if (!qualified_name(node).empty()) {
+                    append_name(builder << ' ', node);
+                }
+                if (type_kind(node) == TypeExprKind::ARRAY) {
+                    builder << " [" << array_size(node) << ']';
+                }
+            }
+            builder << '\n';
+            open_ends.push_back(m_ends[node]);
+        }
+    }
+}
+}
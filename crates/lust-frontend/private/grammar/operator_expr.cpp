@@ -46,44 +46,44 @@ namespace grammar
         return "UNKNOWN_OPERATOR";
     }
 
-    vector<const IASTNode*> ASTNode_Expr::collect_self_nodes() const {
-        return ASTNode_Statement::collect_self_nodes();
+    void ASTNode_Expr::for_each_child(ChildCallback callback) const {
+        ASTNode_Statement::for_each_child(callback);
     }
 
-    vector<const IASTNode*> ASTNode_Operator::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_Expr::collect_self_nodes();
-        res.push_back(left_oprand.get());
-        res.push_back(right_oprand.get());
-        return res;
+    void ASTNode_Operator::for_each_child(ChildCallback callback) const {
+        ASTNode_Expr::for_each_child(callback);
+        callback(left_oprand);
+        callback(right_oprand);
     }
 
     simple_string ASTNode_Operator::get_name() const {
         return operator_type_to_name(operator_type);
     }
 
-    vector<const IASTNode*> ASTNode_QualifiedName::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_Expr::collect_self_nodes();
-        res.push_back(left_oprand.get());
-        res.push_back(right_oprand.get());
-        res.push_back(passing_parameters.get());
-        return res;
+    void ASTNode_QualifiedName::for_each_child(ChildCallback callback) const {
+        ASTNode_Expr::for_each_child(callback);
+        callback(left_oprand);
+        callback(right_oprand);
+        callback(generic_params);
+        callback(passing_parameters);
     }
 
     simple_string ASTNode_QualifiedName::get_name() const {
-        return operator_type_to_name(operator_type);
+        thread_local string_builder builder;
+        builder << operator_type_to_name(operator_type) << ' ';
+        append_qualified_name(builder, qualified_name);
+        return builder.build();
     }
 
-    vector<const IASTNode*> ASTNode_BlockExpr::collect_self_nodes() const {
-        auto res = ASTNode_Operator::collect_self_nodes();
-        res.push_back(left_code_block.get());
-        res.push_back(right_code_block.get());
-        return res;
+    void ASTNode_BlockExpr::for_each_child(ChildCallback callback) const {
+        ASTNode_Operator::for_each_child(callback);
+        callback(left_code_block);
+        callback(right_code_block);
     }
 
-    vector<const IASTNode*> ASTNode_ConditionalBlockExpr::collect_self_nodes() const {
-        auto res = ASTNode_BlockExpr::collect_self_nodes();
-        res.push_back(condition.get());
-        return res;
+    void ASTNode_ConditionalBlockExpr::for_each_child(ChildCallback callback) const {
+        ASTNode_BlockExpr::for_each_child(callback);
+        callback(condition);
     }
 }
 }
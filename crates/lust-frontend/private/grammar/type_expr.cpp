@@ -75,42 +75,30 @@ namespace grammar
         return false;
     }
 
-    vector<const IASTNode*> ASTNode_TypeExpr_Tuple::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_TypeExpr::collect_self_nodes();
-        for (auto& t : composite_types) {
-            res.push_back(t.get());
-        }
-        return res;
+    void ASTNode_TypeExpr_Tuple::for_each_child(ChildCallback callback) const {
+        ASTNode_TypeExpr::for_each_child(callback);
+        callback(composite_types);
     }
 
-    vector<const IASTNode*> ASTNode_TypeExpr_Reference::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_TypeExpr::collect_self_nodes();
-        res.push_back(referenced_type.get());
-        return res;
+    void ASTNode_TypeExpr_Reference::for_each_child(ChildCallback callback) const {
+        ASTNode_TypeExpr::for_each_child(callback);
+        callback(referenced_type);
     }
 
-    vector<const IASTNode*> ASTNode_TypeExpr_Generic::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_TypeExpr::collect_self_nodes();
-        for (auto& t : params) {
-            res.push_back(t.get());
-        }
-        return res;
+    void ASTNode_TypeExpr_Generic::for_each_child(ChildCallback callback) const {
+        ASTNode_TypeExpr::for_each_child(callback);
+        callback(params);
     }
 
-    vector<const IASTNode*> ASTNode_TypeExpr_Function::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_TypeExpr::collect_self_nodes();
-        for (auto& t : param_types) {
-            res.push_back(t.get());
-        }
-        res.push_back(return_type.get());
-        return res;
+    void ASTNode_TypeExpr_Function::for_each_child(ChildCallback callback) const {
+        ASTNode_TypeExpr::for_each_child(callback);
+        callback(param_types);
+        callback(return_type);
     }
 
-    vector<const IASTNode*> ASTNode_TypeExpr_Array::collect_self_nodes() const {
-        vector<const IASTNode*> res = ASTNode_TypeExpr::collect_self_nodes();
-        res.push_back(array_type.get());
-        return res;
+    void ASTNode_TypeExpr_Array::for_each_child(ChildCallback callback) const {
+        ASTNode_TypeExpr::for_each_child(callback);
+        callback(array_type);
     }
 }
 }
-
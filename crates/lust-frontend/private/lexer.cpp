@@ -1,6 +1,30 @@
 #include "lexer.hpp"
-
-#include <unordered_map>
+#include "lexer/keyword_table.hpp"
+#include "char_class.hpp"
+#include "simd_scan.hpp"
+#include "mapped_file.hpp"
+#include "source_map.hpp"
+#include "utf8.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <io.h>
+#else
+#   include <cerrno>
+#   include <unistd.h>
+#endif
 
 namespace lust
 {
@@ -8,20 +32,49 @@ namespace lexer
 {
     class Tokenizer : public ITokenizer {
     public:
-        Tokenizer(std::string_view in_text);
+        Tokenizer(std::string_view in_text, const TokenizerOptions& options = {});
+
+        // Tag to view the caller's text instead of copying it, the caller keeps it alive
+        struct BorrowText {};
+        Tokenizer(std::string_view in_text, BorrowText, const TokenizerOptions& options = {});
 
         const std::string_view original_text() const override;
 
+        int64_t original_text_offset() const override;
+
         Token next_token() override;
 
+        size_t next_tokens(Token* out, size_t max_count) override;
+
+        TokenBuffer tokenize_all() override;
+
+        TokenBuffer tokenize_all_parallel(uint32_t thread_count, size_t min_chunk_size) override;
+
         bool is_cursor_valid() const override;
 
+        bool is_streaming() const override;
+
         /**
          * @brief Lookahead 1 token type state
          */
         TerminalTokenType get_pervious_token_type() const override;
 
+        TokenizerState save_state() const override;
+
+        bool restore_state(const TokenizerState& state) override;
+
+        const CommentTable& comments() const override;
+
+        const TokenBuffer& document_tokens() override;
+
+        TokenEdit apply_edit(int64_t offset, int64_t removed_length, std::string_view inserted_text) override;
+
     protected:
+        /**
+         * @brief Whether the cursor is inside the current text, unlike is_cursor_valid() it can't be overridden
+         */
+        bool is_cursor_in_text() const;
+
         char current_char() const;
 
         /**
@@ -29,15 +82,27 @@ namespace lexer
          */
         char next_char();
 
+        /**
+         * @brief Lookahead `offset` chars without eating
+         */
+        char peek_char(int64_t offset) const;
+
         /**
          * @brief eat space, \\n, \v, \f, \r, \t
          */
         void consume_whitespace();
 
         /**
-         * @brief Lookup the keyword table. If not found, it will be IDENT.
+         * @brief eat whitespace, and comments unless they are emitted as tokens
+         * @param text_may_be_cut A comment running to the end of the text is left alone, the rest of it is still to come
+         * @return false if it stopped on such a comment
+         */
+        bool consume_trivia(bool text_may_be_cut = false);
+
+        /**
+         * @brief eat chars as long as they belong to `char_class_mask`
          */
-        TerminalTokenType lookup_keyword(std::string_view text);
+        void consume_while(uint8_t char_class_mask);
 
         /**
          * Inv lookahead
@@ -53,11 +118,58 @@ namespace lexer
 
         Token error_token(std::string_view message);
 
-        Token make_token(TerminalTokenType type, std::string_view val);
+        /**
+         * @brief Make a token viewing [start, end) of the source buffer, no copy happens
+         */
+        Token make_token(TerminalTokenType type, int64_t start, int64_t end);
+
+        /**
+         * @brief Make a token whose spelling ends at current char
+         * @note Current char will be eaten at the end of next_token()
+         */
+        Token make_token(TerminalTokenType type, std::string_view spelling);
+
+        /**
+         * @brief Find the closing quote of a string literal whose content starts at `start`, text size if unterminated
+         * @param out_has_escapes Set if a backslash was skipped on the way
+         */
+        int64_t find_string_end(int64_t start, bool& out_has_escapes) const;
+
+        /**
+         * @brief Lex every token starting in [cursor, chunk_end) into `out`, the last one may run past `chunk_end`.
+         * The cursor is left right after the last token. Stops early at END or ERROR like tokenize_all().
+         */
+        void lex_chunk(int64_t chunk_end, TokenBuffer& out);
+
+        int64_t cursor() const;
+
+        /**
+         * @brief Lex `text` from now on, starting at `cursor`
+         */
+        void rebind_text(std::string_view text, int64_t cursor);
+
+        /**
+         * @brief Validate the whole text once, lexing stops with an ERROR at the first invalid UTF-8 sequence
+         * @param text_may_be_cut A sequence cut by the end of the text is accepted, the text will be extended
+         */
+        void validate_utf8(bool text_may_be_cut = false);
+
+        /**
+         * @brief Validate the text after an edit replaced the bytes before `edit_end`, starting at `edit_begin`
+         */
+        void validate_utf8_after_edit(int64_t edit_begin, int64_t edit_end);
+
+        /**
+         * @brief Length of the non-ASCII identifier code point at `pos`, 0 if there is none
+         */
+        int64_t unicode_ident_length(int64_t pos, bool is_start) const;
 
     private:
+        // Owned copy of the input, empty when the text is borrowed
+        std::string m_owned_text;
+
         // UTF-8 encoded string, be careful when using a single char
-        std::string m_text_to_parse;
+        std::string_view m_text_to_parse;
 
         // Cursor pointing to current char
         int64_t m_text_cursor = 0;
@@ -65,6 +177,16 @@ namespace lexer
         // Previous token type
         TerminalTokenType m_previous_token_type = TerminalTokenType::NONE;
 
+        // Offset of the first invalid UTF-8 sequence, max if the text is valid
+        int64_t m_utf8_error_pos = std::numeric_limits<int64_t>::max();
+
+        TokenizerOptions m_options;
+        CommentTable m_comments;
+
+        // Tokens of the whole text, see document_tokens()
+        TokenBuffer m_document;
+        bool m_has_document = false;
+
     protected:
         // IDENT / Keyword
         Token identifier_or_keyword();
@@ -81,12 +203,220 @@ namespace lexer
         // Comment
         Token comment();
 
+        /**
+         * @brief Offset of the line break ending a comment whose text starts at `start`, text size if there is none
+         */
+        int64_t find_comment_end(int64_t start) const;
+
+    };
+
+    /**
+     * @brief Tokenizer lexing a memory mapped file in place
+     */
+    class FileTokenizer final : public Tokenizer {
+    public:
+        FileTokenizer(MappedFile&& file, const TokenizerOptions& options)
+            : Tokenizer(file.text(), BorrowText{}, options)
+            , m_file(std::move(file))
+        {
+            validate_utf8();
+        }
+
+    private:
+        // Moving the mapping keeps the borrowed view valid
+        MappedFile m_file;
+    };
+
+    /**
+     * @brief Tokenizer pulling its input into a fixed-size window, memory stays O(window) whatever the input size.
+     * The window is double buffered: when a token may run past the window end, it is moved to the front
+     * of the other buffer, the rest is refilled and the token is lexed again.
+     * The previous buffer is left untouched, so a token value stays valid until next_token() has been called twice more.
+     */
+    class StreamTokenizer final : public Tokenizer {
+    public:
+        StreamTokenizer(ReadCallback read, size_t window_size, const TokenizerOptions& options);
+
+        int64_t original_text_offset() const override;
+
+        Token next_token() override;
+
+        size_t next_tokens(Token* out, size_t max_count) override;
+
+        TokenBuffer tokenize_all() override;
+
+        TokenBuffer tokenize_all_parallel(uint32_t thread_count, size_t min_chunk_size) override;
+
+        bool is_cursor_valid() const override;
+
+        bool is_streaming() const override;
+
+        const TokenBuffer& document_tokens() override;
+
+        TokenEdit apply_edit(int64_t offset, int64_t removed_length, std::string_view inserted_text) override;
+
+    private:
+        // Bytes which must follow a token before it is known to be complete, `..=` and `1.5` need 2
+        static constexpr int64_t LOOKAHEAD = 4;
+
+        /**
+         * @brief Move [keep_from, filled) to the front of the other buffer and fill the rest
+         * @return false if the kept bytes already fill the window
+         */
+        bool refill(int64_t keep_from);
+
+        ReadCallback m_read;
+        size_t m_window_size;
+        std::unique_ptr<char[]> m_buffers[2];
+        int m_active_buffer = 0;
+        size_t m_filled = 0;
+        // Offset of the active buffer's first byte in the whole input
+        int64_t m_window_offset = 0;
+        bool m_end_of_input = false;
+
+        TokenBuffer m_unsupported_document;
     };
 
-    Tokenizer::Tokenizer(std::string_view in_text)
+    StreamTokenizer::StreamTokenizer(ReadCallback read, size_t window_size, const TokenizerOptions& options)
+        : Tokenizer(std::string_view(), BorrowText{}, options)
+        , m_read(std::move(read))
+        , m_window_size(std::max<size_t>(window_size, LOOKAHEAD * 2))
+    {
+        m_buffers[0] = std::make_unique<char[]>(m_window_size);
+        m_buffers[1] = std::make_unique<char[]>(m_window_size);
+        // Start from the second buffer, the first refill swaps to buffer 0
+        m_active_buffer = 1;
+        refill(0);
+    }
+
+    int64_t StreamTokenizer::original_text_offset() const
+    {
+        return m_window_offset;
+    }
+
+    Token StreamTokenizer::next_token()
+    {
+        while (true) {
+            // Skipped comments are eaten before the token starts, only a comment cut by the window end is kept in it
+            if (!consume_trivia(!m_end_of_input)) {
+                if (!refill(cursor())) {
+                    Token error = error_token("Comment is longer than the stream window");
+                    error.pos += m_window_offset;
+                    return error;
+                }
+                continue;
+            }
+            const int64_t start = cursor();
+
+            Token token = Tokenizer::next_token();
+
+            // Stopping close to the window end, the token may be cut or a longer operator may follow
+            if (m_end_of_input || cursor() + LOOKAHEAD <= static_cast<int64_t>(m_filled)) {
+                token.pos += m_window_offset;
+                return token;
+            }
+
+            if (!refill(start)) {
+                Token error = error_token("Token is longer than the stream window");
+                error.pos = start + m_window_offset;
+                return error;
+            }
+        }
+    }
+
+    size_t StreamTokenizer::next_tokens(Token* out, size_t max_count)
+    {
+        size_t count = 0;
+        while (count < max_count) {
+            out[count] = StreamTokenizer::next_token();
+            if (out[count++].type == TerminalTokenType::END) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    TokenBuffer StreamTokenizer::tokenize_all()
+    {
+        // A token buffer views the whole source, which is exactly what a stream doesn't keep
+        TokenBuffer buffer;
+        buffer.push_back(error_token("A streaming tokenizer can't be buffered, use next_token()"));
+        return buffer;
+    }
+
+    TokenBuffer StreamTokenizer::tokenize_all_parallel(uint32_t, size_t)
+    {
+        return tokenize_all();
+    }
+
+    const TokenBuffer& StreamTokenizer::document_tokens()
+    {
+        // Holds the ERROR of tokenize_all(), the window is left alone
+        if (m_unsupported_document.empty()) {
+            m_unsupported_document = tokenize_all();
+        }
+        return m_unsupported_document;
+    }
+
+    TokenEdit StreamTokenizer::apply_edit(int64_t, int64_t, std::string_view)
+    {
+        return {};
+    }
+
+    bool StreamTokenizer::is_cursor_valid() const
+    {
+        return cursor() >= 0 && (cursor() < static_cast<int64_t>(m_filled) || !m_end_of_input);
+    }
+
+    bool StreamTokenizer::is_streaming() const
+    {
+        return true;
+    }
+
+    bool StreamTokenizer::refill(int64_t keep_from)
+    {
+        const size_t kept = m_filled - std::min<size_t>(keep_from, m_filled);
+        if (kept >= m_window_size) {
+            return false;
+        }
+
+        const char* const old_window = m_buffers[m_active_buffer].get();
+        m_active_buffer ^= 1;
+        char* const window = m_buffers[m_active_buffer].get();
+
+        std::copy(old_window + m_filled - kept, old_window + m_filled, window);
+        m_window_offset += static_cast<int64_t>(m_filled - kept);
+        m_filled = kept;
+
+        // Pipes deliver short reads, keep reading until the window is full
+        while (!m_end_of_input && m_filled < m_window_size) {
+            const size_t read_size = m_read(window + m_filled, m_window_size - m_filled);
+            if (read_size == 0) {
+                m_end_of_input = true;
+            }
+            m_filled += std::min(read_size, m_window_size - m_filled);
+        }
+
+        rebind_text(std::string_view(window, m_filled), 0);
+        validate_utf8(!m_end_of_input);
+        return true;
+    }
+
+    Tokenizer::Tokenizer(std::string_view in_text, const TokenizerOptions& options)
+        : m_owned_text(in_text)
+        , m_text_to_parse(m_owned_text)
+        , m_text_cursor(0)
+        , m_previous_token_type(TerminalTokenType::NONE)
+        , m_options(options)
+    {
+        validate_utf8();
+    }
+
+    Tokenizer::Tokenizer(std::string_view in_text, BorrowText, const TokenizerOptions& options)
         : m_text_to_parse(in_text)
         , m_text_cursor(0)
         , m_previous_token_type(TerminalTokenType::NONE)
+        , m_options(options)
     { }
 
     const std::string_view Tokenizer::original_text() const
@@ -94,29 +424,35 @@ namespace lexer
         return m_text_to_parse;
     }
 
+    int64_t Tokenizer::original_text_offset() const
+    {
+        return 0;
+    }
+
     Token Tokenizer::next_token()
     {
         // Consuming whitespace at the start
-        consume_whitespace();
+        consume_trivia();
 
+        const int64_t token_start = m_text_cursor;
         Token token;
 
         char current = current_char();
 
         // Check for EOF
-        if (current == EOF || !is_cursor_valid()) {
-            token = make_token(TerminalTokenType::END, "" );
+        if (current == EOF || !is_cursor_in_text()) {
+            token = make_token(TerminalTokenType::END, m_text_cursor, m_text_cursor);
             goto token_exit;
         }
 
         // Check for digits (integer and float literals)
-        if (lust_is_digit(current)) {
+        if (is_digit(current)) {
             token = number_literal();
             goto token_exit;
         }
 
         // Check for keywords and identifiers
-        if (lust_is_alpha(current) || current == '_') {
+        if (is_ident_start(current) || unicode_ident_length(m_text_cursor, true) > 0) {
             token = identifier_or_keyword();
             goto token_exit;
         }
@@ -128,459 +464,1037 @@ namespace lexer
             goto token_exit;
         }
 
-        // Check for single character tokens and operators
-        switch (current) {
-            case '=':
-                token = match_next('=') ? make_token(TerminalTokenType::EQEQ, "==") : make_token(TerminalTokenType::EQ, "=");
-                break;
-            case '!':
-                token = match_next('=') ? make_token(TerminalTokenType::NEQ, "!=") : make_token(TerminalTokenType::NOT, "!");
-                break;
-            case '<':
-                token = match_next('=') ? make_token(TerminalTokenType::LTE, "<=") : make_token(TerminalTokenType::LT, "<");
-                break;
-            case '>':
-                token = match_next('=') ? make_token(TerminalTokenType::GTE, ">=") : make_token(TerminalTokenType::GT, ">");
-                break;
-            case '+':
-                token = match_next('+') ? make_token(TerminalTokenType::PLUSPLUS, "++") :
-                    match_next('=') ? make_token(TerminalTokenType::PLUS_EQUAL, "+=") : make_token(TerminalTokenType::PLUS, "+");
-                break;
-            case '-':
-                token = match_next('-') ? make_token(TerminalTokenType::MINUSMINUS, "--") 
-                    : match_next('>') ? make_token(TerminalTokenType::ARROW, "->") 
-                    : match_next('=') ? make_token(TerminalTokenType::MINUS_EQUAL, "-=") : make_token(TerminalTokenType::MINUS, "-");
-                break;
-            case '*':
-                token = match_next('*') ? make_token(TerminalTokenType::STARSTAR, "**") :
-                    match_next('=') ? make_token(TerminalTokenType::STAR_EQUAL, "*=") : make_token(TerminalTokenType::STAR, "*");
-                break;
-            case '/':
-                token = match_next('/') ? comment() : make_token(TerminalTokenType::SLASH, "/");
-                break;
-            case '(':
-                token = make_token(TerminalTokenType::LPAREN, "(");
-                break;
-            case ')':
-                token = make_token(TerminalTokenType::RPAREN, ")");
-                break;
-            case '{':
-                token = make_token(TerminalTokenType::LBRACE, "{");
-                break;
-            case '}':
-                token = make_token(TerminalTokenType::RBRACE, "}");
-                break;
-            case ';':
-                token = make_token(TerminalTokenType::SEMICOLON, ";");
-                break;
-            case ':':
-                token = match_next(':') ? make_token(TerminalTokenType::COLONCOLON, "::") : make_token(TerminalTokenType::COLON, ":");
-                break;
-            case '.':
-                token = match_next('.') ? 
-                        match_next('=') ? make_token(TerminalTokenType::RANGEEQ, "..=") : make_token(TerminalTokenType::RANGE, "..")
-                    : make_token(TerminalTokenType::DOT, ".");
-                break;
-            case ',':
-                token = make_token(TerminalTokenType::COMMA, ",");
-                break;
-            case '\'':
-                token = make_token(TerminalTokenType::SQ, "'");
-                break;
-            case '"':
-                token = string_literal();
-                break;
-            case '[':
-                token = make_token(TerminalTokenType::LBRACKET, "[");
-                break;
-            case ']':
-                token = make_token(TerminalTokenType::RBRACKET, "]");
-                break;
-            case '|':
-                token = match_next('|') ? make_token(TerminalTokenType::OR, "||") :
-                    match_next('=') ? make_token(TerminalTokenType::OR_EQUAL, "|=") : make_token(TerminalTokenType::BITOR, "|");
-                break;
-            case '&':
-                token = match_next('&') ? make_token(TerminalTokenType::AND, "&&") :
-                    match_next('=') ? make_token(TerminalTokenType::AND_EQUAL, "&=") : make_token(TerminalTokenType::BITAND, "&");
-                break;
-            case '^':
-                token = match_next('=') ? make_token(TerminalTokenType::XOR_EQUAL, "^=") : make_token(TerminalTokenType::BITXOR, "^");
-                break;
-            case '~':
-                token = make_token(TerminalTokenType::BITINV, "~");
-                break;
-            case '#':
-                token = match_next('[') ? make_token(TerminalTokenType::ATTRIBUTE_START, "#[") :
-                    match_next('!') ? make_token(TerminalTokenType::GLOBAL_ATTRIBUTE_START, "#!") : make_token(TerminalTokenType::HASH, "#");
-                break;
-            case '%':
-                token = match_next('=') ? make_token(TerminalTokenType::PRECENTAGE_EQUAL, "%=") : make_token(TerminalTokenType::PRECENTAGE, "%");
-                break;
-            case '\r':
-            case '\n':
-                token = newline();
-                break;
-            case '\0':
-                token = make_token(TerminalTokenType::END, "EOF");
-                break;
-            default:
-                token = error_token("Unexpected character");
+        // Check for punctuators, one pass of the DFA generated from token_specs
+        {
+            const PunctuatorDfa::Match match = punctuator_dfa.match(m_text_to_parse.data() + m_text_cursor, m_text_to_parse.data() + m_text_to_parse.size());
+            switch (match.type) {
+                case TerminalTokenType::COMMENT:
+                    // comment() and string_literal() stay on their last char, eat it as well
+                    m_text_cursor++;
+                    token = comment();
+                    m_text_cursor++;
+                    break;
+                case TerminalTokenType::DQ:
+                    token = string_literal();
+                    if (token.type != TerminalTokenType::ERROR) {
+                        m_text_cursor++;
+                    }
+                    break;
+                case TerminalTokenType::NONE:
+                    if (current == '\0') {
+                        token = make_token(TerminalTokenType::END, m_text_cursor, m_text_cursor);
+                        m_text_cursor++;
+                    } else {
+                        token = error_token("Unexpected character");
+                    }
+                    break;
+                default:
+                    token = make_token(match.type, m_text_cursor, m_text_cursor + static_cast<int64_t>(match.length));
+                    m_text_cursor += static_cast<int64_t>(match.length);
+                    break;
+            }
         }
 
-        if (token.type != TerminalTokenType::ERROR) {
-            // match_next() will eat token if matched
-            // so we don't need to add `token.value.size()`
-            m_text_cursor++;
+token_exit:
+        // The token covers an invalid UTF-8 sequence
+        if (m_utf8_error_pos < std::max(m_text_cursor, token_start + 1)) {
+            m_text_cursor = m_utf8_error_pos;
+            token = error_token("Invalid UTF-8 sequence");
         }
 
-token_exit:
         m_previous_token_type = token.type;
         return token;
     }
 
-    bool Tokenizer::is_cursor_valid() const
+    size_t Tokenizer::next_tokens(Token* out, size_t max_count)
     {
-        return m_text_cursor < m_text_to_parse.size() && m_text_cursor >= 0;
+        size_t count = 0;
+        while (count < max_count) {
+            out[count] = Tokenizer::next_token();
+            if (out[count++].type == TerminalTokenType::END) {
+                break;
+            }
+        }
+        return count;
     }
 
-    TerminalTokenType Tokenizer::get_pervious_token_type() const
+    TokenBuffer Tokenizer::tokenize_all()
     {
-        return m_previous_token_type;
-    }
+        TokenBuffer buffer(original_text());
 
-    char Tokenizer::current_char() const
-    {
-        return is_cursor_valid() ? m_text_to_parse[m_text_cursor] : EOF;
-    }
+        if (m_text_to_parse.size() > std::numeric_limits<uint32_t>::max()) {
+            buffer.push_back(error_token("Source is too large for a token buffer"));
+            return buffer;
+        }
 
-    char Tokenizer::next_char()
-    {
-        ++m_text_cursor;
+        // Typical code averages well above 8 bytes per token
+        buffer.reserve((m_text_to_parse.size() - std::min<size_t>(m_text_cursor, m_text_to_parse.size())) / 8 + 1);
 
-        if (is_cursor_valid()) {
-            return m_text_to_parse[m_text_cursor];
+        while (true) {
+            Token token = next_token();
+            buffer.push_back(token);
+            if (token.type == TerminalTokenType::END || token.type == TerminalTokenType::ERROR) {
+                break;
+            }
         }
 
-        return EOF;
+        return buffer;
     }
 
-    void Tokenizer::consume_whitespace()
+    TokenBuffer Tokenizer::tokenize_all_parallel(uint32_t thread_count, size_t min_chunk_size)
     {
-        while (is_cursor_valid()) {
-            if (lust_is_space(current_char())) {
-                next_char();
-            } else if (current_char() == '/' && m_text_to_parse[m_text_cursor + 1] == '/') {
-                break;
-            } else {
+        const int64_t text_size = static_cast<int64_t>(m_text_to_parse.size());
+        const int64_t begin = std::clamp<int64_t>(m_text_cursor, 0, text_size);
+        const size_t remaining = static_cast<size_t>(text_size - begin);
+
+        thread_count = std::max<uint32_t>(thread_count, 1);
+        // More chunks than threads, so a chunk full of long tokens doesn't stall the others
+        const size_t max_chunk_count = std::min<size_t>(static_cast<size_t>(thread_count) * 4, remaining / std::max<size_t>(min_chunk_size, 1));
+
+        if (thread_count == 1 || max_chunk_count < 2 || m_text_to_parse.size() > std::numeric_limits<uint32_t>::max()) {
+            return tokenize_all();
+        }
+
+        // Chunks start right after a line break, a comment never crosses one,
+        // so a chunk either starts between two tokens or inside a multi-line string literal
+        const char* const data = m_text_to_parse.data();
+        std::vector<int64_t> bounds{ begin };
+        for (size_t i = 1; i < max_chunk_count; ++i) {
+            const int64_t target = std::max<int64_t>(begin + remaining * i / max_chunk_count, bounds.back());
+            const int64_t bound = simd::find_line_break(data + target, data + text_size) - data + 1;
+            if (bound >= text_size) {
                 break;
             }
+            if (bound > bounds.back()) {
+                bounds.push_back(bound);
+            }
         }
-    }
+        bounds.push_back(text_size);
 
-    TerminalTokenType Tokenizer::lookup_keyword(std::string_view text)
-    {
-        static const std::unordered_map<std::string, TerminalTokenType> keywords = {
-            { "let", TerminalTokenType::LET },
-            { "const", TerminalTokenType::CONST },
-            { "mut", TerminalTokenType::MUT },
-            { "fn", TerminalTokenType::FN },
-            { "struct", TerminalTokenType::STRUCT },
-            { "trait", TerminalTokenType::TRAIT },
-            { "impl", TerminalTokenType::IMPL },
-            { "for", TerminalTokenType::FOR },
-            { "type", TerminalTokenType::TYPE },
-            { "if", TerminalTokenType::IF },
-            { "else", TerminalTokenType::ELSE },
-            { "loop", TerminalTokenType::LOOP },
-            { "while", TerminalTokenType::WHILE },
-            { "break", TerminalTokenType::BREAK },
-            { "continue", TerminalTokenType::CONTINUE },
-            { "in", TerminalTokenType::IN },
-            { "enum", TerminalTokenType::ENUM },
-            { "or", TerminalTokenType::OR },
-            { "and", TerminalTokenType::AND },
-            { "not", TerminalTokenType::NOT },
-            { "async", TerminalTokenType::ASYNC },
-            { "await", TerminalTokenType::AWAIT },
-            { "pub", TerminalTokenType::PUB },
-            { "crate", TerminalTokenType::CRATE },
-            { "super", TerminalTokenType::SUPER },
-            { "mod", TerminalTokenType::MOD },
-            { "self", TerminalTokenType::SELF },
-            { "as", TerminalTokenType::AS },
-            { "static", TerminalTokenType::STATIC },
-            { "ref", TerminalTokenType::REF },
-            { "true", TerminalTokenType::TRUE },
-            { "false", TerminalTokenType::FALSE },
-            { "return", TerminalTokenType::RETURN },
+        const size_t chunk_count = bounds.size() - 1;
+
+        struct ChunkResult {
+            TokenBuffer tokens;
+            CommentTable comments;
+            // Cursor after the last token, past the chunk end if a string literal crosses it
+            int64_t end_cursor = 0;
         };
-        if (auto it = keywords.find(std::string(text)); it != keywords.end()) {
-            return it->second;
-        }
 
-        return TerminalTokenType::IDENT;
-    }
+        auto lex_range = [this](int64_t start, int64_t end) {
+            ChunkResult result;
+            result.tokens = TokenBuffer(m_text_to_parse);
+            result.tokens.reserve(static_cast<size_t>(end - start) / 8 + 1);
+
+            Tokenizer chunk_lexer(m_text_to_parse, BorrowText{}, m_options);
+            chunk_lexer.m_utf8_error_pos = m_utf8_error_pos;
+            chunk_lexer.m_text_cursor = start;
+            chunk_lexer.lex_chunk(end, result.tokens);
+            result.end_cursor = chunk_lexer.m_text_cursor;
+            result.comments = std::move(chunk_lexer.m_comments);
+            return result;
+        };
 
-    bool Tokenizer::match_next(char expected)
-    {
-        if (is_cursor_valid() && m_text_to_parse[m_text_cursor + 1] == expected) {
-            m_text_cursor++;
-            return true;
-        }
-        return false;
-    }
+        // Speculate that every chunk starts between two tokens
+        std::vector<ChunkResult> results(chunk_count);
+        std::atomic<size_t> next_chunk{ 0 };
+        auto worker = [&] {
+            for (size_t i = next_chunk++; i < chunk_count; i = next_chunk++) {
+                results[i] = lex_range(bounds[i], bounds[i + 1]);
+            }
+        };
 
-    bool Tokenizer::match_next(std::string_view expected)
-    {
-        if (m_text_cursor + expected.size() >= m_text_to_parse.size()) {
-            return false;
+        std::vector<std::thread> threads;
+        threads.reserve(std::min<size_t>(thread_count, chunk_count) - 1);
+        for (size_t i = 1; i < std::min<size_t>(thread_count, chunk_count); ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
         }
 
-        size_t start = m_text_cursor;
-        for (int i = 0; i < expected.size(); ++i) {
-            if (expected[i] != m_text_to_parse[start + i]) {
-                return false;
+        // Stitch in order, `resume` is where the sequential lexer would be after the previous chunk
+        TokenBuffer buffer(original_text());
+        buffer.reserve(remaining / 8 + 1);
+        int64_t resume = begin;
+        for (size_t i = 0; i < chunk_count; ++i) {
+            if (resume >= bounds[i + 1]) {
+                // A string literal covers the whole chunk
+                continue;
+            }
+
+            ChunkResult chosen = resume > bounds[i]
+                // The previous chunk ended inside a string literal, the speculation is wrong,
+                // lex again from the closing quote ("in string" start state)
+                ? lex_range(resume, bounds[i + 1])
+                : std::move(results[i]);
+
+            resume = chosen.end_cursor;
+            const bool stopped = !chosen.tokens.empty()
+                && (chosen.tokens.type_at(chosen.tokens.size() - 1) == TerminalTokenType::END
+                    || chosen.tokens.type_at(chosen.tokens.size() - 1) == TerminalTokenType::ERROR);
+            buffer.append(std::move(chosen.tokens));
+            m_comments.append(std::move(chosen.comments));
+
+            if (stopped) {
+                m_text_cursor = resume;
+                m_previous_token_type = buffer.type_at(buffer.size() - 1);
+                return buffer;
             }
         }
 
-        m_text_cursor += expected.size();
-        return true;
+        m_text_cursor = resume;
+        buffer.push_back(next_token());
+
+        return buffer;
     }
 
-    Token Tokenizer::error_token(std::string_view message)
+    int64_t Tokenizer::cursor() const
     {
-        return { TerminalTokenType::ERROR, message, m_text_cursor };
+        return m_text_cursor;
     }
 
-    Token Tokenizer::make_token(TerminalTokenType type, std::string_view val)
+    void Tokenizer::rebind_text(std::string_view text, int64_t cursor)
     {
-        return { type, val, m_text_cursor - static_cast<int64_t>(val.size()) };
+        m_owned_text.clear();
+        m_text_to_parse = text;
+        m_text_cursor = cursor;
     }
 
-    Token Tokenizer::identifier_or_keyword()
+    void Tokenizer::validate_utf8(bool text_may_be_cut)
     {
-        size_t start = m_text_cursor;
+        const char* const begin = m_text_to_parse.data();
+        const char* const end = begin + m_text_to_parse.size();
+        const char* const invalid = simd::find_invalid_utf8(begin, end);
 
-        while (is_cursor_valid() && (lust_is_alnum(current_char()) || current_char() == '_')) {
-            next_char();
+        // A sequence is at most 4 bytes, if it is cut the rest is still to come
+        if (invalid == end || (text_may_be_cut && end - invalid < 4)) {
+            m_utf8_error_pos = std::numeric_limits<int64_t>::max();
+        } else {
+            m_utf8_error_pos = invalid - begin;
         }
-
-        std::string text = m_text_to_parse.substr(start, m_text_cursor - start);
-        TerminalTokenType type = lookup_keyword(text);
-
-        return make_token(type, text);
     }
 
-    Token Tokenizer::number_literal()
+    void Tokenizer::validate_utf8_after_edit(int64_t edit_begin, int64_t edit_end)
     {
-        size_t start = m_text_cursor;
-        bool is_float = false;
-
-        while (is_cursor_valid() && lust_is_digit(current_char())) {
-            next_char();
+        if (m_utf8_error_pos != std::numeric_limits<int64_t>::max()) {
+            validate_utf8();
+            return;
         }
 
-        // Check for a floating-point number
-        if (current_char() == '.' && lust_is_digit(next_char())) {
-            while (is_cursor_valid() && lust_is_digit(current_char())) {
-                next_char();
-            }
-            is_float = true;
+        // The text was valid, only sequences overlapping the edit can be broken
+        const char* const text = m_text_to_parse.data();
+        const int64_t size = static_cast<int64_t>(m_text_to_parse.size());
+        auto is_continuation = [&](int64_t pos) {
+            return (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80;
+        };
+        int64_t begin = edit_begin;
+        while (begin > 0 && edit_begin - begin < 3 && is_continuation(begin)) {
+            --begin;
+        }
+        int64_t end = edit_end;
+        while (end < size && end - edit_end < 3 && is_continuation(end)) {
+            ++end;
         }
 
-        std::string text = m_text_to_parse.substr(start, m_text_cursor - start);
-
-        if (is_float) {
-            return make_token(TerminalTokenType::FLOAT, text);
-        } else {
-            return make_token(TerminalTokenType::INT, text);
+        const char* const invalid = simd::find_invalid_utf8(text + begin, text + end);
+        if (invalid != text + end) {
+            m_utf8_error_pos = invalid - text;
         }
     }
 
-    Token Tokenizer::string_literal()
+    int64_t Tokenizer::unicode_ident_length(int64_t pos, bool is_start) const
     {
-        // Skip the opening quote
-        size_t start = ++m_text_cursor;
-
-        bool is_escaped = false;
-
-        while (is_cursor_valid()) {
-            char c = current_char();
-
-            if (!is_escaped && c == '"') {
-                break;
-            } else if (is_escaped) {
-                is_escaped = false;
-            } else if (c == '\\') {
-                is_escaped = true;
-            } else {
-                is_escaped = false;
-            }
-
-            next_char();
+        if (pos < 0 || pos >= static_cast<int64_t>(m_text_to_parse.size()) || static_cast<unsigned char>(m_text_to_parse[pos]) < 0x80) {
+            return 0;
         }
 
-        if (!is_cursor_valid() || current_char() != '"') {
-            return error_token("Unterminated string literal");
+        const char* const end = m_text_to_parse.data() + m_text_to_parse.size();
+        uint32_t code_point = 0;
+        const size_t length = utf8::decode(m_text_to_parse.data() + pos, end, code_point);
+        if (length == 0) {
+            return 0;
         }
 
-        std::string text = m_text_to_parse.substr(start, m_text_cursor - start);
-        // Skip the closing quote
-        next_char();
-
-        return make_token(TerminalTokenType::STRING, text);
+        return (is_start ? utf8::is_xid_start(code_point) : utf8::is_xid_continue(code_point)) ? static_cast<int64_t>(length) : 0;
     }
 
-    Token Tokenizer::newline()
+    bool Tokenizer::is_cursor_valid() const
     {
-        int substr_len = 1;
-        if (match_next('\r') || match_next('\n')) {
-            substr_len = 2;
-        }
-        return make_token(TerminalTokenType::NEWLINE, m_text_to_parse.substr(m_text_cursor, substr_len));
+        return is_cursor_in_text();
     }
 
-    Token Tokenizer::comment()
+    bool Tokenizer::is_streaming() const
+    {
+        return false;
+    }
+
+    bool Tokenizer::is_cursor_in_text() const
+    {
+        return m_text_cursor < static_cast<int64_t>(m_text_to_parse.size()) && m_text_cursor >= 0;
+    }
+
+    TerminalTokenType Tokenizer::get_pervious_token_type() const
+    {
+        return m_previous_token_type;
+    }
+
+    TokenizerState Tokenizer::save_state() const
+    {
+        return { m_text_cursor + original_text_offset(), m_previous_token_type };
+    }
+
+    bool Tokenizer::restore_state(const TokenizerState& state)
+    {
+        // Streaming tokenizers move their window, positions are relative to it
+        const int64_t cursor = state.pos - original_text_offset();
+        if (cursor < 0 || cursor > static_cast<int64_t>(m_text_to_parse.size())) {
+            return false;
+        }
+
+        m_text_cursor = cursor;
+        m_previous_token_type = state.previous_token_type;
+        return true;
+    }
+
+    const CommentTable& Tokenizer::comments() const
+    {
+        return m_comments;
+    }
+
+    const TokenBuffer& Tokenizer::document_tokens()
     {
+        if (!m_has_document) {
+            m_text_cursor = 0;
+            m_previous_token_type = TerminalTokenType::NONE;
+            m_document = tokenize_all();
+            m_has_document = true;
+
+            m_text_cursor = 0;
+            m_previous_token_type = TerminalTokenType::NONE;
+        }
+        return m_document;
+    }
+
+    TokenEdit Tokenizer::apply_edit(int64_t offset, int64_t removed_length, std::string_view inserted_text)
+    {
+        const int64_t old_text_size = static_cast<int64_t>(m_text_to_parse.size());
+        if (offset < 0 || removed_length < 0 || offset > old_text_size || removed_length > old_text_size - offset) {
+            return {};
+        }
+
+        const TokenBuffer& old_tokens = document_tokens();
+        const size_t old_count = old_tokens.size();
+        const int64_t delta = static_cast<int64_t>(inserted_text.size()) - removed_length;
+        if (old_text_size + delta > std::numeric_limits<uint32_t>::max()) {
+            return {};
+        }
+
+        // First token touching the edit, a token ending right at `offset` may be extended by the inserted text
+        size_t first = 0;
+        for (size_t count = old_count; count > 0;) {
+            const size_t half = count / 2;
+            if (static_cast<int64_t>(old_tokens.offset_at(first + half)) + old_tokens.length_at(first + half) < offset) {
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        // One token further back, lexing a token looks up to 2 chars past its end (`1.5`, `..=`)
+        first -= first > 0 ? 1 : 0;
+        first = std::min(first, old_count > 0 ? old_count - 1 : 0);
+
+        // Before the first token, the edit may be inside a leading comment, start from the beginning.
+        // Otherwise start on the token's first char, the quote of a string or the `//` of a comment.
+        const int64_t restart = first > 0 ? token_start(old_tokens.type_at(first), old_tokens.offset_at(first)) : 0;
+        const TerminalTokenType restart_previous = first > 0 ? old_tokens.type_at(first - 1) : TerminalTokenType::NONE;
+
+        // Text of a mapped file is copied on the first edit
+        if (m_owned_text.data() != m_text_to_parse.data() || m_owned_text.size() != m_text_to_parse.size()) {
+            m_owned_text.assign(m_text_to_parse);
+        }
+        m_owned_text.replace(static_cast<size_t>(offset), static_cast<size_t>(removed_length), inserted_text);
+        m_text_to_parse = m_owned_text;
+        validate_utf8_after_edit(offset, offset + static_cast<int64_t>(inserted_text.size()));
+
+        // Comments are recorded aside, spliced in once the relexed range is known
+        CommentTable old_comments = std::move(m_comments);
+        m_comments = CommentTable();
+
+        m_text_cursor = restart;
+        m_previous_token_type = restart_previous;
+
+        // Past the edit, a token lexed from the same state as an old one at the shifted position starts the same tail
+        const int64_t new_edit_end = offset + static_cast<int64_t>(inserted_text.size());
+        TokenBuffer relexed(m_text_to_parse);
+        size_t converged = old_count;
+        size_t old_index = first;
+        while (true) {
+            const TerminalTokenType previous = m_previous_token_type;
+            const Token token = next_token();
+
+            if (token.pos >= new_edit_end && old_count > 0) {
+                const int64_t old_pos = token.pos - delta;
+                while (old_index < old_count && static_cast<int64_t>(old_tokens.offset_at(old_index)) < old_pos) {
+                    ++old_index;
+                }
+                if (old_index < old_count
+                    && static_cast<int64_t>(old_tokens.offset_at(old_index)) == old_pos
+                    && old_tokens.type_at(old_index) == token.type
+                    && old_tokens.length_at(old_index) == token.value.size()
+                    && (old_index > 0 ? old_tokens.type_at(old_index - 1) : TerminalTokenType::NONE) == previous) {
+                    converged = old_index;
+                    break;
+                }
+            }
+
+            relexed.push_back(token);
+            if (token.type == TerminalTokenType::END || token.type == TerminalTokenType::ERROR) {
+                break;
+            }
+        }
+
+        const int64_t old_converged_pos = converged < old_count ? old_tokens.offset_at(converged) : std::numeric_limits<int64_t>::max();
+        old_comments.splice(restart, old_converged_pos, std::move(m_comments), delta);
+        m_comments = std::move(old_comments);
+
+        TokenEdit edit;
+        edit.is_applied = true;
+        edit.first = first;
+        edit.removed_count = converged - first;
+        edit.inserted_count = relexed.size();
+        edit.delta = delta;
+        m_document.splice(first, converged - first, std::move(relexed), delta);
+
+        m_text_cursor = 0;
+        m_previous_token_type = TerminalTokenType::NONE;
+        return edit;
+    }
+
+    char Tokenizer::current_char() const
+    {
+        return is_cursor_in_text() ? m_text_to_parse[m_text_cursor] : EOF;
+    }
+
+    char Tokenizer::next_char()
+    {
+        ++m_text_cursor;
+
+        if (is_cursor_in_text()) {
+            return m_text_to_parse[m_text_cursor];
+        }
+
+        return EOF;
+    }
+
+    char Tokenizer::peek_char(int64_t offset) const
+    {
+        const int64_t pos = m_text_cursor + offset;
+        if (pos >= 0 && pos < static_cast<int64_t>(m_text_to_parse.size())) {
+            return m_text_to_parse[pos];
+        }
+
+        return EOF;
+    }
+
+    void Tokenizer::consume_whitespace()
+    {
+        consume_while(char_class::SPACE);
+    }
+
+    bool Tokenizer::consume_trivia(bool text_may_be_cut)
+    {
+        consume_whitespace();
+        if (m_options.comments == CommentMode::EMIT) {
+            return true;
+        }
+
+        while (current_char() == '/' && peek_char(1) == '/') {
+            const int64_t start = m_text_cursor + 2;
+            const int64_t end = find_comment_end(start);
+            if (text_may_be_cut && end == static_cast<int64_t>(m_text_to_parse.size())) {
+                return false;
+            }
+            m_text_cursor = end;
+            if (m_options.comments == CommentMode::RECORD) {
+                m_comments.push_back({ start + original_text_offset(), m_text_cursor - start });
+            }
+            consume_whitespace();
+        }
+        return true;
+    }
+
+    void Tokenizer::consume_while(uint8_t char_class_mask)
+    {
+        if (!is_cursor_in_text()) {
+            return;
+        }
+
+        const char* const begin = m_text_to_parse.data();
+        const char* const end = begin + m_text_to_parse.size();
+
+        m_text_cursor = simd::skip_char_class(begin + m_text_cursor, end, char_class_mask) - begin;
+    }
+
+    bool Tokenizer::match_next(char expected)
+    {
+        if (is_cursor_in_text() && m_text_cursor + 1 < static_cast<int64_t>(m_text_to_parse.size()) && m_text_to_parse[m_text_cursor + 1] == expected) {
+            m_text_cursor++;
+            return true;
+        }
+        return false;
+    }
+
+    bool Tokenizer::match_next(std::string_view expected)
+    {
+        if (m_text_cursor + expected.size() >= m_text_to_parse.size()) {
+            return false;
+        }
+
         size_t start = m_text_cursor;
+        for (int i = 0; i < expected.size(); ++i) {
+            if (expected[i] != m_text_to_parse[start + i]) {
+                return false;
+            }
+        }
+
+        m_text_cursor += expected.size();
+        return true;
+    }
+
+    Token Tokenizer::error_token(std::string_view message)
+    {
+        return { TerminalTokenType::ERROR, {}, message, m_text_cursor };
+    }
+
+    Token Tokenizer::make_token(TerminalTokenType type, int64_t start, int64_t end)
+    {
+        const std::string_view text = original_text();
+        start = std::clamp<int64_t>(start, 0, text.size());
+        end = std::clamp<int64_t>(end, start, text.size());
+        return { type, {}, text.substr(start, end - start), start };
+    }
+
+    Token Tokenizer::make_token(TerminalTokenType type, std::string_view spelling)
+    {
+        return make_token(type, m_text_cursor + 1 - static_cast<int64_t>(spelling.size()), m_text_cursor + 1);
+    }
+
+    int64_t Tokenizer::find_string_end(int64_t start, bool& out_has_escapes) const
+    {
+        const char* const begin = m_text_to_parse.data();
+        const char* const end = begin + m_text_to_parse.size();
+        const char* p = begin + std::min<int64_t>(start, m_text_to_parse.size());
+
+        // Jump between quotes and escapes, an escape always eats the next char
+        out_has_escapes = false;
+        while ((p = simd::find_quote_or_escape(p, end)) < end && *p == '\\') {
+            out_has_escapes = true;
+            p = std::min(p + 2, end);
+        }
+
+        return p - begin;
+    }
+
+    void Tokenizer::lex_chunk(int64_t chunk_end, TokenBuffer& out)
+    {
+        while (true) {
+            const int64_t token_end = m_text_cursor;
+            // A skipped comment is checked against the chunk end too, the token after it may belong to the next chunk
+            consume_trivia();
+            if (m_text_cursor >= chunk_end) {
+                // Belongs to the next chunk, which skips the whitespace again
+                m_text_cursor = token_end;
+                break;
+            }
 
-        std::string val;
-        val.reserve(64);
+            Token token = next_token();
+            out.push_back(token);
+            if (token.type == TerminalTokenType::END || token.type == TerminalTokenType::ERROR) {
+                break;
+            }
+        }
+    }
 
-        while (is_cursor_valid() && current_char() != '\n' && current_char() != '\r') {
-            char c = next_char();
-            if (c != '\r' && c != '\n') {
-                val += c;
+    Token Tokenizer::identifier_or_keyword()
+    {
+        int64_t start = m_text_cursor;
+
+        // ASCII runs are vectorized, non-ASCII code points are classified one at a time
+        while (true) {
+            consume_while(char_class::IDENT_CONTINUE);
+            const int64_t length = unicode_ident_length(m_text_cursor, false);
+            if (length == 0) {
+                break;
             }
+            m_text_cursor += length;
         }
 
-        // std::string text = m_text_to_parse.substr(start, m_text_cursor - start);
+        Token token = make_token(TerminalTokenType::IDENT, start, m_text_cursor);
+        token.type = lookup_keyword(token.value);
+        if (token.type == TerminalTokenType::IDENT) {
+            token.symbol = intern(token.value);
+        }
 
-        return make_token(TerminalTokenType::COMMENTVAL, val);
+        return token;
     }
 
-    const char *token_type_to_string(TerminalTokenType type)
+    namespace
+    {
+        constexpr int digit_value(char c)
+        {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return 99;
+        }
+
+        struct SuffixSpec {
+            std::string_view spelling;
+            NumberSuffix suffix;
+            // Largest integer of the type, signed types accept the magnitude of their minimum
+            uint64_t max_integer;
+        };
+
+        constexpr SuffixSpec suffix_specs[] = {
+            { "i8", NumberSuffix::I8, uint64_t(1) << 7 },
+            { "i16", NumberSuffix::I16, uint64_t(1) << 15 },
+            { "i32", NumberSuffix::I32, uint64_t(1) << 31 },
+            { "i64", NumberSuffix::I64, uint64_t(1) << 63 },
+            { "isize", NumberSuffix::ISIZE, uint64_t(1) << 63 },
+            { "u8", NumberSuffix::U8, UINT8_MAX },
+            { "u16", NumberSuffix::U16, UINT16_MAX },
+            { "u32", NumberSuffix::U32, UINT32_MAX },
+            { "u64", NumberSuffix::U64, UINT64_MAX },
+            { "usize", NumberSuffix::USIZE, UINT64_MAX },
+            { "f32", NumberSuffix::F32, 0 },
+            { "f64", NumberSuffix::F64, 0 },
+        };
+
+        const SuffixSpec* find_suffix(std::string_view spelling)
+        {
+            for (const SuffixSpec& spec : suffix_specs) {
+                if (spec.spelling == spelling) {
+                    return &spec;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Copy `digits` without `_` separators to `out`, which holds at least `digits.size()` chars
+         */
+        size_t strip_separators(std::string_view digits, char* out)
+        {
+            size_t size = 0;
+            for (char c : digits) {
+                if (c != '_') {
+                    out[size++] = c;
+                }
+            }
+            return size;
+        }
+
+        /**
+         * @brief Decode the digits of a valid literal, `_` separators included
+         */
+        template <typename Fn>
+        auto with_stripped_digits(std::string_view digits, Fn&& fn)
+        {
+            // Literals are short, only absurdly long ones need the heap
+            char small[64];
+            if (digits.size() <= sizeof(small)) {
+                return fn(small, strip_separators(digits, small));
+            }
+            std::string large(digits.size(), '\0');
+            return fn(large.data(), strip_separators(digits, large.data()));
+        }
+
+        NumberLiteral decode_integer(std::string_view digits, uint32_t radix)
+        {
+            NumberLiteral literal;
+
+            // Fast path: up to 19 decimal digits can't overflow 64 bits
+            if (radix == 10 && digits.size() <= 19 && digits.find('_') == std::string_view::npos) {
+                uint64_t value = 0;
+                for (char c : digits) {
+                    value = value * 10 + static_cast<uint64_t>(c - '0');
+                }
+                literal.bits = value;
+                return literal;
+            }
+
+            with_stripped_digits(digits, [&](const char* begin, size_t size) {
+                const std::from_chars_result result = std::from_chars(begin, begin + size, literal.bits, radix);
+                literal.is_overflow = result.ec == std::errc::result_out_of_range;
+                return 0;
+            });
+            return literal;
+        }
+
+        /**
+         * @brief from_chars() leaves the value untouched when it is out of range, tell overflow from underflow
+         * by the decimal exponent of the first significant digit
+         */
+        bool is_float_overflow(std::string_view digits)
+        {
+            const size_t exponent_pos = digits.find_first_of("eE");
+            int64_t exponent = 0;
+            if (exponent_pos != std::string_view::npos) {
+                const char* begin = digits.data() + exponent_pos + 1;
+                const char* const end = digits.data() + digits.size();
+                const bool is_negative = begin < end && *begin == '-';
+                begin += begin < end && (*begin == '+' || *begin == '-');
+                if (std::from_chars(begin, end, exponent).ec == std::errc::result_out_of_range) {
+                    exponent = std::numeric_limits<int32_t>::max();
+                }
+                exponent = is_negative ? -exponent : exponent;
+            }
+
+            const std::string_view mantissa = digits.substr(0, exponent_pos);
+            const size_t first = mantissa.find_first_not_of("0.");
+            if (first == std::string_view::npos) {
+                return false;
+            }
+
+            const size_t dot = std::min(mantissa.find('.'), mantissa.size());
+            const int64_t magnitude = first < dot ? static_cast<int64_t>(dot - first) - 1 : -static_cast<int64_t>(first - dot);
+            return magnitude + exponent > 0;
+        }
+
+        NumberLiteral decode_float(std::string_view digits)
+        {
+            NumberLiteral literal;
+            with_stripped_digits(digits, [&](const char* begin, size_t size) {
+                double value = 0;
+                const std::from_chars_result result = std::from_chars(begin, begin + size, value);
+                if (result.ec == std::errc::result_out_of_range) {
+                    // Underflow is rounded to zero, only overflow is reported
+                    literal.is_overflow = is_float_overflow(std::string_view(begin, size));
+                    value = literal.is_overflow ? std::numeric_limits<double>::infinity() : 0.0;
+                }
+                literal.bits = std::bit_cast<uint64_t>(value);
+                return 0;
+            });
+            return literal;
+        }
+    }
+
+    Token Tokenizer::number_literal()
+    {
+        const int64_t start = m_text_cursor;
+        const char* const text = m_text_to_parse.data();
+        const int64_t text_size = static_cast<int64_t>(m_text_to_parse.size());
+
+        uint32_t radix = 10;
+        if (current_char() == '0') {
+            switch (peek_char(1)) {
+                case 'x': radix = 16; break;
+                case 'o': radix = 8; break;
+                case 'b': radix = 2; break;
+                default: break;
+            }
+        }
+
+        const int64_t digits_start = radix == 10 ? start : start + 2;
+        int64_t cursor = digits_start;
+        bool is_float = false;
+        bool has_invalid_digit = false;
+
+        // Binary and octal literals take every decimal digit, a wrong one is reported rather than starting a new token
+        auto consume_digits = [&](uint32_t digit_radix) {
+            const int64_t digits_begin = cursor;
+            while (cursor < text_size && (digit_value(text[cursor]) < static_cast<int>(digit_radix) || text[cursor] == '_')) {
+                ++cursor;
+            }
+            return cursor > digits_begin;
+        };
+
+        bool has_digits = consume_digits(radix == 16 ? 16 : 10);
+        if (radix != 10) {
+            has_digits = false;
+            for (int64_t i = digits_start; i < cursor; ++i) {
+                has_digits |= text[i] != '_';
+                has_invalid_digit |= text[i] != '_' && digit_value(text[i]) >= static_cast<int>(radix);
+            }
+        } else {
+            // `1..2` is a range and `1.foo` a member access, a fraction needs a digit after the dot
+            if (cursor + 1 < text_size && text[cursor] == '.' && is_digit(text[cursor + 1])) {
+                ++cursor;
+                consume_digits(10);
+                is_float = true;
+            }
+
+            // An exponent needs digits too, `1else` isn't a float
+            if (cursor < text_size && (text[cursor] == 'e' || text[cursor] == 'E')) {
+                const int64_t sign = cursor + 1 < text_size && (text[cursor + 1] == '+' || text[cursor + 1] == '-') ? 1 : 0;
+                if (cursor + 1 + sign < text_size && is_digit(text[cursor + 1 + sign])) {
+                    cursor += 1 + sign;
+                    consume_digits(10);
+                    is_float = true;
+                }
+            }
+        }
+
+        const int64_t digits_end = cursor;
+        const std::string_view digits(text + digits_start, digits_end - digits_start);
+
+        // The suffix is the identifier glued to the digits
+        m_text_cursor = cursor;
+        consume_while(char_class::IDENT_CONTINUE);
+        const std::string_view suffix_spelling(text + digits_end, m_text_cursor - digits_end);
+
+        auto literal_error = [&](std::string_view message) {
+            Token error = error_token(message);
+            error.pos = start;
+            return error;
+        };
+
+        if (!has_digits) {
+            return literal_error("Missing digits in a number literal");
+        }
+        if (has_invalid_digit) {
+            return literal_error(radix == 2 ? "Invalid digit in a binary literal" : "Invalid digit in an octal literal");
+        }
+
+        const SuffixSpec* suffix = nullptr;
+        if (!suffix_spelling.empty()) {
+            suffix = find_suffix(suffix_spelling);
+            if (suffix == nullptr) {
+                return literal_error("Invalid suffix for a number literal");
+            }
+
+            const bool is_float_suffix = suffix->suffix == NumberSuffix::F32 || suffix->suffix == NumberSuffix::F64;
+            if (is_float && !is_float_suffix) {
+                return literal_error("Integer suffix on a float literal");
+            }
+            if (is_float_suffix && radix != 10) {
+                return literal_error("Float suffix on a non-decimal literal");
+            }
+            is_float = is_float_suffix;
+        }
+
+        Token token = make_token(is_float ? TerminalTokenType::FLOAT : TerminalTokenType::INT, start, m_text_cursor);
+        token.number = is_float ? decode_float(digits) : decode_integer(digits, radix);
+        if (suffix != nullptr) {
+            token.number.suffix = suffix->suffix;
+            if (!is_float && token.number.bits > suffix->max_integer) {
+                token.number.is_overflow = true;
+            }
+        }
+
+        return token;
+    }
+
+    Token Tokenizer::string_literal()
+    {
+        // Skip the opening quote
+        int64_t start = ++m_text_cursor;
+
+        bool has_escapes = false;
+        m_text_cursor = find_string_end(start, has_escapes);
+
+        if (!is_cursor_in_text() || current_char() != '"') {
+            return error_token("Unterminated string literal");
+        }
+
+        // Stay on the closing quote, next_token() will eat it
+        Token token = make_token(TerminalTokenType::STRING, start, m_text_cursor);
+        // Escapes are only flagged here, decode_string_literal() decodes them for the tokens which need it
+        token.has_escapes = has_escapes;
+        return token;
+    }
+
+    namespace
+    {
+        /**
+         * @brief Decode the escapes of a literal's content to `out`, which holds at least `text.size()` chars.
+         * No escape is longer than what it decodes to, `\u{10FFFF}` takes 10 chars for 4 bytes.
+         * @return The decoded size, or -1 on an invalid escape sequence
+         */
+        int64_t decode_escapes(std::string_view text, char* out)
+        {
+            size_t size = 0;
+            for (size_t i = 0; i < text.size(); ++i) {
+                if (text[i] != '\\') {
+                    out[size++] = text[i];
+                    continue;
+                }
+                if (++i == text.size()) {
+                    return -1;
+                }
+
+                switch (text[i]) {
+                    case 'n': out[size++] = '\n'; break;
+                    case 'r': out[size++] = '\r'; break;
+                    case 't': out[size++] = '\t'; break;
+                    case '0': out[size++] = '\0'; break;
+                    case '\\': out[size++] = '\\'; break;
+                    case '"': out[size++] = '"'; break;
+                    case '\'': out[size++] = '\''; break;
+                    case 'x': {
+                        // `\xHH` is limited to ASCII, larger values need `\u{...}`
+                        if (i + 2 >= text.size() || digit_value(text[i + 1]) >= 8 || digit_value(text[i + 2]) >= 16) {
+                            return -1;
+                        }
+                        out[size++] = static_cast<char>(digit_value(text[i + 1]) * 16 + digit_value(text[i + 2]));
+                        i += 2;
+                        break;
+                    }
+                    case 'u': {
+                        // `\u{...}` takes 1 to 6 hex digits of a scalar value
+                        if (i + 1 >= text.size() || text[i + 1] != '{') {
+                            return -1;
+                        }
+                        uint32_t code_point = 0;
+                        size_t digits = 0;
+                        for (i += 2; i < text.size() && text[i] != '}'; ++i, ++digits) {
+                            if (digits == 6 || digit_value(text[i]) >= 16) {
+                                return -1;
+                            }
+                            code_point = code_point * 16 + static_cast<uint32_t>(digit_value(text[i]));
+                        }
+                        if (i == text.size() || digits == 0 || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+                            return -1;
+                        }
+                        size += utf8::encode(code_point, out + size);
+                        break;
+                    }
+                    default:
+                        return -1;
+                }
+            }
+            return static_cast<int64_t>(size);
+        }
+    }
+
+    bool decode_string_literal(const Token& token, std::string_view& out_text)
+    {
+        if (!token.has_escapes) {
+            out_text = token.value;
+            return true;
+        }
+
+        // Literals are short, only long ones need the heap
+        char small[256];
+        std::string large;
+        char* buffer = small;
+        if (token.value.size() > sizeof(small)) {
+            large.resize(token.value.size());
+            buffer = large.data();
+        }
+
+        const int64_t size = decode_escapes(token.value, buffer);
+        if (size < 0) {
+            return false;
+        }
+        out_text = SymbolTable::literals().intern_text(std::string_view(buffer, static_cast<size_t>(size)));
+        return true;
+    }
+
+    int64_t decode_string_literal(const Token& token, char* out)
     {
-        switch (type) {
-            case TerminalTokenType::NONE: return "NONE";
-            case TerminalTokenType::LET: return "LET";
-            case TerminalTokenType::CONST: return "CONST";
-            case TerminalTokenType::MUT: return "MUT";
-            case TerminalTokenType::FN: return "FN";
-            case TerminalTokenType::STRUCT: return "STRUCT";
-            case TerminalTokenType::TRAIT: return "TRAIT";
-            case TerminalTokenType::IMPL: return "IMPL";
-            case TerminalTokenType::FOR: return "FOR";
-            case TerminalTokenType::TYPE: return "TYPE";
-            case TerminalTokenType::IF: return "IF";
-            case TerminalTokenType::ELSE: return "ELSE";
-            case TerminalTokenType::LOOP: return "LOOP";
-            case TerminalTokenType::WHILE: return "WHILE";
-            case TerminalTokenType::BREAK: return "BREAK";
-            case TerminalTokenType::CONTINUE: return "CONTINUE";
-            case TerminalTokenType::IN: return "IN";
-            case TerminalTokenType::ENUM: return "ENUM";
-            case TerminalTokenType::RANGE: return "RANGE";
-            case TerminalTokenType::RANGEEQ: return "RANGEEQ";
-            case TerminalTokenType::IDENT: return "IDENT";
-            case TerminalTokenType::EQ: return "EQ";
-            case TerminalTokenType::LPAREN: return "LPAREN";
-            case TerminalTokenType::RPAREN: return "RPAREN";
-            case TerminalTokenType::LBRACE: return "LBRACE";
-            case TerminalTokenType::RBRACE: return "RBRACE";
-            case TerminalTokenType::SEMICOLON: return "SEMICOLON";
-            case TerminalTokenType::COLON: return "COLON";
-            case TerminalTokenType::COLONCOLON: return "COLONCOLON";
-            case TerminalTokenType::ARROW: return "ARROW";
-            case TerminalTokenType::COMMA: return "COMMA";
-            case TerminalTokenType::HASH: return "HASH";
-            case TerminalTokenType::DOT: return "DOT";
-            case TerminalTokenType::SQ: return "SQ";
-            case TerminalTokenType::DQ: return "DQ";
-            case TerminalTokenType::LBRACKET: return "LBRACKET";
-            case TerminalTokenType::RBRACKET: return "RBRACKET";
-            case TerminalTokenType::END: return "END";
-            case TerminalTokenType::OR: return "OR";
-            case TerminalTokenType::AND: return "AND";
-            case TerminalTokenType::NOT: return "NOT";
-            case TerminalTokenType::EQEQ: return "EQEQ";
-            case TerminalTokenType::NEQ: return "NEQ";
-            case TerminalTokenType::LT: return "LT";
-            case TerminalTokenType::LTE: return "LTE";
-            case TerminalTokenType::GT: return "GT";
-            case TerminalTokenType::GTE: return "GTE";
-            case TerminalTokenType::PLUS: return "PLUS";
-            case TerminalTokenType::PLUSPLUS: return "PLUSPLUS";
-            case TerminalTokenType::MINUS: return "MINUS";
-            case TerminalTokenType::MINUSMINUS: return "MINUSMINUS";
-            case TerminalTokenType::STAR: return "STAR";
-            case TerminalTokenType::STARSTAR: return "STARSTAR";
-            case TerminalTokenType::SLASH: return "SLASH";
-            case TerminalTokenType::COMMENT: return "COMMENT";
-            case TerminalTokenType::BITOR: return "BITOR";
-            case TerminalTokenType::BITXOR: return "BITXOR";
-            case TerminalTokenType::BITAND: return "BITAND";
-            case TerminalTokenType::BITINV: return "BITINV";
-            case TerminalTokenType::INT: return "INT";
-            case TerminalTokenType::FLOAT: return "FLOAT";
-            case TerminalTokenType::STRING: return "STRING";
-            case TerminalTokenType::NEWLINE: return "NEWLINE";
-            case TerminalTokenType::COMMENTVAL: return "COMMENTVAL";
-            case TerminalTokenType::SELF: return "SELF";
-            case TerminalTokenType::ATTRIBUTE_START: return "ATTRIBUTE_START";
-            case TerminalTokenType::GLOBAL_ATTRIBUTE_START: return "GLOBAL_ATTRIBUTE_START";
-            case TerminalTokenType::ASYNC: return "ASYNC";
-            case TerminalTokenType::AWAIT: return "AWAIT";
-            case TerminalTokenType::PUB: return "PUB";
-            case TerminalTokenType::CRATE: return "CRATE";
-            case TerminalTokenType::SUPER: return "SUPER";
-            case TerminalTokenType::MOD: return "MOD";
-            case TerminalTokenType::AS: return "AS";
-            case TerminalTokenType::STATIC: return "STATIC";
-            case TerminalTokenType::REF: return "REF";
-            case TerminalTokenType::TRUE: return "TURE";
-            case TerminalTokenType::FALSE: return "FALSE";
-            case TerminalTokenType::PLUS_EQUAL: return "PLUS_EQUAL";
-            case TerminalTokenType::MINUS_EQUAL: return "MINUS_EQUAL";
-            case TerminalTokenType::STAR_EQUAL: return "STAR_EQUAL";
-            case TerminalTokenType::SLASH_EQUAL: return "SLASH_EQUAL";
-            case TerminalTokenType::PRECENTAGE_EQUAL: return "PRECENTAGE_EQUAL";
-            case TerminalTokenType::AND_EQUAL: return "AND_EQUAL";
-            case TerminalTokenType::OR_EQUAL: return "OR_EQUAL";
-            case TerminalTokenType::XOR_EQUAL: return "XOR_EQUAL";
-            case TerminalTokenType::PRECENTAGE: return "PRECENTAGE";
-            case TerminalTokenType::RETURN: return "RETURN";
-            case TerminalTokenType::ERROR: return "ERROR";
-            case TerminalTokenType::MAX_NUM: return "MAX_NUM";
-            default: return "UNKNOWN";
+        if (!token.has_escapes) {
+            std::copy(token.value.begin(), token.value.end(), out);
+            return static_cast<int64_t>(token.value.size());
         }
+        return decode_escapes(token.value, out);
+    }
+
+    Token Tokenizer::newline()
+    {
+        int64_t start = m_text_cursor;
+        if (current_char() == '\r') {
+            match_next('\n');
+        }
+        return make_token(TerminalTokenType::NEWLINE, start, m_text_cursor + 1);
+    }
+
+    Token Tokenizer::comment()
+    {
+        // Cursor is on the second '/'
+        int64_t start = m_text_cursor + 1;
+        m_text_cursor = find_comment_end(start);
+
+        return make_token(TerminalTokenType::COMMENTVAL, start, m_text_cursor);
+    }
+
+    int64_t Tokenizer::find_comment_end(int64_t start) const
+    {
+        const char* const begin = m_text_to_parse.data();
+        const char* const end = begin + m_text_to_parse.size();
+        return simd::find_line_break(begin + std::min<int64_t>(start, m_text_to_parse.size()), end) - begin;
+    }
+
+    const char* number_suffix_to_string(NumberSuffix suffix)
+    {
+        if (suffix == NumberSuffix::NONE) {
+            return "";
+        }
+        for (const SuffixSpec& spec : suffix_specs) {
+            if (spec.suffix == suffix) {
+                return spec.spelling.data();
+            }
+        }
+        return "";
+    }
+
+    const char *token_type_to_string(TerminalTokenType type)
+    {
+        return static_cast<size_t>(type) < token_type_infos.size() ? token_type_infos[static_cast<size_t>(type)].name : "UNKNOWN";
+    }
+
+    TerminalTokenType lookup_keyword(std::string_view text)
+    {
+        return keyword_perfect_hash.lookup(text);
     }
 
     const bool is_assignment_token(const TerminalTokenType token_type) {
-        return token_type == TerminalTokenType::EQ
-            || token_type == TerminalTokenType::PLUS_EQUAL
-            || token_type == TerminalTokenType::MINUS_EQUAL
-            || token_type == TerminalTokenType::STAR_EQUAL
-            || token_type == TerminalTokenType::SLASH_EQUAL
-            || token_type == TerminalTokenType::PRECENTAGE_EQUAL
-            || token_type == TerminalTokenType::AND_EQUAL
-            || token_type == TerminalTokenType::OR_EQUAL
-            || token_type == TerminalTokenType::XOR_EQUAL;
+        return static_cast<size_t>(token_type) < token_type_infos.size()
+            && (token_type_infos[static_cast<size_t>(token_type)].flags & token_flags::ASSIGNMENT) != 0;
     }
 
     const bool is_unary_token(const TerminalTokenType token_type) {
-        return token_type == TerminalTokenType::MINUS
-            || token_type == TerminalTokenType::NOT
-            || token_type == TerminalTokenType::PLUSPLUS
-            || token_type == TerminalTokenType::MINUSMINUS
-            || token_type == TerminalTokenType::BITINV
-        ;
+        return static_cast<size_t>(token_type) < token_type_infos.size()
+            && (token_type_infos[static_cast<size_t>(token_type)].flags & token_flags::UNARY) != 0;
+    }
+
+    TokenStream ITokenizer::create(std::string_view in_text, const TokenizerOptions& options)
+    {
+        return new Tokenizer(in_text, options);
     }
 
-    TokenStream ITokenizer::create(std::string_view in_text)
+    TokenStream ITokenizer::create_from_reader(ReadCallback read, size_t window_size, const TokenizerOptions& options)
     {
-        return new Tokenizer(in_text);
+        return new StreamTokenizer(std::move(read), window_size, options);
+    }
+
+    TokenStream ITokenizer::create_from_fd(int fd, size_t window_size, const TokenizerOptions& options)
+    {
+        return create_from_reader([fd](char* buffer, size_t capacity) -> size_t {
+            while (true) {
+#if defined(_WIN32)
+                const int read_size = _read(fd, buffer, static_cast<unsigned>(std::min<size_t>(capacity, INT_MAX)));
+#else
+                const ssize_t read_size = ::read(fd, buffer, capacity);
+                if (read_size < 0 && errno == EINTR) {
+                    continue;
+                }
+#endif
+                return read_size > 0 ? static_cast<size_t>(read_size) : 0;
+            }
+        }, window_size, options);
+    }
+
+    TokenStream ITokenizer::create_from_file(const char* path, const TokenizerOptions& options)
+    {
+        MappedFile file = MappedFile::open(path);
+        if (!file.is_open()) {
+            return nullptr;
+        }
+
+        return new FileTokenizer(std::move(file), options);
     }
 
     TokenStream::TokenStream(ITokenizer *data_src)
@@ -594,6 +1508,9 @@ token_exit:
 
     TokenStream &TokenStream::operator=(ITokenizer *data_src) noexcept
     {
+        if (m_data_src != data_src) {
+            delete m_data_src;
+        }
         m_data_src = data_src;
         return *this;
     }
@@ -607,6 +1524,7 @@ token_exit:
     TokenStream &TokenStream::operator=(TokenStream &&other) noexcept
     {
         if (this != &other) {
+            delete m_data_src;
             m_data_src = other.m_data_src;
             other.m_data_src = nullptr;
         }
@@ -619,30 +1537,311 @@ token_exit:
         return m_data_src;
     }
 
-    const char* Token::get_value() const
+    bool TokenStream::is_null() const
+    {
+        return m_data_src == nullptr;
+    }
+
+    TokenStream::operator bool() const
+    {
+        return !is_null();
+    }
+
+    std::string_view Token::get_value() const
     {
         return value;
     }
 
-    SourceLoc pos_to_line_and_row(std::string_view full_text, int64_t pos) {
-        SourceLoc loc;
-        if (pos >= 0 && pos <= static_cast<int64_t>(full_text.size())) {
-            int64_t current_line = 0;
-            int64_t current_row = 0;
-
-            for (int64_t i = 0; i <= pos; ++i) {
-                if (full_text[i] == '\n') {
-                    ++current_line;
-                    current_row = 0;
-                } else {
-                    ++current_row;
+    simple_string Token::get_value_string() const
+    {
+        return simple_string(value);
+    }
+
+    static_assert(static_cast<uint32_t>(TerminalTokenType::MAX_NUM) <= std::numeric_limits<uint8_t>::max(),
+        "TokenBuffer stores token types in a byte");
+
+    TokenBuffer::TokenBuffer(std::string_view source)
+        : m_source(source)
+    { }
+
+    std::string_view TokenBuffer::source() const
+    {
+        return m_source;
+    }
+
+    size_t TokenBuffer::size() const
+    {
+        return m_types.size();
+    }
+
+    bool TokenBuffer::empty() const
+    {
+        return m_types.empty();
+    }
+
+    void TokenBuffer::reserve(size_t new_cap)
+    {
+        m_types.reserve(new_cap);
+        m_offsets.reserve(new_cap);
+        m_lengths.reserve(new_cap);
+        m_payloads.reserve(new_cap);
+    }
+
+    TerminalTokenType TokenBuffer::type_at(size_t index) const
+    {
+        return static_cast<TerminalTokenType>(m_types[index]);
+    }
+
+    uint32_t TokenBuffer::offset_at(size_t index) const
+    {
+        return m_offsets[index];
+    }
+
+    uint32_t TokenBuffer::length_at(size_t index) const
+    {
+        return m_lengths[index];
+    }
+
+    Symbol TokenBuffer::symbol_at(size_t index) const
+    {
+        return { type_at(index) == TerminalTokenType::IDENT ? m_payloads[index] : 0 };
+    }
+
+    NumberLiteral TokenBuffer::number_at(size_t index) const
+    {
+        const TerminalTokenType type = type_at(index);
+        if (type != TerminalTokenType::INT && type != TerminalTokenType::FLOAT) {
+            return {};
+        }
+        return m_numbers[m_payloads[index]];
+    }
+
+    Token TokenBuffer::token_at(size_t index) const
+    {
+        const TerminalTokenType type = type_at(index);
+
+        if (type == TerminalTokenType::ERROR) {
+            for (size_t i = 0; i < m_error_indices.size(); ++i) {
+                if (m_error_indices[i] == index) {
+                    return { type, {}, m_error_messages[i], m_offsets[index] };
+                }
+            }
+        }
+
+        return { type, symbol_at(index), m_source.substr(m_offsets[index], m_lengths[index]), m_offsets[index], number_at(index),
+            type == TerminalTokenType::STRING && m_payloads[index] != 0 };
+    }
+
+    void TokenBuffer::push_back(const Token& token)
+    {
+        if (token.type == TerminalTokenType::ERROR) {
+            m_error_indices.push_back(static_cast<uint32_t>(m_types.size()));
+            m_error_messages.push_back(token.value);
+            m_types.push_back(static_cast<uint8_t>(token.type));
+            m_offsets.push_back(static_cast<uint32_t>(std::min<int64_t>(token.pos, m_source.size())));
+            m_lengths.push_back(0);
+            m_payloads.push_back(0);
+            return;
+        }
+
+        m_types.push_back(static_cast<uint8_t>(token.type));
+        m_offsets.push_back(static_cast<uint32_t>(token.pos));
+        m_lengths.push_back(static_cast<uint32_t>(token.value.size()));
+        if (token.type == TerminalTokenType::INT || token.type == TerminalTokenType::FLOAT) {
+            m_payloads.push_back(static_cast<uint32_t>(m_numbers.size()));
+            m_numbers.push_back(token.number);
+        } else if (token.type == TerminalTokenType::STRING) {
+            m_payloads.push_back(token.has_escapes ? 1 : 0);
+        } else {
+            m_payloads.push_back(token.symbol.id);
+        }
+    }
+
+    void TokenBuffer::append(TokenBuffer&& other)
+    {
+        const uint32_t base = static_cast<uint32_t>(m_types.size());
+        for (size_t i = 0; i < other.m_error_indices.size(); ++i) {
+            m_error_indices.push_back(base + other.m_error_indices[i]);
+            m_error_messages.push_back(other.m_error_messages[i]);
+        }
+
+        // Literal indices of `other` start after ours
+        const uint32_t number_base = static_cast<uint32_t>(m_numbers.size());
+        if (number_base != 0) {
+            for (size_t i = 0; i < other.m_types.size(); ++i) {
+                const TerminalTokenType type = other.type_at(i);
+                if (type == TerminalTokenType::INT || type == TerminalTokenType::FLOAT) {
+                    other.m_payloads[i] += number_base;
                 }
             }
+        }
 
-            loc.line = current_line + 1;
-            loc.row = current_row + 1;
+        m_types.extend(std::move(other.m_types));
+        m_offsets.extend(std::move(other.m_offsets));
+        m_lengths.extend(std::move(other.m_lengths));
+        m_payloads.extend(std::move(other.m_payloads));
+        m_numbers.extend(std::move(other.m_numbers));
+    }
+
+    void TokenBuffer::splice(size_t first, size_t removed_count, TokenBuffer&& replacement, int64_t delta)
+    {
+        const size_t old_size = m_types.size();
+        const size_t tail = first + removed_count;
+        const size_t inserted_count = replacement.m_types.size();
+        const size_t new_size = old_size - removed_count + inserted_count;
+
+        // Removed literals stay in `m_numbers` until the next compaction, the inserted ones are appended
+        for (size_t i = first; i < tail; ++i) {
+            const TerminalTokenType type = type_at(i);
+            m_dead_numbers += type == TerminalTokenType::INT || type == TerminalTokenType::FLOAT;
         }
-        return loc;
+        const uint32_t number_base = static_cast<uint32_t>(m_numbers.size());
+        for (size_t i = 0; i < inserted_count; ++i) {
+            const TerminalTokenType type = replacement.type_at(i);
+            if (type == TerminalTokenType::INT || type == TerminalTokenType::FLOAT) {
+                replacement.m_payloads[i] += number_base;
+            }
+        }
+        m_numbers.extend(std::move(replacement.m_numbers));
+
+        vector<uint32_t> error_indices;
+        vector<std::string_view> error_messages;
+        for (size_t i = 0; i < m_error_indices.size(); ++i) {
+            if (m_error_indices[i] < first) {
+                error_indices.push_back(m_error_indices[i]);
+                error_messages.push_back(m_error_messages[i]);
+            }
+        }
+        for (size_t i = 0; i < replacement.m_error_indices.size(); ++i) {
+            error_indices.push_back(static_cast<uint32_t>(first + replacement.m_error_indices[i]));
+            error_messages.push_back(replacement.m_error_messages[i]);
+        }
+        for (size_t i = 0; i < m_error_indices.size(); ++i) {
+            if (m_error_indices[i] >= tail) {
+                error_indices.push_back(static_cast<uint32_t>(m_error_indices[i] - removed_count + inserted_count));
+                error_messages.push_back(m_error_messages[i]);
+            }
+        }
+        m_error_indices = std::move(error_indices);
+        m_error_messages = std::move(error_messages);
+
+        // The tail is moved in place, only its offsets are rewritten
+        auto splice_column = [&](auto& column, const auto& values) {
+            if (inserted_count > removed_count) {
+                column.resize(new_size);
+                std::move_backward(column.begin() + tail, column.begin() + old_size, column.begin() + new_size);
+            } else if (inserted_count < removed_count) {
+                if (new_size > 0) {
+                    std::move(column.begin() + tail, column.begin() + old_size, column.begin() + first + inserted_count);
+                }
+                column.resize(new_size);
+            }
+            for (size_t i = 0; i < inserted_count; ++i) {
+                column[first + i] = values[i];
+            }
+        };
+        splice_column(m_types, replacement.m_types);
+        splice_column(m_offsets, replacement.m_offsets);
+        splice_column(m_lengths, replacement.m_lengths);
+        splice_column(m_payloads, replacement.m_payloads);
+
+        if (delta != 0 && first + inserted_count < new_size) {
+            uint32_t* const offsets = m_offsets.begin();
+            for (size_t i = first + inserted_count; i < new_size; ++i) {
+                offsets[i] = static_cast<uint32_t>(offsets[i] + delta);
+            }
+        }
+        m_source = replacement.m_source;
+
+        if (m_dead_numbers * 2 > m_numbers.size()) {
+            vector<NumberLiteral> numbers;
+            for (size_t i = 0; i < new_size; ++i) {
+                const TerminalTokenType type = type_at(i);
+                if (type == TerminalTokenType::INT || type == TerminalTokenType::FLOAT) {
+                    numbers.push_back(m_numbers[m_payloads[i]]);
+                    m_payloads[i] = static_cast<uint32_t>(numbers.size() - 1);
+                }
+            }
+            m_numbers = std::move(numbers);
+            m_dead_numbers = 0;
+        }
+    }
+
+    size_t CommentTable::size() const
+    {
+        return m_spans.size();
+    }
+
+    bool CommentTable::empty() const
+    {
+        return m_spans.empty();
+    }
+
+    CommentSpan CommentTable::span_at(size_t index) const
+    {
+        return m_spans[index];
+    }
+
+    std::string_view CommentTable::text_at(size_t index, std::string_view source) const
+    {
+        return source.substr(m_spans[index].pos, m_spans[index].length);
+    }
+
+    size_t CommentTable::lower_bound(int64_t pos) const
+    {
+        return std::lower_bound(m_spans.begin(), m_spans.end(), pos, [](const CommentSpan& span, int64_t value) {
+            return span.pos < value;
+        }) - m_spans.begin();
+    }
+
+    size_t CommentTable::find(int64_t pos) const
+    {
+        const size_t index = lower_bound(pos);
+        return index < m_spans.size() && m_spans[index].pos == pos ? index : m_spans.size();
+    }
+
+    void CommentTable::push_back(const CommentSpan& span)
+    {
+        while (!m_spans.empty() && m_spans.back().pos >= span.pos) {
+            m_spans.pop_back();
+        }
+        m_spans.push_back(span);
+    }
+
+    void CommentTable::append(CommentTable&& other)
+    {
+        if (other.m_spans.empty()) {
+            return;
+        }
+        if (!m_spans.empty() && m_spans.back().pos >= other.m_spans.front().pos) {
+            for (const CommentSpan& span : other.m_spans) {
+                push_back(span);
+            }
+            return;
+        }
+        m_spans.extend(std::move(other.m_spans));
+    }
+
+    void CommentTable::splice(int64_t begin, int64_t end, CommentTable&& replacement, int64_t delta)
+    {
+        vector<CommentSpan> spans;
+        size_t index = 0;
+        for (; index < m_spans.size() && m_spans[index].pos < begin; ++index) {
+            spans.push_back(m_spans[index]);
+        }
+        for (const CommentSpan& span : replacement.m_spans) {
+            spans.push_back(span);
+        }
+        for (; index < m_spans.size(); ++index) {
+            if (m_spans[index].pos >= end) {
+                spans.push_back({ m_spans[index].pos + delta, m_spans[index].length });
+            }
+        }
+        m_spans = std::move(spans);
+    }
+
+    SourceLoc pos_to_line_and_row(std::string_view full_text, int64_t pos) {
+        return SourceMap(full_text).locate(pos);
     }
 }
 }
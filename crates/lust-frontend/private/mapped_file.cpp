@@ -0,0 +1,172 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#   include <string>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace lust
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_is_open = std::exchange(other.m_is_open, false);
+#if defined(_WIN32)
+            m_file_handle = std::exchange(other.m_file_handle, nullptr);
+            m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::is_open() const
+    {
+        return m_is_open;
+    }
+
+    std::string_view MappedFile::text() const
+    {
+        return { m_data, m_size };
+    }
+
+#if defined(_WIN32)
+
+    MappedFile MappedFile::open(const char* path)
+    {
+        MappedFile file;
+
+        const int wide_length = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+        if (wide_length <= 0) {
+            return file;
+        }
+        std::wstring wide_path(static_cast<size_t>(wide_length), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path, -1, wide_path.data(), wide_length);
+
+        HANDLE file_handle = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+            return file;
+        }
+        file.m_file_handle = file_handle;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_handle, &size)) {
+            file.close();
+            return file;
+        }
+
+        file.m_is_open = true;
+        if (size.QuadPart == 0) {
+            // Empty files can't be mapped
+            return file;
+        }
+
+        HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle == nullptr) {
+            file.close();
+            return file;
+        }
+        file.m_mapping_handle = mapping_handle;
+
+        const void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr) {
+            file.close();
+            return file;
+        }
+
+        file.m_data = static_cast<const char*>(data);
+        file.m_size = static_cast<size_t>(size.QuadPart);
+        return file;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping_handle != nullptr) {
+            CloseHandle(m_mapping_handle);
+        }
+        if (m_file_handle != nullptr) {
+            CloseHandle(m_file_handle);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_is_open = false;
+        m_file_handle = nullptr;
+        m_mapping_handle = nullptr;
+    }
+
+#else
+
+    MappedFile MappedFile::open(const char* path)
+    {
+        MappedFile file;
+
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return file;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            ::close(fd);
+            return file;
+        }
+
+        if (info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                return file;
+            }
+            // The tokenizer reads front to back, let the kernel read ahead aggressively
+            madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+            file.m_data = static_cast<const char*>(data);
+            file.m_size = static_cast<size_t>(info.st_size);
+        }
+
+        // The mapping stays valid after closing the descriptor
+        ::close(fd);
+        file.m_is_open = true;
+        return file;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data != nullptr) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_is_open = false;
+    }
+
+#endif
+}
@@ -1,72 +1,51 @@
 #include "public_pch.hpp"
-
-#include <cctype>
-#include <string>
+#include "char_class.hpp"
+#include "utf8.hpp"
 
 extern "C" {
 
+    // Kept for ABI compatibility, prefer the inline predicates in char_class.hpp
+    // They answer as the <cctype> versions did in the C locale, which differ from lust::is_alpha()/is_alnum()
+
     bool lust_is_space(char c) {
-        return std::isspace(static_cast<unsigned char>(c));
+        return lust::is_space(c);
     }
 
+    // Anything that is not a space, a punctuation or a control: letters, digits and every byte >= 0x80
     bool lust_is_alpha(char c)
     {
-        auto cc = static_cast<unsigned char>(c);
-        return !(std::isspace(cc) || std::ispunct(cc) || std::iscntrl(cc));
+        return lust::char_class::test(c, lust::char_class::ALPHA | lust::char_class::DIGIT);
     }
 
     bool lust_is_digit(char c)
     {
-        return std::isdigit(static_cast<unsigned char>(c));
+        return lust::is_digit(c);
     }
 
+    // ASCII letters and digits only
     bool lust_is_alnum(char c)
     {
-        return std::isalnum(static_cast<unsigned char>(c));
+        return static_cast<unsigned char>(c) < 0x80 && lust::is_alnum(c);
     }
 
     uint32_t lust_decode_utf8(const char *s, size_t &i, bool& success)
     {
-        std::string str(s);
+        // The terminator fails the continuation check, so no sequence is read past it
+        return lust_decode_utf8_n(s, i + 4, i, success);
+    }
 
+    uint32_t lust_decode_utf8_n(const char *s, size_t length, size_t &i, bool& success)
+    {
         uint32_t codepoint = 0;
-        size_t extraBytes = 0;
+        const size_t sequence_length = i < length ? lust::utf8::decode(s + i, s + length, codepoint) : 0;
 
-        unsigned char ch = str[i];
-        if (ch <= 0x7F) {
-            codepoint = ch;
-        } else if (ch <= 0xBF) {
-            success = false;
-            return 0;
-        } else if (ch <= 0xDF) {
-            codepoint = ch & 0x1F;
-            extraBytes = 1;
-        } else if (ch <= 0xEF) {
-            codepoint = ch & 0x0F;
-            extraBytes = 2;
-        } else if (ch <= 0xF7) {
-            codepoint = ch & 0x07;
-            extraBytes = 3;
-        } else {
-            success = false;
+        success = sequence_length != 0;
+        if (!success) {
             return 0;
         }
 
-        while (extraBytes > 0) {
-            ++i;
-            if (i >= str.size()) {
-                success = false;
-                return 0;
-            }
-            ch = str[i];
-            if ((ch & 0xC0) != 0x80) {
-                success = false;
-                return 0;
-            }
-            codepoint = (codepoint << 6) | (ch & 0x3F);
-            --extraBytes;
-        }
-        success = true;
+        // Leave `i` on the last byte of the sequence
+        i += sequence_length - 1;
         return codepoint;
     }
 }
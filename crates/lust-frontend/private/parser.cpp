@@ -1,28 +1,36 @@
 #include "parser.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <string_view>
 #include <iostream>
-#include <sstream>
 #include <utility>
 
+#include "container/string_builder.hpp"
 #include "container/unique_ptr.hpp"
 #include "grammar.hpp"
 #include "grammar/type_expr.hpp"
 #include "grammar/operator_expr.hpp"
 #include "lexer.hpp"
+#include "source_map.hpp"
+#include "token_ring.hpp"
 
 namespace lust
 {
 namespace grammar
 {
     /**
-     * A LL(1) parser
+     * A LL(k) parser, k is bounded by the capacity of the token ring
      */
     class Parser : public IParser {
     public:
         Parser(lexer::TokenStream& token_stream);
 
-        lust::UniquePtr<ASTNode_Program> parse() override;
+        Parser(const lexer::TokenBuffer& token_buffer);
+
+        Ast parse() override;
+
+        FlatAst parse_flat() override;
 
         bool is_error_occurred() const override;
 
@@ -39,6 +47,30 @@ namespace grammar
 
         lexer::Token next_token();
 
+        /**
+         * @brief The `n`-th token after the current one, peek(0) is the token following m_current_token
+         */
+        const lexer::Token& peek(size_t n = 0);
+
+        /**
+         * @brief Text of the source being parsed
+         */
+        std::string_view source_text();
+
+        /**
+         * @brief Decode a STRING token into the literal arena, equal literals share one copy
+         * @return false if the literal holds an invalid escape sequence
+         */
+        bool decode_literal(const lexer::Token& token, std::string_view& out_text);
+
+        /**
+         * @brief Run `attempt` speculatively. When it returns false or reports an error, the tokens it consumed
+         * and the arena space of the nodes it built are given back and its errors are dropped, so the caller can try another rule.
+         * @return Whether the attempt was kept
+         */
+        template <typename Fn>
+        bool try_parse(Fn&& attempt);
+
         /**
          * @brief The token consumer
          */
@@ -49,91 +81,112 @@ namespace grammar
          */
         bool optional(lexer::TerminalTokenType expected_type);
     private:
-        lexer::TokenStream& m_token_stream;
+        lexer::TokenRing m_tokens;
+
         lexer::Token m_current_token{};
 
+        // Nodes of the tree being built, handed over to the Ast once parsed
+        AstArena m_arena;
+
+        // Text of the string literals, handed over with the nodes. Speculative attempts don't roll it back,
+        // so the index below never views freed text.
+        AstArena m_literal_arena;
+        // Open addressing over the text in the literal arena, a power of two in size, null views are free slots
+        vector<std::string_view> m_literal_index;
+        size_t m_literal_count = 0;
+
         bool m_error_occurred = false;
 
+        // Errors are muted while speculating, try_parse() only needs to know whether one happened
+        uint32_t m_speculation_depth = 0;
+        bool m_speculation_failed = false;
+
+        // Line index for diagnostics, built on the first error
+        lexer::SourceMap m_source_map;
+
+        // Diagnostic text, the buffer is reused from one error to the next
+        string_builder m_message;
+
     private:
-        UniquePtr<ASTNode_Program> parse_program();
+        AstPtr<ASTNode_Program> parse_program();
     
-        UniquePtr<ASTNode_Statement> parse_statement();
+        AstPtr<ASTNode_Statement> parse_statement();
 
-        UniquePtr<ASTNode_Statement> parse_statement_pub_prefix();
+        AstPtr<ASTNode_Statement> parse_statement_pub_prefix();
 
-        UniquePtr<ASTNode_VarDecl> parse_variable_declaration();
+        AstPtr<ASTNode_VarDecl> parse_variable_declaration();
 
-        UniquePtr<ASTNode_FunctionDecl> parse_function_declaration();
+        AstPtr<ASTNode_FunctionDecl> parse_function_declaration();
 
-        vector<UniquePtr<ASTNode_Attribute>> parse_attribute_declaration();
+        AstList<AstPtr<ASTNode_Attribute>> parse_attribute_declaration();
 
         QualifiedName parse_qualifier_name();
 
         Visibility parse_visibility();
 
-        UniquePtr<ASTNode_GenericParam> parse_generic_param();
+        AstPtr<ASTNode_GenericParam> parse_generic_param();
 
-        vector<UniquePtr<ASTNode_GenericParam>> try_parse_generic_params();
+        AstList<AstPtr<ASTNode_GenericParam>> try_parse_generic_params();
 
-        UniquePtr<ASTNode_TypeExpr> parse_trival_type();
+        AstPtr<ASTNode_TypeExpr> parse_trival_type();
 
-        UniquePtr<ASTNode_TypeExpr_Tuple> parse_tuple_type();
+        AstPtr<ASTNode_TypeExpr_Tuple> parse_tuple_type();
 
-        UniquePtr<ASTNode_TypeExpr_Array> parse_array_type();
+        AstPtr<ASTNode_TypeExpr_Array> parse_array_type();
 
-        UniquePtr<ASTNode_TypeExpr_Reference> parse_reference_type();
+        AstPtr<ASTNode_TypeExpr_Reference> parse_reference_type();
 
-        UniquePtr<ASTNode_TypeExpr_Function> parse_function_type();
+        AstPtr<ASTNode_TypeExpr_Function> parse_function_type();
 
-        UniquePtr<ASTNode_TypeExpr> parse_type_expr();
+        AstPtr<ASTNode_TypeExpr> parse_type_expr();
 
-        UniquePtr<ASTNode_TypeExpr> create_unit_type();
+        AstPtr<ASTNode_TypeExpr> create_unit_type();
 
-        UniquePtr<ASTNode_ParamDecl> parse_invokable_wanted_param();
+        AstPtr<ASTNode_ParamDecl> parse_invokable_wanted_param();
 
-        UniquePtr<ASTNode_InvokeParameters> parse_invoke_param_list();
+        AstPtr<ASTNode_InvokeParameters> parse_invoke_param_list();
 
-        UniquePtr<ASTNode_Block> parse_code_block();
+        AstPtr<ASTNode_Block> parse_code_block();
 
-        UniquePtr<ASTNode_Statement> parse_statement_with_attributes();
+        AstPtr<ASTNode_Statement> parse_statement_with_attributes();
 
-        UniquePtr<ASTNode_StructDecl> parse_struct_declaration();
+        AstPtr<ASTNode_StructDecl> parse_struct_declaration();
 
-        UniquePtr<ASTNode_StructField> parse_struct_field_declaration();
+        AstPtr<ASTNode_StructField> parse_struct_field_declaration();
 
-        UniquePtr<ASTNode_TraitDecl> parse_trait_declaration();
+        AstPtr<ASTNode_TraitDecl> parse_trait_declaration();
 
-        UniquePtr<ASTNode_MorphismsType> parse_morphisms_type();
+        AstPtr<ASTNode_MorphismsType> parse_morphisms_type();
 
-        UniquePtr<ASTNode_MorphismsConstant> parse_morphisms_constant();
+        AstPtr<ASTNode_MorphismsConstant> parse_morphisms_constant();
 
         // === Basic Expressions ===
-        UniquePtr<ASTNode_Operator> parse_expression();
-        UniquePtr<ASTNode_Operator> parse_expr_assignment();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_or();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_and();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_equality();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_none_equality();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_less();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_less_equalty();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_greater();
-        UniquePtr<ASTNode_Operator> parse_expr_logical_greater_equalty();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_add();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_subtract();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_multiply();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_divide();
-        UniquePtr<ASTNode_Operator> parse_expr_bitwise_or();
-        UniquePtr<ASTNode_Operator> parse_expr_bitwise_xor();
-        UniquePtr<ASTNode_Operator> parse_expr_bitwise_and();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_mod();
-        UniquePtr<ASTNode_Operator> parse_expr_arithmetic_exponent();
-        UniquePtr<ASTNode_Operator> parse_expr_member_visit();
-        UniquePtr<ASTNode_Operator> parse_expr_unary();
-        UniquePtr<ASTNode_Operator> parse_expr_primary();
+        AstPtr<ASTNode_Operator> parse_expression();
+        AstPtr<ASTNode_Operator> parse_expr_assignment();
+        AstPtr<ASTNode_Operator> parse_expr_logical_or();
+        AstPtr<ASTNode_Operator> parse_expr_logical_and();
+        AstPtr<ASTNode_Operator> parse_expr_logical_equality();
+        AstPtr<ASTNode_Operator> parse_expr_logical_none_equality();
+        AstPtr<ASTNode_Operator> parse_expr_logical_less();
+        AstPtr<ASTNode_Operator> parse_expr_logical_less_equalty();
+        AstPtr<ASTNode_Operator> parse_expr_logical_greater();
+        AstPtr<ASTNode_Operator> parse_expr_logical_greater_equalty();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_add();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_subtract();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_multiply();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_divide();
+        AstPtr<ASTNode_Operator> parse_expr_bitwise_or();
+        AstPtr<ASTNode_Operator> parse_expr_bitwise_xor();
+        AstPtr<ASTNode_Operator> parse_expr_bitwise_and();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_mod();
+        AstPtr<ASTNode_Operator> parse_expr_arithmetic_exponent();
+        AstPtr<ASTNode_Operator> parse_expr_member_visit();
+        AstPtr<ASTNode_Operator> parse_expr_unary();
+        AstPtr<ASTNode_Operator> parse_expr_primary();
 
         // === Composed Expressions ===
-        UniquePtr<ASTNode_Operator> parse_expr_evaluate_block();
-        UniquePtr<ASTNode_Operator> parse_expr_conditional_evaluate_block();
+        AstPtr<ASTNode_Operator> parse_expr_evaluate_block();
+        AstPtr<ASTNode_Operator> parse_expr_conditional_evaluate_block();
     };
 
     lust::UniquePtr<IParser> IParser::create(lexer::TokenStream &token_stream)
@@ -141,15 +194,46 @@ namespace grammar
         return UniquePtr<IParser>(new Parser(token_stream));
     }
 
+    lust::UniquePtr<IParser> IParser::create(const lexer::TokenBuffer &token_buffer)
+    {
+        return UniquePtr<IParser>(new Parser(token_buffer));
+    }
+
     Parser::Parser(lexer::TokenStream &token_stream)
-        : m_token_stream(token_stream)
+        : m_tokens(token_stream)
         , m_current_token(next_token())
     {
     }
 
-    lust::UniquePtr<ASTNode_Program> Parser::parse()
+    Parser::Parser(const lexer::TokenBuffer &token_buffer)
+        : m_tokens(token_buffer)
+        , m_current_token(next_token())
     {
-        return parse_program();
+    }
+
+    Ast::Ast(AstArena&& arena, AstArena&& literal_arena, AstPtr<ASTNode_Program> program) noexcept
+        : m_arena(std::move(arena))
+        , m_literal_arena(std::move(literal_arena))
+        , m_program(program)
+    { }
+
+    Ast Parser::parse()
+    {
+        AstPtr<ASTNode_Program> program = parse_program();
+        m_literal_index = vector<std::string_view>();
+        m_literal_count = 0;
+        return Ast(std::move(m_arena), std::move(m_literal_arena), program);
+    }
+
+    FlatAst Parser::parse_flat()
+    {
+        AstPtr<ASTNode_Program> program = parse_program();
+        FlatAst flat = FlatAst::build(*program);
+        m_arena = AstArena();
+        m_literal_arena = AstArena();
+        m_literal_index = vector<std::string_view>();
+        m_literal_count = 0;
+        return flat;
     }
 
     bool Parser::is_error_occurred() const
@@ -159,9 +243,23 @@ namespace grammar
 
     void Parser::error_msg(std::string_view msg)
     {
+        if (m_speculation_depth > 0) {
+            m_speculation_failed = true;
+            return;
+        }
+
         m_error_occurred = true;
-        lexer::SourceLoc loc = lexer::pos_to_line_and_row(m_token_stream->original_text(), m_current_token.pos);
-        std::cerr << "Error occurred while parsing at L" << loc.line << ":" << loc.row << " :\n\t" << msg << "\n";
+        // A streaming tokenizer only keeps a window of the source, lines can't be counted once it moved
+        if (m_tokens.source_text_offset() == 0) {
+            const std::string_view text = source_text();
+            if (m_source_map.source().data() != text.data() || m_source_map.source().size() != text.size()) {
+                m_source_map = lexer::SourceMap(text);
+            }
+            lexer::SourceLoc loc = m_source_map.locate(m_current_token.pos);
+            std::cerr << "Error occurred while parsing at L" << loc.line << ":" << loc.row << " :\n\t" << msg << "\n";
+        } else {
+            std::cerr << "Error occurred while parsing at byte " << m_current_token.pos << " :\n\t" << msg << "\n";
+        }
     }
 
     void Parser::error(std::string_view msg)
@@ -174,15 +272,99 @@ namespace grammar
 
     lexer::Token Parser::next_token()
     {
-        lexer::Token current = m_token_stream->next_token();
-
-        // Ignore comment for now
+        // Comments are already dropped by the ring
         // TODO: Comment might useful while generating documents
-        while (current.type == lexer::TerminalTokenType::COMMENTVAL) {
-            current = m_token_stream->next_token();
+        return m_tokens.consume();
+    }
+
+    const lexer::Token& Parser::peek(size_t n)
+    {
+        return m_tokens.peek(n);
+    }
+
+    std::string_view Parser::source_text()
+    {
+        return m_tokens.source_text();
+    }
+
+    namespace
+    {
+        // Slot holding `text` in an open addressing index, or the free slot it goes to
+        size_t find_literal_slot(const vector<std::string_view>& index, std::string_view text)
+        {
+            const size_t mask = index.size() - 1;
+            size_t slot = std::hash<std::string_view>{}(text) & mask;
+            while (index[slot].data() != nullptr && index[slot] != text) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+    }
+
+    bool Parser::decode_literal(const lexer::Token& token, std::string_view& out_text)
+    {
+        out_text = {};
+        if (token.value.empty()) {
+            return true;
+        }
+
+        // Decoded in place first, a literal seen before gives the space back
+        const AstArena::Mark mark = m_literal_arena.mark();
+        char* const text = m_literal_arena.allocate_array<char>(token.value.size());
+        const int64_t size = lexer::decode_string_literal(token, text);
+        if (size < 0) {
+            m_literal_arena.rollback(mark);
+            return false;
+        }
+        const std::string_view decoded(text, static_cast<size_t>(size));
+
+        // Kept at most half full
+        if ((m_literal_count + 1) * 2 > m_literal_index.size()) {
+            vector<std::string_view> old = std::move(m_literal_index);
+            m_literal_index.resize(std::max<size_t>(old.size() * 2, 64));
+            for (std::string_view literal : old) {
+                if (literal.data() != nullptr) {
+                    m_literal_index[find_literal_slot(m_literal_index, literal)] = literal;
+                }
+            }
+        }
+
+        std::string_view& slot = m_literal_index[find_literal_slot(m_literal_index, decoded)];
+        if (slot.data() != nullptr) {
+            m_literal_arena.rollback(mark);
+        } else {
+            slot = decoded;
+            ++m_literal_count;
+        }
+        out_text = slot;
+        return true;
+    }
+
+    template <typename Fn>
+    bool Parser::try_parse(Fn&& attempt)
+    {
+        // The current token is already out of the ring, it is saved aside
+        const lexer::Token current_token = m_current_token;
+        const lexer::TokenRing::Checkpoint checkpoint = m_tokens.checkpoint();
+        // Nodes built by a failed attempt are unreachable, their arena space is reused
+        const AstArena::Mark arena_mark = m_arena.mark();
+        const bool outer_failed = std::exchange(m_speculation_failed, false);
+
+        ++m_speculation_depth;
+        const bool succeeded = attempt() && !m_speculation_failed;
+        --m_speculation_depth;
+
+        m_speculation_failed = outer_failed;
+        if (succeeded) {
+            return true;
         }
 
-        return current;
+        m_current_token = current_token;
+        m_arena.rollback(arena_mark);
+        if (!m_tokens.rollback(checkpoint)) {
+            error_msg("Can't backtrack that far in a streaming source");
+        }
+        return false;
     }
 
     bool Parser::expected(lexer::TerminalTokenType expected_type, std::string_view failure_msg)
@@ -191,13 +373,19 @@ namespace grammar
             m_current_token = next_token();
             return true;
         } else {
-            std::stringstream s;
-            s << "Unexpected token. Expected " << lexer::token_type_to_string(expected_type) << ", found " << lexer::token_type_to_string(m_current_token.type) << ".";
+            // A speculative attempt only needs to know that it failed
+            if (m_speculation_depth > 0) {
+                error({});
+                return false;
+            }
+
+            m_message.clear();
+            m_message << "Unexpected token. Expected " << lexer::token_type_to_string(expected_type) << ", found " << lexer::token_type_to_string(m_current_token.type) << ".";
             if (!failure_msg.empty()) {
-                s << "\n\tReason: " << failure_msg;
+                m_message << "\n\tReason: " << failure_msg;
             }
-            s << std::endl;
-            error(s.str());
+            m_message << '\n';
+            error(m_message.view());
             return false;
         }
     }
@@ -211,9 +399,9 @@ namespace grammar
         return false;
     }
 
-    UniquePtr<ASTNode_Program> Parser::parse_program()
+    AstPtr<ASTNode_Program> Parser::parse_program()
     {
-        UniquePtr<ASTNode_Program> node = lust::make_unique<ASTNode_Program>();
+        AstPtr<ASTNode_Program> node = m_arena.make<ASTNode_Program>();
         while (true) {
             switch (m_current_token.type)
             {
@@ -222,24 +410,24 @@ namespace grammar
                 return node;
 
             case lexer::TerminalTokenType::GLOBAL_ATTRIBUTE_START:
-                node->attributes.extend(parse_attribute_declaration());
+                node->attributes.extend(m_arena, parse_attribute_declaration());
                 break;
 
             case lexer::TerminalTokenType::ATTRIBUTE_START:
-                node->statements.push_back(parse_statement_with_attributes());
+                node->statements.push_back(m_arena, parse_statement_with_attributes());
                 break;
             
             default:
-                node->statements.push_back(parse_statement());
+                node->statements.push_back(m_arena, parse_statement());
                 break;
             }
         }
         return node;
     }
 
-    UniquePtr<ASTNode_Statement> Parser::parse_statement()
+    AstPtr<ASTNode_Statement> Parser::parse_statement()
     {
-        UniquePtr<ASTNode_Statement> statement = nullptr;
+        AstPtr<ASTNode_Statement> statement = nullptr;
 
         switch (m_current_token.type)
         {
@@ -269,7 +457,7 @@ namespace grammar
             if (!expr || expr->operator_type == OperatorType::INVALID) {
                 error("Invalid statement");
             } else {
-                auto new_statement = make_unique<ASTNode_ExprStatement>();
+                auto new_statement = m_arena.make<ASTNode_ExprStatement>();
                 new_statement->expression = std::move(expr);
                 if (!optional(lexer::TerminalTokenType::SEMICOLON)) {
                     new_statement->is_end_with_semicolon = false;
@@ -282,17 +470,17 @@ namespace grammar
         return statement;
     }
 
-    UniquePtr<ASTNode_Statement> Parser::parse_statement_pub_prefix()
+    AstPtr<ASTNode_Statement> Parser::parse_statement_pub_prefix()
     {
         Visibility visibility = parse_visibility();
-        UniquePtr<ASTNode_Statement> statement = parse_statement();
+        AstPtr<ASTNode_Statement> statement = parse_statement();
         statement->visibility = visibility;
         return statement;
     }
 
-    UniquePtr<ASTNode_VarDecl> Parser::parse_variable_declaration()
+    AstPtr<ASTNode_VarDecl> Parser::parse_variable_declaration()
     {
-        UniquePtr<ASTNode_VarDecl> res = make_unique<ASTNode_VarDecl>();
+        AstPtr<ASTNode_VarDecl> res = m_arena.make<ASTNode_VarDecl>();
 
         bool is_let = false;
         bool is_const = false;
@@ -311,7 +499,7 @@ namespace grammar
             res->is_mutable = true;
         }
 
-        res->identifier = m_current_token.value;
+        res->identifier = m_current_token.symbol;
         expected(lexer::TerminalTokenType::IDENT);
 
         // type is optional if it can be infered from assign expression
@@ -333,21 +521,22 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_FunctionDecl> Parser::parse_function_declaration()
+    AstPtr<ASTNode_FunctionDecl> Parser::parse_function_declaration()
     {
-        UniquePtr<ASTNode_FunctionDecl> function = make_unique<ASTNode_FunctionDecl>();
+        AstPtr<ASTNode_FunctionDecl> function = m_arena.make<ASTNode_FunctionDecl>();
 
         function->is_async = optional(lexer::TerminalTokenType::ASYNC);
         expected(lexer::TerminalTokenType::FN);
-        function->identifier = m_current_token.value;
+        function->identifier = m_current_token.symbol;
         expected(lexer::TerminalTokenType::IDENT);
         function->generic_params = try_parse_generic_params();
 
         expected(lexer::TerminalTokenType::LPAREN);
         
+        function->params = m_arena.make<ASTNode_ParamList>();
         while (!optional(lexer::TerminalTokenType::RPAREN)) {
             if (auto param = parse_invokable_wanted_param(); param) {
-                function->params->params.push_back(param);
+                function->params->params.push_back(m_arena, param);
             }
 
             if (!optional(lexer::TerminalTokenType::COMMA)) {
@@ -375,11 +564,11 @@ namespace grammar
         return nullptr;
     }
 
-    vector<UniquePtr<ASTNode_Attribute>> Parser::parse_attribute_declaration()
+    AstList<AstPtr<ASTNode_Attribute>> Parser::parse_attribute_declaration()
     {
         // #[label::label, label2(ident, ident)]
 
-        vector<UniquePtr<ASTNode_Attribute>> attributes;
+        AstList<AstPtr<ASTNode_Attribute>> attributes;
 
         if (optional(lexer::TerminalTokenType::GLOBAL_ATTRIBUTE_START)) {
             expected(lexer::TerminalTokenType::LBRACKET);
@@ -387,13 +576,13 @@ namespace grammar
             expected(lexer::TerminalTokenType::ATTRIBUTE_START);
         }
 
-        auto parse_item = [&] () -> UniquePtr<ASTNode_Attribute> {
-            auto result = make_unique<ASTNode_Attribute>();
+        auto parse_item = [&] () -> AstPtr<ASTNode_Attribute> {
+            auto result = m_arena.make<ASTNode_Attribute>();
             result->name = parse_qualifier_name();
             if (optional(lexer::TerminalTokenType::LPAREN)) {
                 while (m_current_token.type != lexer::TerminalTokenType::RPAREN) {
                     if (!expected(lexer::TerminalTokenType::IDENT)) {
-                        result->args.push_back(m_current_token.value);
+                        result->args.push_back(m_arena, m_current_token.symbol);
                         break;
                     }
                 }
@@ -403,11 +592,11 @@ namespace grammar
         };
 
         // Doesn't allow empty attribute declaration
-        attributes.push_back(parse_item());
+        attributes.push_back(m_arena, parse_item());
 
         while (m_current_token.type == lexer::TerminalTokenType::COMMA) {
             expected(lexer::TerminalTokenType::COMMA);
-            attributes.push_back(parse_item());
+            attributes.push_back(m_arena, parse_item());
         }
 
         expected(lexer::TerminalTokenType::RBRACKET, "Attribute should be closed");
@@ -417,20 +606,18 @@ namespace grammar
 
     QualifiedName Parser::parse_qualifier_name()
     {
-        vector<simple_string> parts;
-        parts.push_back(m_current_token.value);
+        QualifiedName name{ m_current_token.symbol, {} };
         expected(lexer::TerminalTokenType::IDENT);
 
+        // Every name but the last one is a namespace
         while (m_current_token.type == lexer::TerminalTokenType::COLONCOLON) {
             expected(lexer::TerminalTokenType::COLONCOLON);
-            parts.push_back(m_current_token.value);
+            name.name_spaces.push_back(m_arena, name.name);
+            name.name = m_current_token.symbol;
             expected(lexer::TerminalTokenType::IDENT);
         }
-        
-        return QualifiedName {
-            parts.back(),
-            parts.slice(0, parts.size() - 1),
-        };
+
+        return name;
     }
 
     Visibility Parser::parse_visibility()
@@ -439,7 +626,14 @@ namespace grammar
 
         expected(lexer::TerminalTokenType::PUB);
 
-        if (optional(lexer::TerminalTokenType::LPAREN)) {
+        // `pub(crate)` needs 3 tokens of lookahead, any other parenthesis belongs to the statement
+        const lexer::TerminalTokenType scope = peek(0).type;
+        const bool is_scoped = m_current_token.type == lexer::TerminalTokenType::LPAREN
+            && peek(1).type == lexer::TerminalTokenType::RPAREN
+            && (scope == lexer::TerminalTokenType::SELF || scope == lexer::TerminalTokenType::SUPER || scope == lexer::TerminalTokenType::CRATE);
+
+        if (is_scoped) {
+            expected(lexer::TerminalTokenType::LPAREN);
 
             if (optional(lexer::TerminalTokenType::SELF)) {
                 res = Visibility::SELF;
@@ -457,15 +651,15 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_GenericParam> Parser::parse_generic_param()
+    AstPtr<ASTNode_GenericParam> Parser::parse_generic_param()
     {
-        UniquePtr<ASTNode_GenericParam> res = make_unique<ASTNode_GenericParam>();
+        AstPtr<ASTNode_GenericParam> res = m_arena.make<ASTNode_GenericParam>();
 
-        res->types.push_back(parse_type_expr());
+        res->types.push_back(m_arena, parse_type_expr());
 
         if (optional(lexer::TerminalTokenType::COLON)) {
             do {
-                res->constraints.push_back(parse_qualifier_name());
+                res->constraints.push_back(m_arena, parse_qualifier_name());
                 if (!optional(lexer::TerminalTokenType::PLUS))
                     break;
             } while (true);
@@ -474,14 +668,14 @@ namespace grammar
         return res;
     }
 
-    vector<UniquePtr<ASTNode_GenericParam>> Parser::try_parse_generic_params()
+    AstList<AstPtr<ASTNode_GenericParam>> Parser::try_parse_generic_params()
     {
         if (optional(lexer::TerminalTokenType::LT)) {
-            vector<UniquePtr<ASTNode_GenericParam>> res;
+            AstList<AstPtr<ASTNode_GenericParam>> res;
 
             while (!optional(lexer::TerminalTokenType::GT)) {
                 if (auto param = parse_generic_param()) {
-                    res.push_back(std::move(param));
+                    res.push_back(m_arena, param);
                 } else {
                     break;
                 }
@@ -497,34 +691,34 @@ namespace grammar
         return {};
     }
 
-    UniquePtr<ASTNode_TypeExpr> Parser::parse_trival_type()
+    AstPtr<ASTNode_TypeExpr> Parser::parse_trival_type()
     {
 
         QualifiedName type_name = parse_qualifier_name();
 
         if (m_current_token.type == lexer::TerminalTokenType::LT) {
-            UniquePtr<ASTNode_TypeExpr_Generic> res = make_unique<ASTNode_TypeExpr_Generic>();
+            AstPtr<ASTNode_TypeExpr_Generic> res = m_arena.make<ASTNode_TypeExpr_Generic>();
             res->base_type = type_name;
             res->params = try_parse_generic_params();
             return res;
         }
 
-        UniquePtr<ASTNode_TypeExpr_Trivial> res = make_unique<ASTNode_TypeExpr_Trivial>();
+        AstPtr<ASTNode_TypeExpr_Trivial> res = m_arena.make<ASTNode_TypeExpr_Trivial>();
 
         res->type_name = type_name;
 
         return res;
     }
 
-    UniquePtr<ASTNode_TypeExpr_Tuple> Parser::parse_tuple_type()
+    AstPtr<ASTNode_TypeExpr_Tuple> Parser::parse_tuple_type()
     {
-        UniquePtr<ASTNode_TypeExpr_Tuple> res = make_unique<ASTNode_TypeExpr_Tuple>();
+        AstPtr<ASTNode_TypeExpr_Tuple> res = m_arena.make<ASTNode_TypeExpr_Tuple>();
 
         expected(lexer::TerminalTokenType::LPAREN);
 
         while (!optional(lexer::TerminalTokenType::RPAREN)) {
             if (auto type_exp = parse_type_expr(); type_exp) {
-                res->composite_types.push_back(std::move(type_exp));
+                res->composite_types.push_back(m_arena, type_exp);
             } else {
                 break;
             }
@@ -538,9 +732,9 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_TypeExpr_Array> Parser::parse_array_type()
+    AstPtr<ASTNode_TypeExpr_Array> Parser::parse_array_type()
     {
-        UniquePtr<ASTNode_TypeExpr_Array> res = make_unique<ASTNode_TypeExpr_Array>();
+        AstPtr<ASTNode_TypeExpr_Array> res = m_arena.make<ASTNode_TypeExpr_Array>();
 
         expected(lexer::TerminalTokenType::LBRACKET);
 
@@ -548,13 +742,13 @@ namespace grammar
 
         expected(lexer::TerminalTokenType::SEMICOLON);
 
-        std::string num_string = m_current_token.get_value();
+        // The literal is decoded by the lexer
+        const lexer::NumberLiteral size_literal = m_current_token.number;
         if (expected(lexer::TerminalTokenType::INT, "It must be an integer to describe array size")) {
-            Number<size_t> num = convert_string_to_number<size_t>(num_string);
-            if (num.is_null) {
+            if (size_literal.is_overflow) {
                 error_msg("Weird integer, it might cause undefined behavior");
             }
-            res->array_size = num.value;
+            res->array_size = static_cast<size_t>(size_literal.integer());
         }
 
         expected(lexer::TerminalTokenType::RBRACKET);
@@ -562,9 +756,9 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_TypeExpr_Reference> Parser::parse_reference_type()
+    AstPtr<ASTNode_TypeExpr_Reference> Parser::parse_reference_type()
     {
-        UniquePtr<ASTNode_TypeExpr_Reference> res = make_unique<ASTNode_TypeExpr_Reference>();
+        AstPtr<ASTNode_TypeExpr_Reference> res = m_arena.make<ASTNode_TypeExpr_Reference>();
 
         expected(lexer::TerminalTokenType::BITAND);
 
@@ -573,9 +767,9 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_TypeExpr_Function> Parser::parse_function_type()
+    AstPtr<ASTNode_TypeExpr_Function> Parser::parse_function_type()
     {
-        UniquePtr<ASTNode_TypeExpr_Function> res = make_unique<ASTNode_TypeExpr_Function>();
+        AstPtr<ASTNode_TypeExpr_Function> res = m_arena.make<ASTNode_TypeExpr_Function>();
 
         expected(lexer::TerminalTokenType::FN);
         expected(lexer::TerminalTokenType::LPAREN);
@@ -583,7 +777,7 @@ namespace grammar
         if (!optional(lexer::TerminalTokenType::RPAREN)) {
             do {
                 if (auto type_exp = parse_type_expr(); type_exp) {
-                    res->param_types.push_back(type_exp);
+                    res->param_types.push_back(m_arena, type_exp);
                 } else {
                     break;
                 }
@@ -609,16 +803,16 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_TypeExpr> Parser::parse_type_expr()
+    AstPtr<ASTNode_TypeExpr> Parser::parse_type_expr()
     {
         if (lexer::TerminalTokenType::FN == m_current_token.type) {
-            return UniquePtr<ASTNode_TypeExpr>(parse_function_type());
+            return AstPtr<ASTNode_TypeExpr>(parse_function_type());
         } else if (lexer::TerminalTokenType::LBRACKET == m_current_token.type) {
-            return UniquePtr<ASTNode_TypeExpr>(parse_array_type());
+            return AstPtr<ASTNode_TypeExpr>(parse_array_type());
         } else if (lexer::TerminalTokenType::LPAREN == m_current_token.type) {
-            return UniquePtr<ASTNode_TypeExpr>(parse_tuple_type());
+            return AstPtr<ASTNode_TypeExpr>(parse_tuple_type());
         } else if (lexer::TerminalTokenType::BITAND == m_current_token.type) {
-            return UniquePtr<ASTNode_TypeExpr>(parse_reference_type());
+            return AstPtr<ASTNode_TypeExpr>(parse_reference_type());
         } else if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
             return parse_trival_type();
         }
@@ -627,20 +821,21 @@ namespace grammar
         return nullptr;
     }
 
-    UniquePtr<ASTNode_TypeExpr> Parser::create_unit_type()
+    AstPtr<ASTNode_TypeExpr> Parser::create_unit_type()
     {
-        return make_unique<ASTNode_TypeExpr>();
+        return m_arena.make<ASTNode_TypeExpr>();
     }
 
-    UniquePtr<ASTNode_ParamDecl> Parser::parse_invokable_wanted_param()
+    AstPtr<ASTNode_ParamDecl> Parser::parse_invokable_wanted_param()
     {
-        UniquePtr<ASTNode_ParamDecl> res = make_unique<ASTNode_ParamDecl>();
+        AstPtr<ASTNode_ParamDecl> res = m_arena.make<ASTNode_ParamDecl>();
 
         if (optional(lexer::TerminalTokenType::SELF)) {
             res->is_instance_function = true;
-            res->identifier = m_current_token.value;
-        } else if (optional(lexer::TerminalTokenType::IDENT)) {
-            res->identifier = m_current_token.value;
+            res->identifier = intern("self");
+        } else if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
+            res->identifier = m_current_token.symbol;
+            expected(lexer::TerminalTokenType::IDENT);
 
             expected(lexer::TerminalTokenType::COLON);
 
@@ -657,13 +852,13 @@ namespace grammar
         return res;
     }
 
-    UniquePtr<ASTNode_InvokeParameters> Parser::parse_invoke_param_list() {
-        auto new_node = make_unique<ASTNode_InvokeParameters>();
+    AstPtr<ASTNode_InvokeParameters> Parser::parse_invoke_param_list() {
+        auto new_node = m_arena.make<ASTNode_InvokeParameters>();
 
         expected(lexer::TerminalTokenType::LPAREN);
         
         while (!optional(lexer::TerminalTokenType::RPAREN)) {
-            new_node->parameter_expressions.push_back(parse_expression());
+            new_node->parameter_expressions.push_back(m_arena, parse_expression());
 
             // Every parameter expression should follow a comma
             if (!optional(lexer::TerminalTokenType::COMMA)) {
@@ -675,22 +870,22 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_Block> Parser::parse_code_block() {
-        UniquePtr<ASTNode_Block> res = make_unique<ASTNode_Block>();
+    AstPtr<ASTNode_Block> Parser::parse_code_block() {
+        AstPtr<ASTNode_Block> res = m_arena.make<ASTNode_Block>();
 
         expected(lexer::TerminalTokenType::LBRACE);
 
         while (!optional(lexer::TerminalTokenType::RBRACE)) {
-            res->statements.push_back(parse_statement());
+            res->statements.push_back(m_arena, parse_statement());
         }
 
         return res;
     }
 
-    UniquePtr<ASTNode_Statement> Parser::parse_statement_with_attributes() {
-        vector<UniquePtr<ASTNode_Attribute>> attributes;
+    AstPtr<ASTNode_Statement> Parser::parse_statement_with_attributes() {
+        AstList<AstPtr<ASTNode_Attribute>> attributes;
         while (lexer::TerminalTokenType::ATTRIBUTE_START == m_current_token.type) {
-            attributes.extend(parse_attribute_declaration());
+            attributes.extend(m_arena, parse_attribute_declaration());
         }
         auto statement = parse_statement();
         if (statement) {
@@ -699,15 +894,15 @@ namespace grammar
         return statement;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expression() {
+    AstPtr<ASTNode_Operator> Parser::parse_expression() {
         return parse_expr_assignment();
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_assignment() {
-        UniquePtr<ASTNode_Operator> node = parse_expr_logical_or();
+    AstPtr<ASTNode_Operator> Parser::parse_expr_assignment() {
+        AstPtr<ASTNode_Operator> node = parse_expr_logical_or();
 
         while (lexer::is_assignment_token(m_current_token.type)) {
-            UniquePtr<ASTNode_Operator> new_node = make_unique<ASTNode_Operator>();
+            AstPtr<ASTNode_Operator> new_node = m_arena.make<ASTNode_Operator>();
             switch (m_current_token.type) {
                 case lexer::TerminalTokenType::EQ:
                     new_node->operator_type = OperatorType::ASSIGNMENT;
@@ -749,11 +944,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_or() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_or() {
         auto node = parse_expr_logical_and();
 
         while (optional(lexer::TerminalTokenType::OR)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_OR;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_and();
@@ -763,11 +958,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_and() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_and() {
         auto node = parse_expr_logical_equality();
 
         while (optional(lexer::TerminalTokenType::AND)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_AND;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_equality();
@@ -777,11 +972,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_equality() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_equality() {
         auto node = parse_expr_logical_none_equality();
 
         while (optional(lexer::TerminalTokenType::EQEQ)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_EQUALITY;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_none_equality();
@@ -791,11 +986,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_none_equality() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_none_equality() {
         auto node = parse_expr_logical_less();
 
         while (optional(lexer::TerminalTokenType::NEQ)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_NONE_EQUALITY;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_less();
@@ -805,11 +1000,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_less() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_less() {
         auto node = parse_expr_logical_less_equalty();
 
         while (optional(lexer::TerminalTokenType::LT)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_RELATION_LESS_THAN;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_none_equality();
@@ -819,11 +1014,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_less_equalty() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_less_equalty() {
         auto node = parse_expr_logical_greater();
 
         while (optional(lexer::TerminalTokenType::LTE)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_RELATION_LESS_THAN_EQUALITY;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_greater();
@@ -833,11 +1028,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_greater() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_greater() {
         auto node = parse_expr_logical_greater_equalty();
 
         while (optional(lexer::TerminalTokenType::GT)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_RELATION_GREATER_THAN;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_logical_greater_equalty();
@@ -847,11 +1042,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_logical_greater_equalty() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_logical_greater_equalty() {
         auto node = parse_expr_arithmetic_add();
 
         while (optional(lexer::TerminalTokenType::GTE)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::LOGICAL_RELATION_GREATER_THAN_EQUALITY;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_add();
@@ -861,11 +1056,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_add() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_add() {
         auto node = parse_expr_arithmetic_subtract();
 
         while (optional(lexer::TerminalTokenType::PLUS)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_ADD;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_subtract();
@@ -875,11 +1070,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_subtract() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_subtract() {
         auto node = parse_expr_arithmetic_multiply();
 
         while (optional(lexer::TerminalTokenType::MINUS)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_SUBTRACT;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_multiply();
@@ -889,11 +1084,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_multiply() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_multiply() {
         auto node = parse_expr_arithmetic_divide();
 
         while (optional(lexer::TerminalTokenType::STAR)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_MULTIPLY;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_divide();
@@ -903,11 +1098,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_divide() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_divide() {
         auto node = parse_expr_bitwise_or();
 
         while (optional(lexer::TerminalTokenType::SLASH)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_DIVIDE;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_bitwise_or();
@@ -917,11 +1112,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_bitwise_or() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_bitwise_or() {
         auto node = parse_expr_bitwise_xor();
 
         while (optional(lexer::TerminalTokenType::BITOR)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::BITWISE_OR;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_bitwise_xor();
@@ -931,11 +1126,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_bitwise_xor() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_bitwise_xor() {
         auto node = parse_expr_bitwise_and();
 
         while (optional(lexer::TerminalTokenType::BITXOR)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::BITWISE_XOR;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_bitwise_and();
@@ -945,11 +1140,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_bitwise_and() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_bitwise_and() {
         auto node = parse_expr_arithmetic_mod();
 
         while (optional(lexer::TerminalTokenType::BITAND)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::BITWISE_AND;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_mod();
@@ -959,11 +1154,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_mod() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_mod() {
         auto node = parse_expr_arithmetic_exponent();
 
         while (optional(lexer::TerminalTokenType::PRECENTAGE)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_MOD;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_arithmetic_exponent();
@@ -973,11 +1168,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_arithmetic_exponent() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_arithmetic_exponent() {
         auto node = parse_expr_member_visit();
 
         while (optional(lexer::TerminalTokenType::STARSTAR)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::ARITHMETIC_EXPONENT;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_member_visit();
@@ -987,11 +1182,11 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_member_visit() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_member_visit() {
         auto node = parse_expr_unary();
 
         while (optional(lexer::TerminalTokenType::DOT)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             new_node->operator_type = OperatorType::MEMBER_VISIT;
             new_node->left_oprand = std::move(node);
             new_node->right_oprand = parse_expr_unary();
@@ -1001,9 +1196,9 @@ namespace grammar
         return node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_unary() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_unary() {
         if (lexer::is_unary_token(m_current_token.type)) {
-            auto new_node = make_unique<ASTNode_Operator>();
+            auto new_node = m_arena.make<ASTNode_Operator>();
             switch (m_current_token.type) {
                 case lexer::TerminalTokenType::MINUS:
                     new_node->operator_type = OperatorType::UNARY_ARITHMETIC_SELF_CHANGE_SIGN;
@@ -1031,26 +1226,52 @@ namespace grammar
         return parse_expr_primary();
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_primary() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_primary() {
         if (lexer::TerminalTokenType::INT == m_current_token.type) {
-            auto res = make_unique<ASTNode_IntegerExpr>();
+            auto res = m_arena.make<ASTNode_IntegerExpr>();
             res->operator_type = OperatorType::LITERAL_INTEGER;
+            res->value = m_current_token.number.integer();
+            res->suffix = m_current_token.number.suffix;
+            if (m_current_token.number.is_overflow) {
+                error_msg("Integer literal is out of range for its type");
+            }
             expected(lexer::TerminalTokenType::INT);
             return res;
         } else if (lexer::TerminalTokenType::FLOAT == m_current_token.type) {
-            auto res = make_unique<ASTNode_FloatExpr>();
+            auto res = m_arena.make<ASTNode_FloatExpr>();
             res->operator_type = OperatorType::LITERAL_FLOAT;
+            res->value = m_current_token.number.floating();
+            res->suffix = m_current_token.number.suffix;
+            if (m_current_token.number.is_overflow) {
+                error_msg("Float literal is out of range");
+            }
             expected(lexer::TerminalTokenType::FLOAT);
             return res;
         } else if (lexer::TerminalTokenType::STRING == m_current_token.type) {
-            auto res = make_unique<ASTNode_StringExpr>();
+            auto res = m_arena.make<ASTNode_StringExpr>();
             res->operator_type = OperatorType::LITERAL_STRING;
+            // The tree may outlive the source, the text is copied into the literal arena
+            if (!decode_literal(m_current_token, res->value)) {
+                error_msg("Invalid escape sequence in a string literal");
+            }
             expected(lexer::TerminalTokenType::STRING);
             return res;
         } else if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
-            UniquePtr<ASTNode_QualifiedName> res = make_unique<ASTNode_QualifiedName>();
+            AstPtr<ASTNode_QualifiedName> res = m_arena.make<ASTNode_QualifiedName>();
             res->operator_type = OperatorType::VARIABLE;
             res->qualified_name = parse_qualifier_name();
+
+            // `Foo<T>(x)` is a generic call, otherwise the `<` is left to the comparison
+            if (lexer::TerminalTokenType::LT == m_current_token.type) {
+                AstList<AstPtr<ASTNode_GenericParam>> generic_params;
+                if (try_parse([&] {
+                    generic_params = try_parse_generic_params();
+                    return lexer::TerminalTokenType::LPAREN == m_current_token.type;
+                })) {
+                    res->generic_params = std::move(generic_params);
+                }
+            }
+
             if (lexer::TerminalTokenType::LPAREN == m_current_token.type) {
                 // function call, not (expr + expr) etc.
                 res->operator_type = OperatorType::FUNCTION_CALL;
@@ -1072,8 +1293,8 @@ namespace grammar
         return nullptr;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_evaluate_block() {
-        auto new_node = make_unique<ASTNode_BlockExpr>();
+    AstPtr<ASTNode_Operator> Parser::parse_expr_evaluate_block() {
+        auto new_node = m_arena.make<ASTNode_BlockExpr>();
 
         new_node->operator_type = OperatorType::BLOCK;
         new_node->left_code_block = parse_code_block();
@@ -1081,19 +1302,19 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_Operator> Parser::parse_expr_conditional_evaluate_block() {
+    AstPtr<ASTNode_Operator> Parser::parse_expr_conditional_evaluate_block() {
         // TODO
         error("if-expr doesn't implemented yet");
         return nullptr;
     }
 
-    UniquePtr<ASTNode_StructDecl> Parser::parse_struct_declaration() {
-        auto new_node = make_unique<ASTNode_StructDecl>();
+    AstPtr<ASTNode_StructDecl> Parser::parse_struct_declaration() {
+        auto new_node = m_arena.make<ASTNode_StructDecl>();
 
         expected(lexer::TerminalTokenType::STRUCT);
 
         if (m_current_token.type == lexer::TerminalTokenType::IDENT) {
-            new_node->identifier = m_current_token.value;
+            new_node->identifier = m_current_token.symbol;
         }
         expected(lexer::TerminalTokenType::IDENT);
 
@@ -1102,7 +1323,7 @@ namespace grammar
         expected(lexer::TerminalTokenType::LBRACE);
 
         while (!optional(lexer::TerminalTokenType::RBRACE)) {
-            new_node->fields.push_back(parse_struct_field_declaration());
+            new_node->fields.push_back(m_arena, parse_struct_field_declaration());
         }
 
         while (optional(lexer::TerminalTokenType::SEMICOLON)) ;
@@ -1110,11 +1331,11 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_StructField> Parser::parse_struct_field_declaration() {
-        auto new_node = make_unique<ASTNode_StructField>();
+    AstPtr<ASTNode_StructField> Parser::parse_struct_field_declaration() {
+        auto new_node = m_arena.make<ASTNode_StructField>();
 
         if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
-            new_node->identifier = m_current_token.value;
+            new_node->identifier = m_current_token.symbol;
         }
         expected(lexer::TerminalTokenType::IDENT);
 
@@ -1129,12 +1350,12 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_TraitDecl> Parser::parse_trait_declaration() {
-        auto new_node = make_unique<ASTNode_TraitDecl>();
+    AstPtr<ASTNode_TraitDecl> Parser::parse_trait_declaration() {
+        auto new_node = m_arena.make<ASTNode_TraitDecl>();
 
         expected(lexer::TerminalTokenType::TRAIT);
         if (m_current_token.type == lexer::TerminalTokenType::IDENT) {
-            new_node->identifier = m_current_token.value;
+            new_node->identifier = m_current_token.symbol;
         }
         expected(lexer::TerminalTokenType::IDENT);
 
@@ -1149,14 +1370,14 @@ namespace grammar
 
         while (!optional(lexer::TerminalTokenType::RBRACE)) {
             if (lexer::TerminalTokenType::TYPE == m_current_token.type) {
-                new_node->morphisms_types.push_back(parse_morphisms_type());
+                new_node->morphisms_types.push_back(m_arena, parse_morphisms_type());
                 expected(lexer::TerminalTokenType::SEMICOLON);
             } else if (lexer::TerminalTokenType::CONST == m_current_token.type) {
-                new_node->morphisms_constants.push_back(parse_morphisms_constant());
+                new_node->morphisms_constants.push_back(m_arena, parse_morphisms_constant());
                 expected(lexer::TerminalTokenType::SEMICOLON);
             } else {
                 if (auto func = parse_function_declaration()) {
-                    new_node->functions.push_back(func);
+                    new_node->functions.push_back(m_arena, func);
                 } else {
                     break;
                 }
@@ -1168,13 +1389,13 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_MorphismsType> Parser::parse_morphisms_type() {
-        auto new_node = make_unique<ASTNode_MorphismsType>();
+    AstPtr<ASTNode_MorphismsType> Parser::parse_morphisms_type() {
+        auto new_node = m_arena.make<ASTNode_MorphismsType>();
 
         expected(lexer::TerminalTokenType::TYPE);
 
         if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
-            new_node->identifier = m_current_token.get_value();
+            new_node->identifier = m_current_token.symbol;
         }
         expected(lexer::TerminalTokenType::IDENT);
 
@@ -1189,13 +1410,13 @@ namespace grammar
         return new_node;
     }
 
-    UniquePtr<ASTNode_MorphismsConstant> Parser::parse_morphisms_constant() {
-        auto new_node = make_unique<ASTNode_MorphismsConstant>();
+    AstPtr<ASTNode_MorphismsConstant> Parser::parse_morphisms_constant() {
+        auto new_node = m_arena.make<ASTNode_MorphismsConstant>();
 
         expected(lexer::TerminalTokenType::CONST);
 
         if (lexer::TerminalTokenType::IDENT == m_current_token.type) {
-            new_node->identifier = m_current_token.get_value();
+            new_node->identifier = m_current_token.symbol;
         }
         expected(lexer::TerminalTokenType::IDENT);
 
@@ -0,0 +1,563 @@
+#include "simd_scan.hpp"
+#include "char_class.hpp"
+#include "utf8.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define LUST_SIMD_X86_64 1
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#else
+#   define LUST_SIMD_X86_64 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define LUST_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define LUST_TARGET_AVX2
+#endif
+
+namespace lust
+{
+namespace simd
+{
+namespace
+{
+    using ScanFunction = const char* (*)(const char*, const char*);
+    using CollectFunction = void (*)(const char*, const char*, vector<int64_t>&);
+
+    struct ScanKernels {
+        ScanFunction skip_space;
+        ScanFunction skip_digit;
+        ScanFunction skip_ident;
+        ScanFunction find_line_break;
+        ScanFunction find_quote_or_escape;
+        CollectFunction collect_line_starts;
+        ScanFunction find_invalid_utf8;
+    };
+
+    constexpr bool is_line_break(char c) {
+        return c == '\n' || c == '\r';
+    }
+
+    constexpr bool is_quote_or_escape(char c) {
+        return c == '"' || c == '\\';
+    }
+
+    template <bool (*Match)(char)>
+    const char* scalar_skip(const char* p, const char* end) {
+        while (p < end && Match(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    template <bool (*Match)(char)>
+    const char* scalar_find(const char* p, const char* end) {
+        while (p < end && !Match(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    void scalar_collect_line_starts_from(const char* base, const char* p, const char* end, vector<int64_t>& line_starts) {
+        for (; p < end; ++p) {
+            if (*p == '\n') {
+                line_starts.push_back(p - base + 1);
+            }
+        }
+    }
+
+    void scalar_collect_line_starts(const char* begin, const char* end, vector<int64_t>& line_starts) {
+        scalar_collect_line_starts_from(begin, begin, end, line_starts);
+    }
+
+    const char* scalar_find_invalid_utf8(const char* p, const char* end) {
+        uint32_t code_point = 0;
+        while (p < end) {
+            if (static_cast<uint8_t>(*p) < 0x80) {
+                ++p;
+                continue;
+            }
+
+            const size_t length = utf8::decode(p, end, code_point);
+            if (length == 0) {
+                return p;
+            }
+            p += length;
+        }
+        return p;
+    }
+
+    /**
+     * @brief Back up from `p` to the start of the sequence it is in, everything before `p` being valid UTF-8
+     */
+    const char* utf8_sequence_start(const char* begin, const char* p) {
+        for (int i = 0; i < 3 && p > begin && (static_cast<uint8_t>(*p) & 0xC0) == 0x80; ++i) {
+            --p;
+        }
+        return p;
+    }
+
+    constexpr ScanKernels scalar_kernels = {
+        scalar_skip<is_space>,
+        scalar_skip<is_digit>,
+        scalar_skip<is_ident_continue>,
+        scalar_find<is_line_break>,
+        scalar_find<is_quote_or_escape>,
+        scalar_collect_line_starts,
+        scalar_find_invalid_utf8,
+    };
+
+#if LUST_SIMD_X86_64
+    // SSE2 is part of x86-64 baseline, no runtime check needed
+
+    // Unsigned lo <= v <= hi, SSE2 only has signed compares
+    inline __m128i sse2_in_range(__m128i v, char lo, char hi) {
+        const __m128i t = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+        return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(static_cast<char>(hi - lo))), t);
+    }
+
+    inline uint32_t sse2_space_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), sse2_in_range(v, '\t', '\r'));
+        return static_cast<uint32_t>(_mm_movemask_epi8(m));
+    }
+
+    inline uint32_t sse2_digit_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return static_cast<uint32_t>(_mm_movemask_epi8(sse2_in_range(v, '0', '9')));
+    }
+
+    inline uint32_t sse2_ident_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // Folding case maps letters only onto 'a'..'z'
+        __m128i m = sse2_in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        m = _mm_or_si128(m, sse2_in_range(v, '0', '9'));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+        return static_cast<uint32_t>(_mm_movemask_epi8(m));
+    }
+
+    inline uint32_t sse2_line_break_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        return static_cast<uint32_t>(_mm_movemask_epi8(m));
+    }
+
+    inline uint32_t sse2_quote_or_escape_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        return static_cast<uint32_t>(_mm_movemask_epi8(m));
+    }
+
+    template <uint32_t (*Mask)(const char*), bool (*Match)(char)>
+    const char* sse2_skip(const char* p, const char* end) {
+        for (; end - p >= 16; p += 16) {
+            if (const uint32_t miss = ~Mask(p) & 0xFFFFu) {
+                return p + std::countr_zero(miss);
+            }
+        }
+        return scalar_skip<Match>(p, end);
+    }
+
+    template <uint32_t (*Mask)(const char*), bool (*Match)(char)>
+    const char* sse2_find(const char* p, const char* end) {
+        for (; end - p >= 16; p += 16) {
+            if (const uint32_t hit = Mask(p)) {
+                return p + std::countr_zero(hit);
+            }
+        }
+        return scalar_find<Match>(p, end);
+    }
+
+    inline uint32_t sse2_newline_mask(const char* p) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    }
+
+    void sse2_collect_line_starts(const char* begin, const char* end, vector<int64_t>& line_starts) {
+        const char* p = begin;
+        for (; end - p >= 16; p += 16) {
+            // Walk the set bits, one per '\n'
+            for (uint32_t hit = sse2_newline_mask(p); hit != 0; hit &= hit - 1) {
+                line_starts.push_back(p - begin + std::countr_zero(hit) + 1);
+            }
+        }
+        scalar_collect_line_starts_from(begin, p, end, line_starts);
+    }
+
+    // SSE2 has no byte shuffle for the lookup validator, it only skips ASCII blocks
+    const char* sse2_find_invalid_utf8(const char* p, const char* end) {
+        uint32_t code_point = 0;
+        while (end - p >= 16) {
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0) {
+                p += 16;
+                continue;
+            }
+
+            // `p` stays on a sequence boundary
+            const char* const block_end = p + 16;
+            while (p < block_end) {
+                const size_t length = static_cast<uint8_t>(*p) < 0x80 ? 1 : utf8::decode(p, end, code_point);
+                if (length == 0) {
+                    return p;
+                }
+                p += length;
+            }
+        }
+        return scalar_find_invalid_utf8(p, end);
+    }
+
+    constexpr ScanKernels sse2_kernels = {
+        sse2_skip<sse2_space_mask, is_space>,
+        sse2_skip<sse2_digit_mask, is_digit>,
+        sse2_skip<sse2_ident_mask, is_ident_continue>,
+        sse2_find<sse2_line_break_mask, is_line_break>,
+        sse2_find<sse2_quote_or_escape_mask, is_quote_or_escape>,
+        sse2_collect_line_starts,
+        sse2_find_invalid_utf8,
+    };
+
+    LUST_TARGET_AVX2 inline __m256i avx2_in_range(__m256i v, char lo, char hi) {
+        const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(static_cast<char>(hi - lo))), t);
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_space_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), avx2_in_range(v, '\t', '\r'));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_digit_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(avx2_in_range(v, '0', '9')));
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_ident_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m = avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        m = _mm256_or_si256(m, avx2_in_range(v, '0', '9'));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_line_break_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_quote_or_escape_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    }
+
+    template <uint32_t (*Mask)(const char*), bool (*Match)(char)>
+    LUST_TARGET_AVX2 const char* avx2_skip(const char* p, const char* end) {
+        for (; end - p >= 32; p += 32) {
+            if (const uint32_t miss = ~Mask(p)) {
+                return p + std::countr_zero(miss);
+            }
+        }
+        return scalar_skip<Match>(p, end);
+    }
+
+    template <uint32_t (*Mask)(const char*), bool (*Match)(char)>
+    LUST_TARGET_AVX2 const char* avx2_find(const char* p, const char* end) {
+        for (; end - p >= 32; p += 32) {
+            if (const uint32_t hit = Mask(p)) {
+                return p + std::countr_zero(hit);
+            }
+        }
+        return scalar_find<Match>(p, end);
+    }
+
+    LUST_TARGET_AVX2 inline uint32_t avx2_newline_mask(const char* p) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+    }
+
+    LUST_TARGET_AVX2 void avx2_collect_line_starts(const char* begin, const char* end, vector<int64_t>& line_starts) {
+        const char* p = begin;
+        for (; end - p >= 32; p += 32) {
+            for (uint32_t hit = avx2_newline_mask(p); hit != 0; hit &= hit - 1) {
+                line_starts.push_back(p - begin + std::countr_zero(hit) + 1);
+            }
+        }
+        scalar_collect_line_starts_from(begin, p, end, line_starts);
+    }
+
+    /**
+     * Lookup validator from "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire),
+     * as used by simdjson. Three 16-entry tables indexed by nibbles of a byte and its predecessor
+     * flag every invalid 2-byte pattern, 3 and 4 byte sequences are checked with the bytes 2 and 3 back.
+     */
+    namespace utf8_lookup
+    {
+        constexpr char TOO_SHORT = 1 << 0;
+        constexpr char TOO_LONG = 1 << 1;
+        constexpr char OVERLONG_3 = 1 << 2;
+        constexpr char TOO_LARGE = 1 << 3;
+        constexpr char SURROGATE = 1 << 4;
+        constexpr char OVERLONG_2 = 1 << 5;
+        constexpr char TOO_LARGE_1000 = 1 << 6;
+        constexpr char OVERLONG_4 = 1 << 6;
+        constexpr char TWO_CONTS = static_cast<char>(1 << 7);
+        constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+    }
+
+    // The 16 bytes `N` back from each byte of `input`, crossing into `prev_input`
+    template <int N>
+    LUST_TARGET_AVX2 inline __m256i avx2_prev(__m256i input, __m256i prev_input) {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+    }
+
+    LUST_TARGET_AVX2 inline __m256i avx2_high_nibbles(__m256i v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    LUST_TARGET_AVX2 inline __m256i avx2_utf8_errors(__m256i input, __m256i prev_input) {
+        using namespace utf8_lookup;
+
+        const __m256i prev1 = avx2_prev<1>(input, prev_input);
+
+        const __m256i byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            // 0_______ ASCII
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            // 10______ continuation
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            // 1100____ 1101____ two byte lead
+            TOO_SHORT | OVERLONG_2, TOO_SHORT,
+            // 1110____ three byte lead
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            // 1111____ four byte lead
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2, TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+        ), avx2_high_nibbles(prev1));
+
+        const __m256i byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            // ____0000 ____0001
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2,
+            // ____001_
+            CARRY, CARRY,
+            // ____0100 ____0101 ____011_
+            CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            // ____1___, ____1101 is the surrogate lead 0xED
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2,
+            CARRY, CARRY,
+            CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000
+        ), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+
+        const __m256i byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(
+            // 0_______ ASCII
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            // 1000____ 1001____ 101_____ continuation
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            // 11______ lead
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+        ), avx2_high_nibbles(input));
+
+        const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+        // Only 111_____ two bytes back and 1111____ three bytes back reach 0x80, those bytes must be continuations
+        const __m256i is_third_byte = _mm256_subs_epu8(avx2_prev<2>(input, prev_input), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i is_fourth_byte = _mm256_subs_epu8(avx2_prev<3>(input, prev_input), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm256_xor_si256(must_be_continuation, special_cases);
+    }
+
+    // Non-zero if the block ends in the middle of a sequence
+    LUST_TARGET_AVX2 inline __m256i avx2_utf8_incomplete(__m256i input) {
+        const __m256i max_value = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        return _mm256_subs_epu8(input, max_value);
+    }
+
+    /**
+     * @return true if `input` or a sequence started in the previous block is invalid
+     */
+    LUST_TARGET_AVX2 inline bool avx2_check_utf8_block(__m256i input, __m256i& prev_input, __m256i& prev_incomplete) {
+        __m256i error;
+        if (_mm256_movemask_epi8(input) == 0) {
+            // ASCII block, only an unfinished sequence of the previous block can be wrong
+            error = prev_incomplete;
+        } else {
+            error = avx2_utf8_errors(input, prev_input);
+            prev_incomplete = avx2_utf8_incomplete(input);
+        }
+        prev_input = input;
+        return !_mm256_testz_si256(error, error);
+    }
+
+    LUST_TARGET_AVX2 const char* avx2_find_invalid_utf8(const char* begin, const char* end) {
+        __m256i prev_input = _mm256_setzero_si256();
+        __m256i prev_incomplete = _mm256_setzero_si256();
+
+        const char* p = begin;
+        bool has_error = false;
+        for (; end - p >= 32; p += 32) {
+            has_error = avx2_check_utf8_block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), prev_input, prev_incomplete);
+            if (has_error) {
+                break;
+            }
+        }
+
+        if (!has_error) {
+            if (p < end) {
+                // Zero padding is ASCII, a sequence cut by the end fails against it
+                alignas(32) char tail[32] = {};
+                std::memcpy(tail, p, end - p);
+                has_error = avx2_check_utf8_block(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)), prev_input, prev_incomplete);
+            } else {
+                has_error = !_mm256_testz_si256(prev_incomplete, prev_incomplete);
+            }
+        }
+
+        if (!has_error) {
+            return end;
+        }
+
+        // Everything before the previous block is valid, locate the error with the scalar decoder from there
+        const char* const restart = p - begin >= 32 ? p - 32 : begin;
+        return scalar_find_invalid_utf8(utf8_sequence_start(begin, restart), end);
+    }
+
+    constexpr ScanKernels avx2_kernels = {
+        avx2_skip<avx2_space_mask, is_space>,
+        avx2_skip<avx2_digit_mask, is_digit>,
+        avx2_skip<avx2_ident_mask, is_ident_continue>,
+        avx2_find<avx2_line_break_mask, is_line_break>,
+        avx2_find<avx2_quote_or_escape_mask, is_quote_or_escape>,
+        avx2_collect_line_starts,
+        avx2_find_invalid_utf8,
+    };
+#endif // LUST_SIMD_X86_64
+
+    const ScanKernels* kernels_for(SimdLevel level) {
+        switch (level) {
+#if LUST_SIMD_X86_64
+            case SimdLevel::AVX2: return &avx2_kernels;
+            case SimdLevel::SSE2: return &sse2_kernels;
+#endif
+            default: return &scalar_kernels;
+        }
+    }
+
+    std::atomic<SimdLevel> g_level{ detect_simd_level() };
+    std::atomic<const ScanKernels*> g_kernels{ kernels_for(g_level.load()) };
+
+    const ScanKernels& kernels() {
+        return *g_kernels.load(std::memory_order_relaxed);
+    }
+}
+
+    const char* simd_level_to_name(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::SCALAR: return "SCALAR";
+            case SimdLevel::SSE2: return "SSE2";
+            case SimdLevel::AVX2: return "AVX2";
+            default: break;
+        }
+        return "UNKNOWN";
+    }
+
+    SimdLevel detect_simd_level() {
+#if LUST_SIMD_X86_64
+#   if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            if (os_saves_ymm && (info[1] & (1 << 5))) {
+                return SimdLevel::AVX2;
+            }
+        }
+        return SimdLevel::SSE2;
+#   else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#   endif
+#else
+        return SimdLevel::SCALAR;
+#endif
+    }
+
+    SimdLevel get_simd_level() {
+        return g_level.load(std::memory_order_relaxed);
+    }
+
+    void set_simd_level(SimdLevel level) {
+        const SimdLevel supported = detect_simd_level();
+        if (static_cast<uint32_t>(level) > static_cast<uint32_t>(supported)) {
+            level = supported;
+        }
+        g_level.store(level, std::memory_order_relaxed);
+        g_kernels.store(kernels_for(level), std::memory_order_relaxed);
+    }
+
+    const char* skip_char_class(const char* begin, const char* end, uint8_t char_class_mask) {
+        switch (char_class_mask) {
+            case char_class::SPACE: return kernels().skip_space(begin, end);
+            case char_class::DIGIT: return kernels().skip_digit(begin, end);
+            case char_class::IDENT_CONTINUE: return kernels().skip_ident(begin, end);
+            default: break;
+        }
+
+        while (begin < end && char_class::test(*begin, char_class_mask)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    const char* find_line_break(const char* begin, const char* end) {
+        return kernels().find_line_break(begin, end);
+    }
+
+    const char* find_quote_or_escape(const char* begin, const char* end) {
+        return kernels().find_quote_or_escape(begin, end);
+    }
+
+    void collect_line_starts(const char* begin, const char* end, vector<int64_t>& line_starts) {
+        kernels().collect_line_starts(begin, end, line_starts);
+    }
+
+    const char* find_invalid_utf8(const char* begin, const char* end) {
+        return kernels().find_invalid_utf8(begin, end);
+    }
+}
+}
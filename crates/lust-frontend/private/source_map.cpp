@@ -0,0 +1,59 @@
+#include "source_map.hpp"
+#include "simd_scan.hpp"
+
+#include <algorithm>
+
+namespace lust
+{
+namespace lexer
+{
+    SourceMap::SourceMap(std::string_view source)
+        : m_source(source)
+    { }
+
+    std::string_view SourceMap::source() const
+    {
+        return m_source;
+    }
+
+    size_t SourceMap::line_count() const
+    {
+        ensure_built();
+        return m_line_starts.size();
+    }
+
+    int64_t SourceMap::line_start(size_t line_index) const
+    {
+        ensure_built();
+        return m_line_starts[line_index];
+    }
+
+    SourceLoc SourceMap::locate(int64_t pos) const
+    {
+        SourceLoc loc;
+        if (pos < 0 || pos > static_cast<int64_t>(m_source.size())) {
+            return loc;
+        }
+
+        ensure_built();
+
+        // Last line starting at or before `pos`, a '\n' at `pos` starts the next line at pos + 1
+        const int64_t* const line = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), pos) - 1;
+        loc.line = line - m_line_starts.begin() + 1;
+        loc.row = pos - *line + 1;
+        return loc;
+    }
+
+    void SourceMap::ensure_built() const
+    {
+        if (!m_line_starts.empty()) {
+            return;
+        }
+
+        // Source code averages well above 16 bytes per line
+        m_line_starts.reserve(m_source.size() / 16 + 1);
+        m_line_starts.push_back(0);
+        simd::collect_line_starts(m_source.data(), m_source.data() + m_source.size(), m_line_starts);
+    }
+}
+}
@@ -0,0 +1,254 @@
+#include "symbol.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lust
+{
+    namespace
+    {
+        constexpr size_t SHARD_COUNT = 64;
+        constexpr size_t ARENA_BLOCK_SIZE = 64 << 10;
+        constexpr size_t THREAD_CACHE_SIZE = 1024;
+
+        // Segment `i` holds 2^i slots, so 32 of them cover every 32-bit id and never move once allocated
+        constexpr size_t SEGMENT_COUNT = 32;
+
+        uint64_t hash_text(std::string_view text)
+        {
+            const char* p = text.data();
+            size_t n = text.size();
+            uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+
+            while (n >= 8) {
+                uint64_t word;
+                std::memcpy(&word, p, 8);
+                h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+                h ^= h >> 32;
+                p += 8;
+                n -= 8;
+            }
+            if (n > 0) {
+                uint64_t word = 0;
+                std::memcpy(&word, p, n);
+                h = (h ^ word) * 0xC4CEB9FE1A85EC53ull;
+            }
+
+            h ^= h >> 29;
+            h *= 0xBF58476D1CE4E5B9ull;
+            h ^= h >> 32;
+            return h;
+        }
+
+        struct SlotIndex {
+            size_t segment;
+            size_t offset;
+        };
+
+        SlotIndex slot_of(uint32_t id)
+        {
+            const uint64_t n = static_cast<uint64_t>(id) + 1;
+            const size_t segment = std::bit_width(n) - 1;
+            return { segment, static_cast<size_t>(n - (uint64_t(1) << segment)) };
+        }
+
+        struct Entry {
+            // Low half of the hash, the text is only compared when it matches
+            uint32_t hash = 0;
+            // id + 1, 0 is an empty entry
+            uint32_t id_plus_one = 0;
+        };
+
+        struct alignas(64) Shard {
+            std::mutex mutex;
+
+            // Open addressing with linear probing, the capacity is a power of two kept at most half full
+            std::vector<Entry> entries = std::vector<Entry>(64);
+            size_t count = 0;
+
+            // Interned text is bump-allocated, the blocks never move so the views stay valid
+            std::vector<std::unique_ptr<char[]>> blocks;
+            char* block_cursor = nullptr;
+            size_t block_left = 0;
+
+            std::string_view store(std::string_view text)
+            {
+                if (text.empty()) {
+                    return {};
+                }
+
+                if (text.size() > block_left) {
+                    // Long strings get a block of their own instead of wasting the rest of the current one
+                    if (text.size() > ARENA_BLOCK_SIZE / 4) {
+                        blocks.emplace_back(new char[text.size()]);
+                        std::memcpy(blocks.back().get(), text.data(), text.size());
+                        return { blocks.back().get(), text.size() };
+                    }
+                    blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+                    block_cursor = blocks.back().get();
+                    block_left = ARENA_BLOCK_SIZE;
+                }
+
+                std::memcpy(block_cursor, text.data(), text.size());
+                const std::string_view stored(block_cursor, text.size());
+                block_cursor += text.size();
+                block_left -= text.size();
+                return stored;
+            }
+
+            void grow()
+            {
+                std::vector<Entry> old = std::move(entries);
+                entries = std::vector<Entry>(old.size() * 2);
+                const size_t mask = entries.size() - 1;
+                for (const Entry& entry : old) {
+                    if (entry.id_plus_one == 0) {
+                        continue;
+                    }
+                    size_t index = entry.hash & mask;
+                    while (entries[index].id_plus_one != 0) {
+                        index = (index + 1) & mask;
+                    }
+                    entries[index] = entry;
+                }
+            }
+        };
+
+        // Recently interned symbols of the current thread, hits skip the shard lock entirely
+        struct CacheEntry {
+            uint64_t table_serial = 0;
+            uint64_t hash = 0;
+            uint32_t id = 0;
+        };
+
+        thread_local std::array<CacheEntry, THREAD_CACHE_SIZE> t_cache{};
+
+        // Tables are told apart by serial rather than address, a new table may reuse a freed one's address
+        std::atomic<uint64_t> g_next_table_serial{ 1 };
+    }
+
+    struct SymbolTable::Impl {
+        const uint64_t serial = g_next_table_serial.fetch_add(1, std::memory_order_relaxed);
+        std::array<Shard, SHARD_COUNT> shards;
+        std::atomic<uint32_t> next_id{ 0 };
+        std::array<std::atomic<std::string_view*>, SEGMENT_COUNT> segments{};
+
+        std::string_view* segment_for_write(size_t segment)
+        {
+            std::string_view* slots = segments[segment].load(std::memory_order_acquire);
+            if (slots != nullptr) {
+                return slots;
+            }
+
+            // Two shards may race for a new segment, the loser frees its allocation
+            std::string_view* fresh = new std::string_view[size_t(1) << segment];
+            if (segments[segment].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return fresh;
+            }
+            delete[] fresh;
+            return slots;
+        }
+
+        std::string_view text_of(uint32_t id) const
+        {
+            const SlotIndex slot = slot_of(id);
+            return segments[slot.segment].load(std::memory_order_acquire)[slot.offset];
+        }
+    };
+
+    SymbolTable::SymbolTable()
+        : m_impl(new Impl())
+    {
+        intern(std::string_view());
+    }
+
+    SymbolTable::~SymbolTable()
+    {
+        for (std::atomic<std::string_view*>& segment : m_impl->segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+        delete m_impl;
+    }
+
+    SymbolTable& SymbolTable::global()
+    {
+        // Never destroyed, symbols may still be resolved from other static destructors
+        static SymbolTable* table = new SymbolTable();
+        return *table;
+    }
+
+    SymbolTable& SymbolTable::literals()
+    {
+        static SymbolTable* table = new SymbolTable();
+        return *table;
+    }
+
+    Symbol SymbolTable::intern(std::string_view text)
+    {
+        const uint64_t hash = hash_text(text);
+
+        // A cached id was published to this thread before, its slot is readable without the lock
+        CacheEntry& cached = t_cache[hash % THREAD_CACHE_SIZE];
+        if (cached.table_serial == m_impl->serial && cached.hash == hash && m_impl->text_of(cached.id) == text) {
+            return { cached.id };
+        }
+
+        Shard& shard = m_impl->shards[hash >> 58];
+        const uint32_t hash_low = static_cast<uint32_t>(hash);
+        uint32_t id;
+        {
+            std::lock_guard lock(shard.mutex);
+
+            const size_t mask = shard.entries.size() - 1;
+            size_t index = hash_low & mask;
+            for (; shard.entries[index].id_plus_one != 0; index = (index + 1) & mask) {
+                const Entry& entry = shard.entries[index];
+                if (entry.hash == hash_low && m_impl->text_of(entry.id_plus_one - 1) == text) {
+                    cached = { m_impl->serial, hash, entry.id_plus_one - 1 };
+                    return { entry.id_plus_one - 1 };
+                }
+            }
+
+            id = m_impl->next_id.fetch_add(1, std::memory_order_relaxed);
+            assert(id != UINT32_MAX && "Symbol table is full");
+
+            // The slot is written before the id is published, either by returning it or through the shard under the lock
+            const SlotIndex slot = slot_of(id);
+            m_impl->segment_for_write(slot.segment)[slot.offset] = shard.store(text);
+
+            shard.entries[index] = { hash_low, id + 1 };
+            if (++shard.count * 2 > shard.entries.size()) {
+                shard.grow();
+            }
+        }
+
+        cached = { m_impl->serial, hash, id };
+        return { id };
+    }
+
+    std::string_view SymbolTable::resolve(Symbol symbol) const
+    {
+        return m_impl->text_of(symbol.id);
+    }
+
+    size_t SymbolTable::size() const
+    {
+        return m_impl->next_id.load(std::memory_order_relaxed);
+    }
+
+    std::string_view Symbol::str() const
+    {
+        return SymbolTable::global().resolve(*this);
+    }
+
+    Symbol intern(std::string_view text)
+    {
+        return SymbolTable::global().intern(text);
+    }
+}
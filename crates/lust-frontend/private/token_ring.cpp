@@ -0,0 +1,183 @@
+#include "token_ring.hpp"
+
+#include <algorithm>
+
+namespace lust
+{
+namespace lexer
+{
+    static_assert((TokenRing::CAPACITY & (TokenRing::CAPACITY - 1)) == 0, "Ring capacity must be a power of two");
+
+    TokenRing::TokenRing(TokenStream& token_stream)
+        : m_token_stream(&token_stream)
+        , m_is_streaming(token_stream->is_streaming())
+    { }
+
+    TokenRing::TokenRing(const TokenBuffer& token_buffer)
+        : m_token_buffer(&token_buffer)
+    { }
+
+    const Token& TokenRing::peek(size_t n)
+    {
+        if (n >= m_count) {
+            fill(n + 1);
+            if (n >= m_count) {
+                return m_end_token;
+            }
+        }
+        return m_tokens[(m_head + n) & (CAPACITY - 1)];
+    }
+
+    Token TokenRing::consume()
+    {
+        if (m_count == 0) {
+            fill(1);
+            if (m_count == 0) {
+                return m_end_token;
+            }
+        }
+
+        const Token token = m_tokens[m_head];
+        m_head = (m_head + 1) & (CAPACITY - 1);
+        --m_count;
+        ++m_retained;
+        ++m_consumed;
+        return token;
+    }
+
+    TokenRing::Checkpoint TokenRing::checkpoint()
+    {
+        peek(0);
+        return { m_consumed, m_count > 0 ? m_states[m_head] : m_end_state };
+    }
+
+    bool TokenRing::rollback(const Checkpoint& checkpoint)
+    {
+        const uint64_t distance = m_consumed - checkpoint.consumed;
+        if (distance <= m_retained) {
+            m_head = (m_head - distance) & (CAPACITY - 1);
+            m_count += distance;
+            m_retained -= distance;
+            m_consumed = checkpoint.consumed;
+            return true;
+        }
+
+        if (m_token_buffer) {
+            m_buffer_index = checkpoint.state.pos;
+        } else if (!(*m_token_stream)->restore_state(checkpoint.state)) {
+            return false;
+        }
+
+        m_head = 0;
+        m_count = 0;
+        m_retained = 0;
+        m_consumed = checkpoint.consumed;
+        m_last_pulled_type = checkpoint.state.previous_token_type;
+        m_end_pulled = false;
+        return true;
+    }
+
+    std::string_view TokenRing::source_text() const
+    {
+        return m_token_buffer ? m_token_buffer->source() : (*m_token_stream)->original_text();
+    }
+
+    int64_t TokenRing::source_text_offset() const
+    {
+        return m_token_buffer ? 0 : (*m_token_stream)->original_text_offset();
+    }
+
+    void TokenRing::fill(size_t wanted)
+    {
+        wanted = std::min(wanted, CAPACITY);
+
+        // Always fill every free slot, a batch costs one call into the source however many tokens it brings
+        while (m_count < wanted && !m_end_pulled) {
+            const size_t tail = (m_head + m_count) & (CAPACITY - 1);
+            const size_t free_span = std::min(CAPACITY - m_count, CAPACITY - tail);
+            Token* const span = m_tokens + tail;
+            TokenizerState* const states = m_states + tail;
+
+            const size_t pulled = pull(span, states, free_span);
+
+            // The span starts right after the tokens in use, it overwrites the oldest retained ones first
+            m_retained = std::min(m_retained, CAPACITY - m_count - pulled);
+
+            // Comments are dropped in place
+            size_t kept = 0;
+            for (size_t i = 0; i < pulled; ++i) {
+                if (span[i].type == TerminalTokenType::COMMENTVAL) {
+                    continue;
+                }
+                if (span[i].type == TerminalTokenType::END) {
+                    m_end_pulled = true;
+                    m_end_token = span[i];
+                    m_end_state = states[i];
+                }
+                states[kept] = states[i];
+                span[kept++] = span[i];
+            }
+            m_count += kept;
+        }
+    }
+
+    size_t TokenRing::pull(Token* out, TokenizerState* states, size_t max_count)
+    {
+        size_t count = 0;
+
+        if (m_is_streaming) {
+            // A batch would outrun the window, the first values would be gone before it returns
+            while (count < max_count) {
+                out[count] = (*m_token_stream)->next_token();
+                keep_value(out[count]);
+                states[count] = { token_start(out[count].type, out[count].pos), m_last_pulled_type };
+                m_last_pulled_type = out[count].type;
+                if (out[count++].type == TerminalTokenType::END) {
+                    break;
+                }
+            }
+            return count;
+        }
+
+        if (m_token_stream) {
+            count = (*m_token_stream)->next_tokens(out, max_count);
+            // Lexing again from a token's first char, knowing the token before it, gives the same tokens
+            for (size_t i = 0; i < count; ++i) {
+                states[i] = { token_start(out[i].type, out[i].pos), m_last_pulled_type };
+                m_last_pulled_type = out[i].type;
+            }
+            return count;
+        }
+
+        const size_t size = m_token_buffer->size();
+        while (count < max_count) {
+            states[count] = { static_cast<int64_t>(m_buffer_index), m_last_pulled_type };
+
+            // A buffer ending with an ERROR has no END
+            if (m_buffer_index >= size) {
+                out[count++] = { TerminalTokenType::END, {}, {}, static_cast<int64_t>(m_token_buffer->source().size()) };
+                break;
+            }
+
+            out[count] = m_token_buffer->token_at(m_buffer_index++);
+            m_last_pulled_type = out[count].type;
+            if (out[count++].type == TerminalTokenType::END) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    void TokenRing::keep_value(Token& token)
+    {
+        if (token.type == TerminalTokenType::IDENT) {
+            token.value = token.symbol.str();
+        } else if (token.type == TerminalTokenType::STRING) {
+            if (!m_stream_literals) {
+                m_stream_literals = make_unique<SymbolTable>();
+            }
+            token.value = m_stream_literals->intern_text(token.value);
+        }
+    }
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace lust
+{
+namespace char_class
+{
+    // Class bits of a byte, a byte may belong to several classes
+    constexpr uint8_t SPACE = 1 << 0;
+    constexpr uint8_t DIGIT = 1 << 1;
+    // ASCII letters and every byte of a multi-byte UTF-8 sequence
+    constexpr uint8_t ALPHA = 1 << 2;
+    // ASCII only, non-ASCII identifiers are classified by code point, see utf8::is_xid_start()
+    constexpr uint8_t IDENT_START = 1 << 3;
+    constexpr uint8_t IDENT_CONTINUE = 1 << 4;
+
+    /**
+     * @brief Locale independent classification of every byte, built at compile time
+     */
+    inline constexpr std::array<uint8_t, 256> table = [] {
+        std::array<uint8_t, 256> t{};
+
+        for (unsigned c : { ' ', '\t', '\n', '\v', '\f', '\r' }) {
+            t[c] |= SPACE;
+        }
+        for (unsigned c = '0'; c <= '9'; ++c) {
+            t[c] |= DIGIT | IDENT_CONTINUE;
+        }
+        for (unsigned c = 'a'; c <= 'z'; ++c) {
+            t[c] |= ALPHA | IDENT_START | IDENT_CONTINUE;
+            t[c - 'a' + 'A'] |= ALPHA | IDENT_START | IDENT_CONTINUE;
+        }
+        for (unsigned c = 0x80; c <= 0xFF; ++c) {
+            t[c] |= ALPHA;
+        }
+        t['_'] |= IDENT_START | IDENT_CONTINUE;
+
+        return t;
+    }();
+
+    constexpr bool test(char c, uint8_t class_mask) {
+        return (table[static_cast<unsigned char>(c)] & class_mask) != 0;
+    }
+}
+
+    constexpr bool is_space(char c) {
+        return char_class::test(c, char_class::SPACE);
+    }
+
+    constexpr bool is_digit(char c) {
+        return char_class::test(c, char_class::DIGIT);
+    }
+
+    constexpr bool is_alpha(char c) {
+        return char_class::test(c, char_class::ALPHA);
+    }
+
+    constexpr bool is_alnum(char c) {
+        return char_class::test(c, char_class::ALPHA | char_class::DIGIT);
+    }
+
+    constexpr bool is_ident_start(char c) {
+        return char_class::test(c, char_class::IDENT_START);
+    }
+
+    constexpr bool is_ident_continue(char c) {
+        return char_class::test(c, char_class::IDENT_CONTINUE);
+    }
+}
@@ -1,13 +1,15 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
 #include <ostream>
 
 namespace lust
 {
     // Small String Optimization on stack(also can be data segment and so on) memory size
-    // Notice it memory usage will be SSO_BUFFER_SIZE + 1 because we need space to store '\0'
-    constexpr size_t SSO_BUFFER_SIZE = 15;
+    // Notice it memory usage will be SSO_BUFFER_SIZE + 1 because we need space to store '\0',
+    // the last byte of the string holds the inline length, 22 chars on 64-bit
+    constexpr size_t SSO_BUFFER_SIZE = 3 * sizeof(void*) - 2;
 
     class LUSTFRONTEND_API simple_string {
     public:
@@ -27,20 +29,36 @@ namespace lust
         bool operator==(const char* other) const noexcept;
         bool operator!=(const char* other) const noexcept;
 
-        virtual ~simple_string();
+        ~simple_string();
 
         bool is_empty() const noexcept;
         void swap(simple_string& other);
 
-        operator std::string_view() noexcept;
+        operator std::string_view() const noexcept;
         operator const char*() const noexcept;
         operator char*() noexcept;
 
         char* data();
         const char* data() const;
-        size_t length();
+        size_t length() const noexcept;
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+
+        /**
+         * @brief Make room for `new_length` chars, growing at least geometrically so appends are amortized O(1)
+         */
         void ensure_capacity(size_t new_length);
 
+        /**
+         * @brief Make room for exactly `new_capacity` chars, no-op if there is already enough
+         */
+        void reserve(size_t new_capacity);
+
+        /**
+         * @brief Empty the string, the allocated buffer is kept
+         */
+        void clear() noexcept;
+
         simple_string& append(const char* s);
         simple_string& append(std::string_view s);
 
@@ -49,18 +67,35 @@ namespace lust
         simple_string& operator+=(const simple_string& other);
 
     private:
+        struct heap_rep {
+            char* data; // allocated by memory allocator
+            size_t length;
+            size_t capacity; // encoded with the heap flag, see `set_heap`
+        };
+
+        struct inline_rep {
+            char data[SSO_BUFFER_SIZE + 1];
+            uint8_t length;
+        };
+
+        // Both layouts end on the same byte, its highest bit tells which one is in use
         union {
-            char m_ss_buffer[SSO_BUFFER_SIZE + 1]; // internal buffer
-            char* m_heap_data; // allocated by memory allocator
+            heap_rep m_heap;
+            inline_rep m_inline;
         };
-        size_t m_length = 0;
-        size_t m_capacity = SSO_BUFFER_SIZE;
-        bool m_is_heap = false;
+
+        bool is_heap() const noexcept;
+        void set_length(size_t len) noexcept;
+        void set_heap(char* data, size_t len, size_t capacity) noexcept;
+        void set_inline_empty() noexcept;
+        void reallocate(size_t new_capacity);
 
         void set_data(const char* s, size_t len);
 
     };
 
+    static_assert(sizeof(simple_string) == 3 * sizeof(void*), "simple_string should be three words, no vtable");
+
     inline std::ostream& operator<<(std::ostream& os, const lust::simple_string& str) {
         if (!str.is_empty()) {
             os << str.operator const char *();
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lust
+{
+    /**
+     * Layout and read access of a list holding up to N elements in place, the inline slots share their bytes
+     * with the pointer to the spilled storage. The derived list decides where it spills and owns the elements.
+     */
+    template <typename T, size_t N>
+    class small_vector_storage {
+    public:
+        bool empty() const noexcept { return m_size == 0; }
+        size_t size() const noexcept { return m_size; }
+        size_t capacity() const noexcept { return m_capacity; }
+        bool is_inline() const noexcept { return m_capacity == N; }
+
+        T* data() noexcept { return is_inline() ? reinterpret_cast<T*>(m_inline) : m_heap; }
+        const T* data() const noexcept { return is_inline() ? reinterpret_cast<const T*>(m_inline) : m_heap; }
+
+        T& operator[](size_t pos) { return data()[pos]; }
+        const T& operator[](size_t pos) const { return data()[pos]; }
+        T& front() { return data()[0]; }
+        const T& front() const { return data()[0]; }
+        T& back() { return data()[m_size - 1]; }
+        const T& back() const { return data()[m_size - 1]; }
+
+        T* begin() noexcept { return data(); }
+        T* end() noexcept { return data() + m_size; }
+        const T* begin() const noexcept { return data(); }
+        const T* end() const noexcept { return data() + m_size; }
+
+    protected:
+        small_vector_storage() noexcept = default;
+
+        uint32_t m_size = 0;
+        uint32_t m_capacity = N;
+        union {
+            T* m_heap;
+            alignas(T) unsigned char m_inline[N == 0 ? 1 : N * sizeof(T)];
+        };
+    };
+
+    /**
+     * A vector holding up to N elements in place, for lists that are almost always tiny.
+     * A vector has spilled to the heap when its capacity exceeds N.
+     * Header only, every operation is inline.
+     */
+    template <typename T, size_t N>
+    class small_vector : public small_vector_storage<T, N> {
+        static_assert(N > 0, "Use lust::vector without inline storage");
+
+        using small_vector_storage<T, N>::m_size;
+        using small_vector_storage<T, N>::m_capacity;
+        using small_vector_storage<T, N>::m_heap;
+        using small_vector_storage<T, N>::m_inline;
+
+    public:
+        using small_vector_storage<T, N>::data;
+        using small_vector_storage<T, N>::begin;
+        using small_vector_storage<T, N>::end;
+        using small_vector_storage<T, N>::is_inline;
+
+        small_vector() noexcept = default;
+
+        small_vector(const small_vector& other) requires std::is_copy_constructible_v<T> {
+            reserve(other.m_size);
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            m_size = other.m_size;
+        }
+
+        small_vector(small_vector&& other) noexcept {
+            take(std::move(other));
+        }
+
+        small_vector& operator=(const small_vector& other) requires std::is_copy_constructible_v<T> {
+            if (this != &other) {
+                small_vector(other).swap(*this);
+            }
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept {
+            if (this != &other) {
+                release();
+                take(std::move(other));
+            }
+            return *this;
+        }
+
+        ~small_vector() {
+            release();
+        }
+
+        void push_back(const T& value) requires std::is_copy_constructible_v<T> {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            if (m_size == m_capacity) {
+                // The arguments may refer to an element of this vector
+                T value(std::forward<Args>(args)...);
+                grow(m_size + 1);
+                ::new (static_cast<void*>(data() + m_size)) T(std::move(value));
+            } else {
+                ::new (static_cast<void*>(data() + m_size)) T(std::forward<Args>(args)...);
+            }
+            ++m_size;
+        }
+
+        void pop_back() {
+            std::destroy_at(data() + --m_size);
+        }
+
+        void clear() {
+            std::destroy(begin(), end());
+            m_size = 0;
+        }
+
+        void reserve(size_t new_cap) {
+            if (new_cap > m_capacity) {
+                grow(new_cap);
+            }
+        }
+
+        void swap(small_vector& other) noexcept {
+            small_vector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+    private:
+        void grow(size_t min_capacity) {
+            const size_t new_capacity = std::max<size_t>(min_capacity, size_t(m_capacity) * 2);
+            T* new_data = std::allocator<T>().allocate(new_capacity);
+            T* old_data = data();
+            std::uninitialized_move(old_data, old_data + m_size, new_data);
+            std::destroy(old_data, old_data + m_size);
+            if (!is_inline()) {
+                std::allocator<T>().deallocate(m_heap, m_capacity);
+            }
+            m_heap = new_data;
+            m_capacity = static_cast<uint32_t>(new_capacity);
+        }
+
+        void release() noexcept {
+            clear();
+            if (!is_inline()) {
+                std::allocator<T>().deallocate(m_heap, m_capacity);
+                m_capacity = N;
+            }
+        }
+
+        // `*this` is empty and inline
+        void take(small_vector&& other) noexcept {
+            if (other.is_inline()) {
+                std::uninitialized_move(other.begin(), other.end(), reinterpret_cast<T*>(m_inline));
+                m_size = other.m_size;
+                other.clear();
+            } else {
+                m_heap = other.m_heap;
+                m_size = other.m_size;
+                m_capacity = other.m_capacity;
+                other.m_size = 0;
+                other.m_capacity = N;
+            }
+        }
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lust/container/simple_string.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace lust
+{
+    // Formats text into one growing buffer, the buffer is kept across builds so formatting in a loop stops allocating
+    class LUSTFRONTEND_API string_builder {
+    public:
+        string_builder() = default;
+        explicit string_builder(size_t initial_capacity);
+
+        string_builder& append(std::string_view s);
+        string_builder& append(const char* s);
+        string_builder& append(const simple_string& s);
+        string_builder& append(char c);
+        string_builder& append(int64_t value);
+        string_builder& append(uint64_t value);
+
+        template <typename T>
+        string_builder& operator<<(const T& value) {
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>) {
+                if constexpr (std::is_signed_v<T>) {
+                    return append(static_cast<int64_t>(value));
+                } else {
+                    return append(static_cast<uint64_t>(value));
+                }
+            } else {
+                return append(value);
+            }
+        }
+
+        /**
+         * @brief The text built so far, invalidated by the next append
+         */
+        std::string_view view() const noexcept;
+        size_t size() const noexcept;
+        bool is_empty() const noexcept;
+
+        /**
+         * @brief Copy the text out and start over, the buffer is reused by the next build
+         */
+        simple_string build();
+
+        /**
+         * @brief Start over without copying the text out
+         */
+        void clear() noexcept;
+
+    private:
+        simple_string m_buffer;
+    };
+}
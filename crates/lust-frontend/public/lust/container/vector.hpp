@@ -1,57 +1,128 @@
 #pragma once
 
 #include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace lust
 {
+    /**
+     * The layout is part of the ABI: a pointer to `capacity` slots, the first `size` of which hold elements.
+     * A default constructed vector owns no memory. Element access and appending with spare capacity are inline,
+     * allocation and destruction of elements live in the library, see the instantiations in vector.cpp.
+     */
     template <typename T>
     class LUSTFRONTEND_API vector {
     public:
         // 构造函数和析构函数
-        vector();
-        vector(const vector& other);
-        vector(vector&& other) noexcept;
-        vector& operator=(const vector& other);
-        vector& operator=(vector&& other) noexcept;
-        ~vector();
+        vector() noexcept = default;
+        vector(const vector& other) requires std::is_copy_constructible_v<T>;
+        vector(vector&& other) noexcept
+            : m_data(other.m_data)
+            , m_size(other.m_size)
+            , m_capacity(other.m_capacity)
+        {
+            other.m_data = nullptr;
+            other.m_size = 0;
+            other.m_capacity = 0;
+        }
+        vector& operator=(const vector& other) requires std::is_copy_constructible_v<T>;
+        vector& operator=(vector&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+        ~vector() {
+            if (m_data) {
+                release();
+            }
+        }
 
         // 容量相关
-        bool empty() const;
-        size_t size() const;
+        bool empty() const noexcept { return m_size == 0; }
+        size_t size() const noexcept { return m_size; }
         void resize(size_t count);
         void reserve(size_t new_cap);
-        size_t capacity() const;
+        size_t capacity() const noexcept { return m_capacity; }
         void clear();
 
         // 元素访问
-        T& operator[](size_t pos);
-        const T& operator[](size_t pos) const;
+        T& operator[](size_t pos) { return m_data[pos]; }
+        const T& operator[](size_t pos) const { return m_data[pos]; }
         T& at(size_t pos);
         const T& at(size_t pos) const;
-        T& front();
-        const T& front() const;
-        T& back();
-        const T& back() const;
+        T& front() { return m_data[0]; }
+        const T& front() const { return m_data[0]; }
+        T& back() { return m_data[m_size - 1]; }
+        const T& back() const { return m_data[m_size - 1]; }
+        T* data() noexcept { return m_data; }
+        const T* data() const noexcept { return m_data; }
 
         // 修改器
-        void push_back(const T& value);
-        void push_back(T&& value);
+        void push_back(const T& value) requires std::is_copy_constructible_v<T> {
+            if (m_size == m_capacity) {
+                // `value` may live in this vector
+                T copy(value);
+                grow(m_size + 1);
+                ::new (static_cast<void*>(m_data + m_size)) T(std::move(copy));
+            } else {
+                ::new (static_cast<void*>(m_data + m_size)) T(value);
+            }
+            ++m_size;
+        }
+        void push_back(T&& value) {
+            if (m_size == m_capacity) {
+                T moved(std::move(value));
+                grow(m_size + 1);
+                ::new (static_cast<void*>(m_data + m_size)) T(std::move(moved));
+            } else {
+                ::new (static_cast<void*>(m_data + m_size)) T(std::move(value));
+            }
+            ++m_size;
+        }
         void pop_back();
         template <typename... Args>
-        void emplace_back(Args&&... args);
+        void emplace_back(Args&&... args) {
+            if (m_size == m_capacity) {
+                T value(std::forward<Args>(args)...);
+                grow(m_size + 1);
+                ::new (static_cast<void*>(m_data + m_size)) T(std::move(value));
+            } else {
+                ::new (static_cast<void*>(m_data + m_size)) T(std::forward<Args>(args)...);
+            }
+            ++m_size;
+        }
         void extend(vector&& other);
+        void swap(vector& other) noexcept {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
+        }
 
         // 迭代器
-        const T* begin() const;
-        const T* end() const;         
-        T* begin();
-        T* end();
+        const T* begin() const noexcept { return m_data; }
+        const T* end() const noexcept { return m_data + m_size; }
+        T* begin() noexcept { return m_data; }
+        T* end() noexcept { return m_data + m_size; }
 
         // 工具函数
-        vector<T> slice(size_t begin_pos, size_t end_pos) const;
+        vector<T> slice(size_t begin_pos, size_t end_pos) const requires std::is_copy_constructible_v<T>;
 
     private:
-        class Impl;  // 声明一个私有的实现类
-        Impl* pimpl; // 实现指针
+        T* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_capacity = 0;
+
+        /**
+         * @brief Reallocate to hold at least `min_capacity` elements, at least doubling the capacity
+         */
+        void grow(size_t min_capacity);
+
+        /**
+         * @brief Destroy the elements and free the storage
+         */
+        void release() noexcept;
     };
+
+    static_assert(sizeof(vector<int>) == 3 * sizeof(void*), "vector layout is pointer, size, capacity");
 }
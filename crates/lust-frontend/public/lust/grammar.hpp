@@ -1,9 +1,10 @@
 #pragma once
 
+#include <type_traits>
 #include "container/simple_string.hpp"
-#include "container/unique_ptr.hpp"
 #include "container/vector.hpp"
 #include "lustfrontend_export.h"
+#include "grammar/ast_arena.hpp"
 #include "grammar/qualified_name.hpp"
 
 namespace lust
@@ -64,13 +65,56 @@ namespace grammar
         PUBLIC = 3,
     };
 
-    struct LUSTFRONTEND_API IASTNode {
+    struct IASTNode;
+
+    /**
+     * Non-owning reference to the callable given to IASTNode::for_each_child(), two words and never allocates.
+     * The callable only has to outlive the call it's passed to. Null children are skipped.
+     */
+    class ChildCallback {
     public:
-        virtual ~IASTNode();
+        template <typename Fn> requires (!std::is_same_v<std::remove_cvref_t<Fn>, ChildCallback>)
+        ChildCallback(Fn&& fn) noexcept
+            : m_context(const_cast<void*>(static_cast<const void*>(&fn)))
+            , m_invoke([] (void* context, const IASTNode* child) { (*static_cast<std::remove_reference_t<Fn>*>(context))(child); })
+        {}
+
+        void operator()(const IASTNode* child) const {
+            if (child) {
+                m_invoke(m_context, child);
+            }
+        }
 
+        template <typename T>
+        void operator()(const AstPtr<T>& child) const {
+            (*this)(child.get());
+        }
+
+        template <typename T, size_t N>
+        void operator()(const AstList<AstPtr<T>, N>& children) const {
+            for (const AstPtr<T>& child : children) {
+                (*this)(child.get());
+            }
+        }
+
+    private:
+        void* m_context;
+        void (*m_invoke)(void* context, const IASTNode* child);
+    };
+
+    // Nodes live in an AstArena and are never destroyed, every node type is trivially destructible
+    struct LUSTFRONTEND_API IASTNode {
+    public:
         virtual GrammarRule get_type() const = 0;
 
-        virtual vector<const IASTNode*> collect_self_nodes() const;
+        /**
+         * @brief Call `callback` on each child in source order, without allocating
+         */
+        virtual void for_each_child(ChildCallback callback) const;
+        /**
+         * @brief The children gathered into a vector, allocates. Walks should use for_each_child() or ASTVisitor
+         */
+        vector<const IASTNode*> collect_self_nodes() const;
         virtual simple_string get_name() const;
     };
 
@@ -88,127 +132,127 @@ namespace grammar
     };
 
     struct ASTNode_ParamDecl : public ASTBaseNode<GrammarRule::PARAMETER> {
-        UniquePtr<ASTNode_TypeExpr> type;
-        simple_string identifier;
+        AstPtr<ASTNode_TypeExpr> type;
+        Symbol identifier;
 
         bool is_instance_function = false;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_ParamList : public ASTBaseNode<GrammarRule::PARAMETERS_LIST> {
-        vector<UniquePtr<ASTNode_ParamDecl>> params;
+        AstList<AstPtr<ASTNode_ParamDecl>, 2> params;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_InvokeParameters : public ASTBaseNode<GrammarRule::INVOKE_PARAMETERS> {
-        vector<UniquePtr<ASTNode_Expr>> parameter_expressions;
+        AstList<AstPtr<ASTNode_Expr>> parameter_expressions;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_Attribute : public ASTBaseNode<GrammarRule::ATTRIBUTE> {
         QualifiedName name;
-        vector<simple_string> args;
+        AstList<Symbol, 2> args;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_GenericParam : public ASTBaseNode<GrammarRule::GENERIC_PARAM> {
-        vector<UniquePtr<ASTNode_TypeExpr>> types;
-        vector<QualifiedName> constraints;
+        AstList<AstPtr<ASTNode_TypeExpr>> types;
+        AstList<QualifiedName, 1> constraints;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_Statement : public ASTBaseNode<GrammarRule::STATEMENT> {
-        vector<UniquePtr<ASTNode_Attribute>> attributes{};
+        AstList<AstPtr<ASTNode_Attribute>> attributes{};
         Visibility visibility;
         bool is_end_with_semicolon = true;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
         simple_string get_name() const override;
     };
 
     struct ASTNode_NamedStatement : public ASTBaseNode<GrammarRule::NAMED_STATEMENT, ASTNode_Statement> {
-        simple_string identifier;
+        Symbol identifier;
     };
 
     struct ASTNode_ExprStatement : public ASTBaseNode<GrammarRule::EXPR_STATEMENT, ASTNode_Statement> {
-        UniquePtr<ASTNode_Expr> expression;
+        AstPtr<ASTNode_Expr> expression;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_Program : public ASTBaseNode<GrammarRule::PROGRAM> {
-        vector<UniquePtr<ASTNode_Attribute>> attributes{};
-        vector<UniquePtr<ASTNode_Statement>> statements{};
+        AstList<AstPtr<ASTNode_Attribute>> attributes{};
+        AstList<AstPtr<ASTNode_Statement>> statements{};
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_VarDecl : public ASTBaseNode<GrammarRule::VAR_DECL, ASTNode_Statement> {
-        UniquePtr<ASTNode_TypeExpr> specified_type;
-        UniquePtr<ASTNode_Operator> evaluate_expression;
+        AstPtr<ASTNode_TypeExpr> specified_type;
+        AstPtr<ASTNode_Operator> evaluate_expression;
         bool is_forward_decl_only = false;
         bool is_mutable = false;
         bool is_const = false;
-        simple_string identifier;
+        Symbol identifier;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_FunctionDecl : public ASTBaseNode<GrammarRule::FUNCTION_DECL, ASTNode_NamedStatement> {
         bool is_async = false;
-        vector<UniquePtr<ASTNode_GenericParam>> generic_params;
-        UniquePtr<ASTNode_ParamList> params;
-        UniquePtr<ASTNode_TypeExpr> ret_type;
-        UniquePtr<ASTNode_Block> body;
+        AstList<AstPtr<ASTNode_GenericParam>> generic_params;
+        AstPtr<ASTNode_ParamList> params;
+        AstPtr<ASTNode_TypeExpr> ret_type;
+        AstPtr<ASTNode_Block> body;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_Block : public ASTBaseNode<GrammarRule::BLOCK, ASTNode_Statement> {
-        vector<UniquePtr<ASTNode_Statement>> statements{};
+        AstList<AstPtr<ASTNode_Statement>> statements{};
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_StructField : public ASTBaseNode<GrammarRule::STRUCT_FIELD, ASTNode_NamedStatement> {
         bool is_field_mutable = false;
-        UniquePtr<ASTNode_TypeExpr> field_type;
+        AstPtr<ASTNode_TypeExpr> field_type;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_StructDecl : public ASTBaseNode<GrammarRule::STRUCT, ASTNode_NamedStatement> {
-        vector<UniquePtr<ASTNode_StructField>> fields{};
-        vector<UniquePtr<ASTNode_GenericParam>> generic_params;
+        AstList<AstPtr<ASTNode_StructField>> fields{};
+        AstList<AstPtr<ASTNode_GenericParam>> generic_params;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_MorphismsType : public ASTBaseNode<GrammarRule::MORPHISMS_TYPE, ASTNode_NamedStatement> {
-        UniquePtr<ASTNode_TypeExpr> value;
+        AstPtr<ASTNode_TypeExpr> value;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_MorphismsConstant : public ASTBaseNode<GrammarRule::MORPHISMS_CONSTANT, ASTNode_NamedStatement> {
-        UniquePtr<ASTNode_TypeExpr> type;
-        UniquePtr<ASTNode_Expr> value;
+        AstPtr<ASTNode_TypeExpr> type;
+        AstPtr<ASTNode_Expr> value;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_TraitDecl : public ASTBaseNode<GrammarRule::TRAIT, ASTNode_NamedStatement> {
-        vector<UniquePtr<ASTNode_GenericParam>> generic_params;
-        vector<UniquePtr<ASTNode_MorphismsType>> morphisms_types;
-        vector<UniquePtr<ASTNode_MorphismsConstant>> morphisms_constants;
-        vector<UniquePtr<ASTNode_FunctionDecl>> functions;
+        AstList<AstPtr<ASTNode_GenericParam>> generic_params;
+        AstList<AstPtr<ASTNode_MorphismsType>> morphisms_types;
+        AstList<AstPtr<ASTNode_MorphismsConstant>> morphisms_constants;
+        AstList<AstPtr<ASTNode_FunctionDecl>> functions;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     template <typename T>
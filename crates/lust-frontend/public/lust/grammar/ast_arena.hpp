@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "lust/container/small_vector.hpp"
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+namespace grammar
+{
+    template <typename T>
+    class AstPtr;
+
+    /**
+     * Bump allocator owning every node of a tree and the storage of its child lists.
+     * Objects in the arena are never destroyed one by one, freeing the arena releases its blocks in one pass.
+     * A mark taken before a speculative parse gives back everything allocated after it.
+     */
+    class LUSTFRONTEND_API AstArena {
+    public:
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        struct Mark {
+            void* block = nullptr;
+            char* cursor = nullptr;
+        };
+
+        AstArena() noexcept = default;
+        AstArena(AstArena&& other) noexcept;
+        AstArena& operator=(AstArena&& other) noexcept;
+        AstArena(const AstArena&) = delete;
+        AstArena& operator=(const AstArena&) = delete;
+        ~AstArena();
+
+        void* allocate(size_t size, size_t alignment) {
+            const uintptr_t cursor = reinterpret_cast<uintptr_t>(m_cursor);
+            const uintptr_t aligned = (cursor + alignment - 1) & ~(uintptr_t(alignment) - 1);
+            if (m_cursor && aligned + size <= reinterpret_cast<uintptr_t>(m_end)) {
+                m_cursor = reinterpret_cast<char*>(aligned + size);
+                return reinterpret_cast<void*>(aligned);
+            }
+            return allocate_slow(size, alignment);
+        }
+
+        template <typename T>
+        T* allocate_array(size_t count) {
+            return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        template <typename T, typename... Args>
+        AstPtr<T> make(Args&&... args) {
+            static_assert(std::is_trivially_destructible_v<T>, "Objects in the arena are never destroyed, they can't own other memory");
+            return AstPtr<T>(::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...));
+        }
+
+        Mark mark() const noexcept { return { m_head, m_cursor }; }
+
+        /**
+         * @brief Free everything allocated after `mark`, nothing allocated before it may point there anymore
+         */
+        void rollback(const Mark& mark) noexcept;
+
+        size_t block_count() const noexcept { return m_block_count; }
+        size_t bytes_reserved() const noexcept { return m_bytes_reserved; }
+
+    private:
+        struct Block;
+
+        Block* m_head = nullptr;
+        char* m_cursor = nullptr;
+        char* m_end = nullptr;
+        size_t m_block_count = 0;
+        size_t m_bytes_reserved = 0;
+
+        void* allocate_slow(size_t size, size_t alignment);
+        void release_blocks_after(Block* keep) noexcept;
+    };
+
+    /**
+     * Non-owning pointer to a node in an AstArena, the arena frees it
+     */
+    template <typename T>
+    class AstPtr {
+    public:
+        AstPtr() noexcept = default;
+        AstPtr(std::nullptr_t) noexcept {}
+        explicit AstPtr(T* p) noexcept : m_ptr(p) {}
+
+        template <typename U> requires std::is_convertible_v<U*, T*>
+        AstPtr(const AstPtr<U>& other) noexcept : m_ptr(other.get()) {}
+
+        T& operator*() const { return *m_ptr; }
+        T* operator->() const { return m_ptr; }
+        T* get() const { return m_ptr; }
+
+        bool is_null() const { return m_ptr == nullptr; }
+        explicit operator bool() const { return m_ptr != nullptr; }
+
+    private:
+        T* m_ptr = nullptr;
+    };
+
+    /**
+     * Child list whose storage lives in an AstArena, the first N elements are stored in place like a small_vector.
+     * A list is filled while parsing then only read, copies of a spilled list share its storage.
+     */
+    template <typename T, size_t N = 0>
+    class AstList : public small_vector_storage<T, N> {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Arena lists are copied and freed as raw bytes");
+
+        using small_vector_storage<T, N>::m_size;
+        using small_vector_storage<T, N>::m_capacity;
+        using small_vector_storage<T, N>::m_heap;
+
+    public:
+        using small_vector_storage<T, N>::data;
+
+        AstList() noexcept = default;
+
+        void push_back(AstArena& arena, const T& value) {
+            if (m_size == m_capacity) {
+                // `value` may be an element of this list, the old storage is left in the arena untouched
+                T* const old_data = data();
+                const size_t new_capacity = m_capacity < 4 ? 4 : size_t(m_capacity) * 2;
+                T* const new_data = arena.allocate_array<T>(new_capacity);
+                if (m_size > 0) {
+                    std::memcpy(static_cast<void*>(new_data), old_data, m_size * sizeof(T));
+                }
+                ::new (static_cast<void*>(new_data + m_size)) T(value);
+                m_heap = new_data;
+                m_capacity = static_cast<uint32_t>(new_capacity);
+            } else {
+                ::new (static_cast<void*>(data() + m_size)) T(value);
+            }
+            ++m_size;
+        }
+
+        template <size_t M>
+        void extend(AstArena& arena, const AstList<T, M>& other) {
+            for (const T& value : other) {
+                push_back(arena, value);
+            }
+        }
+
+        void pop_back() { --m_size; }
+        void clear() { m_size = 0; }
+    };
+}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "lust/grammar.hpp"
+#include "lust/grammar/operator_expr.hpp"
+#include "lust/grammar/type_expr.hpp"
+
+namespace lust
+{
+namespace grammar
+{
+    /**
+     * Walks a tree with static dispatch: visit() switches on get_type() and calls `Derived::visit_<rule>()`.
+     * Derived only defines the overloads it cares about, the default of each one forwards to the visit of the
+     * node's base class, down to visit_node() which visits the children. Nothing allocates on the way.
+     *
+     * struct Counter : ASTVisitor<Counter> {
+     *     size_t calls = 0;
+     *     void visit_qualified_name(const ASTNode_QualifiedName& node) { ++calls; visit_children(node); }
+     * };
+     */
+    template <typename Derived>
+    class ASTVisitor {
+    public:
+        void visit(const IASTNode* node) {
+            if (nullptr == node) {
+                return;
+            }
+            switch (node->get_type()) {
+                case GrammarRule::PROGRAM: return derived().visit_program(static_cast<const ASTNode_Program&>(*node));
+                case GrammarRule::STATEMENT: return derived().visit_statement(static_cast<const ASTNode_Statement&>(*node));
+                case GrammarRule::NAMED_STATEMENT: return derived().visit_named_statement(static_cast<const ASTNode_NamedStatement&>(*node));
+                case GrammarRule::EXPR_STATEMENT: return derived().visit_expr_statement(static_cast<const ASTNode_ExprStatement&>(*node));
+                case GrammarRule::VAR_DECL: return derived().visit_var_decl(static_cast<const ASTNode_VarDecl&>(*node));
+                case GrammarRule::FUNCTION_DECL: return derived().visit_function_decl(static_cast<const ASTNode_FunctionDecl&>(*node));
+                case GrammarRule::ATTRIBUTE: return derived().visit_attribute(static_cast<const ASTNode_Attribute&>(*node));
+                case GrammarRule::GENERIC_PARAM: return derived().visit_generic_param(static_cast<const ASTNode_GenericParam&>(*node));
+                case GrammarRule::PARAMETER: return derived().visit_param_decl(static_cast<const ASTNode_ParamDecl&>(*node));
+                case GrammarRule::TYPE_EXPR: return derived().visit_type_expr(static_cast<const ASTNode_TypeExpr&>(*node));
+                case GrammarRule::PARAMETERS_LIST: return derived().visit_param_list(static_cast<const ASTNode_ParamList&>(*node));
+                case GrammarRule::BLOCK: return derived().visit_block(static_cast<const ASTNode_Block&>(*node));
+                case GrammarRule::OPERATOR: return derived().visit_operator(static_cast<const ASTNode_Operator&>(*node));
+                case GrammarRule::EXPRESSION: return derived().visit_expr(static_cast<const ASTNode_Expr&>(*node));
+                case GrammarRule::INTEGER_LITERAL: return derived().visit_integer_literal(static_cast<const ASTNode_IntegerExpr&>(*node));
+                case GrammarRule::FLOAT_LITERAL: return derived().visit_float_literal(static_cast<const ASTNode_FloatExpr&>(*node));
+                case GrammarRule::STRING_LITERAL: return derived().visit_string_literal(static_cast<const ASTNode_StringExpr&>(*node));
+                case GrammarRule::QUALIFIED_NAME_USAGE: return derived().visit_qualified_name(static_cast<const ASTNode_QualifiedName&>(*node));
+                case GrammarRule::INVOKE_PARAMETERS: return derived().visit_invoke_parameters(static_cast<const ASTNode_InvokeParameters&>(*node));
+                case GrammarRule::BLOCK_EXPR: return derived().visit_block_expr(static_cast<const ASTNode_BlockExpr&>(*node));
+                case GrammarRule::IF_BLOCK_EXPR: return derived().visit_conditional_block_expr(static_cast<const ASTNode_ConditionalBlockExpr&>(*node));
+                case GrammarRule::STRUCT: return derived().visit_struct_decl(static_cast<const ASTNode_StructDecl&>(*node));
+                case GrammarRule::STRUCT_FIELD: return derived().visit_struct_field(static_cast<const ASTNode_StructField&>(*node));
+                case GrammarRule::TRAIT: return derived().visit_trait_decl(static_cast<const ASTNode_TraitDecl&>(*node));
+                case GrammarRule::MORPHISMS_TYPE: return derived().visit_morphisms_type(static_cast<const ASTNode_MorphismsType&>(*node));
+                case GrammarRule::MORPHISMS_CONSTANT: return derived().visit_morphisms_constant(static_cast<const ASTNode_MorphismsConstant&>(*node));
+                default: return derived().visit_node(*node);
+            }
+        }
+
+        void visit_children(const IASTNode& node) {
+            node.for_each_child([this] (const IASTNode* child) {
+                derived().visit(child);
+            });
+        }
+
+        void visit_node(const IASTNode& node) { visit_children(node); }
+
+        void visit_program(const ASTNode_Program& node) { derived().visit_node(node); }
+        void visit_attribute(const ASTNode_Attribute& node) { derived().visit_node(node); }
+        void visit_generic_param(const ASTNode_GenericParam& node) { derived().visit_node(node); }
+        void visit_param_decl(const ASTNode_ParamDecl& node) { derived().visit_node(node); }
+        void visit_param_list(const ASTNode_ParamList& node) { derived().visit_node(node); }
+        void visit_invoke_parameters(const ASTNode_InvokeParameters& node) { derived().visit_node(node); }
+        void visit_type_expr(const ASTNode_TypeExpr& node) { derived().visit_node(node); }
+
+        void visit_statement(const ASTNode_Statement& node) { derived().visit_node(node); }
+        void visit_named_statement(const ASTNode_NamedStatement& node) { derived().visit_statement(node); }
+        void visit_expr_statement(const ASTNode_ExprStatement& node) { derived().visit_statement(node); }
+        void visit_var_decl(const ASTNode_VarDecl& node) { derived().visit_statement(node); }
+        void visit_block(const ASTNode_Block& node) { derived().visit_statement(node); }
+        void visit_function_decl(const ASTNode_FunctionDecl& node) { derived().visit_named_statement(node); }
+        void visit_struct_decl(const ASTNode_StructDecl& node) { derived().visit_named_statement(node); }
+        void visit_struct_field(const ASTNode_StructField& node) { derived().visit_named_statement(node); }
+        void visit_trait_decl(const ASTNode_TraitDecl& node) { derived().visit_named_statement(node); }
+        void visit_morphisms_type(const ASTNode_MorphismsType& node) { derived().visit_named_statement(node); }
+        void visit_morphisms_constant(const ASTNode_MorphismsConstant& node) { derived().visit_named_statement(node); }
+
+        void visit_expr(const ASTNode_Expr& node) { derived().visit_statement(node); }
+        void visit_operator(const ASTNode_Operator& node) { derived().visit_expr(node); }
+        void visit_integer_literal(const ASTNode_IntegerExpr& node) { derived().visit_operator(node); }
+        void visit_float_literal(const ASTNode_FloatExpr& node) { derived().visit_operator(node); }
+        void visit_string_literal(const ASTNode_StringExpr& node) { derived().visit_operator(node); }
+        void visit_qualified_name(const ASTNode_QualifiedName& node) { derived().visit_operator(node); }
+        void visit_block_expr(const ASTNode_BlockExpr& node) { derived().visit_operator(node); }
+        void visit_conditional_block_expr(const ASTNode_ConditionalBlockExpr& node) { derived().visit_block_expr(node); }
+
+    private:
+        Derived& derived() { return static_cast<Derived&>(*this); }
+    };
+}
+}
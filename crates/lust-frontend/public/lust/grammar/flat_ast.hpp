@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "lust/container/simple_string.hpp"
+#include "lust/container/string_builder.hpp"
+#include "lust/container/vector.hpp"
+#include "lust/grammar.hpp"
+#include "lust/grammar/operator_expr.hpp"
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+namespace grammar
+{
+    using NodeIndex = uint32_t;
+
+    constexpr NodeIndex NO_NODE = ~NodeIndex(0);
+
+    enum class TypeExprKind : uint8_t {
+        NONE,
+        TRIVIAL,
+        TUPLE,
+        REFERENCE,
+        GENERIC,
+        FUNCTION,
+        ARRAY,
+    };
+
+    /**
+     * Bits of FlatAst::flags(), the low three are shared by every node deriving from ASTNode_Statement
+     */
+    enum FlatNodeFlags : uint8_t {
+        FLAT_VISIBILITY_MASK = 0x03,
+        FLAT_END_WITH_SEMICOLON = 0x04,
+
+        // VAR_DECL and STRUCT_FIELD
+        FLAT_MUTABLE = 0x08,
+        // VAR_DECL
+        FLAT_CONST = 0x10,
+        FLAT_FORWARD_DECL_ONLY = 0x20,
+        // FUNCTION_DECL
+        FLAT_ASYNC = 0x08,
+        // PARAMETER
+        FLAT_INSTANCE_FUNCTION = 0x08,
+
+        // INTEGER_LITERAL and FLOAT_LITERAL keep their lexer::NumberSuffix here
+        FLAT_NUMBER_SUFFIX_SHIFT = 3,
+        FLAT_NUMBER_SUFFIX_MASK = 0x78,
+    };
+
+    /**
+     * The tree of a program encoded in flat arrays, one entry per node in pre-order.
+     * The subtree of node `i` is the range [i, subtree_end(i)), so a pass over every node is a sequential scan
+     * and walking the indices backwards visits children before their parent.
+     * Kind, tag and flags are parallel byte arrays, names and literals live in side tables that `data` indexes:
+     * - identifiers of declarations and parameters: symbols()
+     * - qualified names, attributes and generic constraints: ranges of symbols() described in the extra words
+     * - integers and array sizes, floats: their own tables, the text of strings is copied into one buffer
+     * The children of a node are the ones IASTNode::for_each_child() visits, in the same order.
+     * The flat form is self contained, it doesn't point into the tree it was built from.
+     */
+    class LUSTFRONTEND_API FlatAst {
+    public:
+        FlatAst() noexcept = default;
+
+        /**
+         * @brief Encode `program` in one pre-order pass
+         */
+        static FlatAst build(const ASTNode_Program& program);
+
+        size_t size() const noexcept { return m_kinds.size(); }
+        bool empty() const noexcept { return m_kinds.empty(); }
+
+        GrammarRule kind(NodeIndex node) const { return static_cast<GrammarRule>(m_kinds[node]); }
+        uint8_t flags(NodeIndex node) const { return m_flags[node]; }
+        NodeIndex parent(NodeIndex node) const { return m_parents[node]; }
+        NodeIndex subtree_end(NodeIndex node) const { return m_ends[node]; }
+
+        /**
+         * @brief Operator of an expression node, INVALID for the other nodes
+         */
+        OperatorType operator_type(NodeIndex node) const;
+        /**
+         * @brief Shape of a TYPE_EXPR node, NONE for the other nodes
+         */
+        TypeExprKind type_kind(NodeIndex node) const;
+        Visibility visibility(NodeIndex node) const { return static_cast<Visibility>(m_flags[node] & FLAT_VISIBILITY_MASK); }
+
+        NodeIndex first_child(NodeIndex node) const { return node + 1 < m_ends[node] ? node + 1 : NO_NODE; }
+        NodeIndex next_sibling(NodeIndex node) const;
+        size_t child_count(NodeIndex node) const;
+
+        /**
+         * @brief Identifier of a declaration or a parameter
+         */
+        Symbol identifier(NodeIndex node) const;
+        /**
+         * @brief `a::b::name` as {a, b, name}: QUALIFIED_NAME_USAGE, ATTRIBUTE, trivial and generic TYPE_EXPR
+         */
+        std::span<const Symbol> qualified_name(NodeIndex node) const;
+        std::span<const Symbol> attribute_args(NodeIndex node) const;
+        size_t constraint_count(NodeIndex node) const;
+        std::span<const Symbol> constraint(NodeIndex node, size_t index) const;
+
+        uint64_t integer_value(NodeIndex node) const { return m_integers[m_data[node]]; }
+        double float_value(NodeIndex node) const { return m_floats[m_data[node]]; }
+        std::string_view string_value(NodeIndex node) const { return m_string_text.view().substr(m_extra[m_data[node]], m_extra[m_data[node] + 1]); }
+        lexer::NumberSuffix number_suffix(NodeIndex node) const {
+            return static_cast<lexer::NumberSuffix>((m_flags[node] & FLAT_NUMBER_SUFFIX_MASK) >> FLAT_NUMBER_SUFFIX_SHIFT);
+        }
+        size_t array_size(NodeIndex node) const { return static_cast<size_t>(m_integers[m_data[node]]); }
+
+        /**
+         * @brief Same text as IASTNode::get_name() of the node it was built from
+         */
+        simple_string get_name(NodeIndex node) const;
+
+        /**
+         * @brief One line per node indented by depth, with its name and payload
+         */
+        void serialize(string_builder& builder) const;
+
+        /**
+         * Raw arrays for passes scanning every node, indexed by NodeIndex
+         */
+        const vector<uint8_t>& kinds() const noexcept { return m_kinds; }
+        const vector<uint8_t>& tags() const noexcept { return m_tags; }
+        /**
+         * @brief Every identifier and name component of the program in source order
+         */
+        const vector<Symbol>& symbols() const noexcept { return m_symbols; }
+
+    private:
+        friend class FlatAstEncoder;
+
+        vector<uint8_t> m_kinds;
+        // OperatorType or TypeExprKind
+        vector<uint8_t> m_tags;
+        vector<uint8_t> m_flags;
+        vector<NodeIndex> m_parents;
+        vector<NodeIndex> m_ends;
+        // Index into the side table of the node's kind
+        vector<uint32_t> m_data;
+
+        vector<Symbol> m_symbols;
+        // Symbol and string ranges as (first, count) pairs, see the layouts in flat_ast.cpp
+        vector<uint32_t> m_extra;
+        vector<uint64_t> m_integers;
+        vector<double> m_floats;
+        // Text of every string literal back to back
+        string_builder m_string_text;
+
+        std::span<const Symbol> symbol_range(size_t extra_index) const {
+            return { m_symbols.data() + m_extra[extra_index], m_extra[extra_index + 1] };
+        }
+
+        // `node` must have a qualified name
+        string_builder& append_name(string_builder& builder, NodeIndex node) const;
+    };
+}
+}
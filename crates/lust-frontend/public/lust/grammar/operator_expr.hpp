@@ -1,7 +1,7 @@
 #pragma once
-#include "container/simple_string.hpp"
-#include "container/unique_ptr.hpp"
-#include "grammar.hpp"
+#include "lust/container/simple_string.hpp"
+#include "lust/grammar.hpp"
+#include "lust/lexer.hpp"
 #include "lustfrontend_export.h"
 
 namespace lust
@@ -59,49 +59,54 @@ namespace grammar
     LUSTFRONTEND_API extern const char* operator_type_to_name(OperatorType type);
 
     struct ASTNode_Expr : public ASTBaseNode<GrammarRule::EXPRESSION, ASTNode_Statement> {
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_Operator : public ASTBaseNode<GrammarRule::OPERATOR, ASTNode_Expr> {
         OperatorType operator_type;
-        UniquePtr<ASTNode_Expr> left_oprand;
-        UniquePtr<ASTNode_Expr> right_oprand;
+        AstPtr<ASTNode_Expr> left_oprand;
+        AstPtr<ASTNode_Expr> right_oprand;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
         simple_string get_name() const override;
     };
 
     struct ASTNode_IntegerExpr : public ASTBaseNode<GrammarRule::INTEGER_LITERAL, ASTNode_Operator> {
-        simple_string value;
+        uint64_t value = 0;
+        lexer::NumberSuffix suffix = lexer::NumberSuffix::NONE;
     };
 
     struct ASTNode_FloatExpr : public ASTBaseNode<GrammarRule::FLOAT_LITERAL, ASTNode_Operator> {
-        simple_string value;
+        double value = 0;
+        lexer::NumberSuffix suffix = lexer::NumberSuffix::NONE;
     };
 
     struct ASTNode_StringExpr : public ASTBaseNode<GrammarRule::STRING_LITERAL, ASTNode_Operator> {
-        simple_string value;
+        // Decoded text, kept in Ast::literal_arena() where equal literals of the tree share it
+        std::string_view value;
     };
 
     struct ASTNode_QualifiedName : public ASTBaseNode<GrammarRule::QUALIFIED_NAME_USAGE, ASTNode_Operator> {
         QualifiedName qualified_name{};
-        UniquePtr<ASTNode_InvokeParameters> passing_parameters;
+        // `Foo<T>(x)`, only set for function calls
+        AstList<AstPtr<ASTNode_GenericParam>> generic_params;
+        AstPtr<ASTNode_InvokeParameters> passing_parameters;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
         simple_string get_name() const override;
     };
 
     struct ASTNode_BlockExpr : public ASTBaseNode<GrammarRule::BLOCK_EXPR, ASTNode_Operator> {
-        UniquePtr<ASTNode_Block> left_code_block;
-        UniquePtr<ASTNode_Block> right_code_block;
+        AstPtr<ASTNode_Block> left_code_block;
+        AstPtr<ASTNode_Block> right_code_block;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_ConditionalBlockExpr : public ASTBaseNode<GrammarRule::IF_BLOCK_EXPR, ASTNode_BlockExpr> {
-        UniquePtr<ASTNode_Expr> condition;
+        AstPtr<ASTNode_Expr> condition;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
 }
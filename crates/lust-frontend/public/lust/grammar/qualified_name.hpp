@@ -1,15 +1,29 @@
 #pragma once
 
-#include "lust/container/vector.hpp"
+#include <span>
 #include "lust/container/simple_string.hpp"
+#include "lust/container/string_builder.hpp"
+#include "lust/grammar/ast_arena.hpp"
+#include "lust/symbol.hpp"
 
 namespace lust
 {
 namespace grammar
 {
     struct QualifiedName { 
-        simple_string name;
-        vector<simple_string> name_spaces;
+        Symbol name;
+        // Mostly empty or a single module
+        AstList<Symbol, 2> name_spaces;
     };
+
+    /**
+     * @brief Append `name` as written in the source, `a::b::name`
+     */
+    LUSTFRONTEND_API extern string_builder& append_qualified_name(string_builder& builder, const QualifiedName& name);
+
+    /**
+     * @brief Same rendering for a name stored as separate parts, FlatAst keeps them as one span of symbols
+     */
+    LUSTFRONTEND_API extern string_builder& append_qualified_name(string_builder& builder, std::span<const Symbol> name_spaces, Symbol name);
 }
 }
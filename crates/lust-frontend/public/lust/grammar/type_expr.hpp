@@ -1,7 +1,7 @@
 #pragma once
 
-#include "grammar.hpp"
-#include "container/number.hpp"
+#include "lust/grammar.hpp"
+#include "lust/container/number.hpp"
 
 namespace lust
 {
@@ -49,44 +49,44 @@ namespace grammar
 
         bool is_unit_type() override;
 
-        vector<UniquePtr<ASTNode_TypeExpr>> composite_types;
+        AstList<AstPtr<ASTNode_TypeExpr>> composite_types;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_TypeExpr_Reference : public ASTNode_TypeExpr {
         bool is_reference_type() override;
 
-        UniquePtr<ASTNode_TypeExpr> referenced_type;
+        AstPtr<ASTNode_TypeExpr> referenced_type;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_TypeExpr_Generic : public ASTNode_TypeExpr {
         bool is_generic_type() override;
 
         QualifiedName base_type;
-        vector<UniquePtr<ASTNode_GenericParam>> params;
+        AstList<AstPtr<ASTNode_GenericParam>> params;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_TypeExpr_Function : public ASTNode_TypeExpr {
         bool is_function_type() override;
 
-        vector<UniquePtr<ASTNode_TypeExpr>> param_types;
-        UniquePtr<ASTNode_TypeExpr> return_type;
+        AstList<AstPtr<ASTNode_TypeExpr>> param_types;
+        AstPtr<ASTNode_TypeExpr> return_type;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
     struct ASTNode_TypeExpr_Array : public ASTNode_TypeExpr {
         bool is_array_type() override;
 
-        UniquePtr<ASTNode_TypeExpr> array_type;
+        AstPtr<ASTNode_TypeExpr> array_type;
         size_t array_size;
 
-        vector<const IASTNode*> collect_self_nodes() const override;
+        void for_each_child(ChildCallback callback) const override;
     };
 
 }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <bit>
 #include <cstdint>
+#include <functional>
 #include <string_view>
 #include "container/simple_string.hpp"
+#include "container/vector.hpp"
+#include "symbol.hpp"
 #include "lustfrontend_export.h"
 
 namespace lust {
@@ -200,6 +204,11 @@ namespace lexer {
 
     LUSTFRONTEND_API extern const char* token_type_to_string(TerminalTokenType type);
 
+    /**
+     * @brief Lookup the keyword table. If not found, it will be IDENT.
+     */
+    LUSTFRONTEND_API extern TerminalTokenType lookup_keyword(std::string_view text);
+
     LUSTFRONTEND_API extern const bool is_assignment_token(TerminalTokenType token_type);
 
     LUSTFRONTEND_API extern const bool is_unary_token(TerminalTokenType token_type);
@@ -211,20 +220,252 @@ namespace lexer {
         int64_t row = -1;
     };
 
+    /**
+     * @brief One-shot lookup, scans the whole text. Use a SourceMap for repeated lookups in the same text.
+     */
     extern SourceLoc pos_to_line_and_row(std::string_view full_text, int64_t pos);
 
     /**
-     * @warning Don't try to destruct this struct crossing binary boundary because using STL here.
+     * @brief Type suffix of a numeric literal, such as `1u8` or `2.5f32`
+     */
+    enum class NumberSuffix : uint8_t {
+        NONE,
+        I8,
+        I16,
+        I32,
+        I64,
+        ISIZE,
+        U8,
+        U16,
+        U32,
+        U64,
+        USIZE,
+        F32,
+        F64,
+    };
+
+    LUSTFRONTEND_API extern const char* number_suffix_to_string(NumberSuffix suffix);
+
+    /**
+     * @brief Value of an INT or FLOAT token, decoded once by the lexer
+     */
+    struct NumberLiteral {
+        // The integer, or the bits of the double for a FLOAT
+        uint64_t bits = 0;
+        NumberSuffix suffix = NumberSuffix::NONE;
+        // The integer doesn't fit in 64 bits or in the type of its suffix, a signed type may hold the magnitude of its minimum.
+        // A FLOAT overflows to infinity.
+        bool is_overflow = false;
+
+        constexpr uint64_t integer() const { return bits; }
+        constexpr double floating() const { return std::bit_cast<double>(bits); }
+    };
+
+    /**
+     * @brief A token doesn't own its text.
+     * `value` is a view into the source buffer of the tokenizer which produced it
+     * (or a static message for ERROR tokens), so it is valid as long as the tokenizer is alive.
+     * Copy it into a `simple_string` when it must outlive the tokenizer.
      */
     struct Token {
         TerminalTokenType type;
-        lust::simple_string value;
+        // Interned `value` of IDENT tokens, empty for other types
+        Symbol symbol{};
+        std::string_view value;
+        // Offset of `value` in the source buffer
         int64_t pos;
+        // Decoded INT and FLOAT literals, zero for other types
+        NumberLiteral number{};
+        // A STRING token holding escape sequences, see decode_string_literal()
+        bool has_escapes = false;
 
         /**
          * @note Use this interface to ensure ABI compatibility
+         * The view is not null-terminated, see get_value_string()
+         */
+        LUSTFRONTEND_API std::string_view get_value() const;
+
+        /**
+         * @brief Null-terminated copy of `value`, for callers of the former `const char* get_value()`.
+         * The copy stays valid after the tokenizer is destroyed.
+         */
+        LUSTFRONTEND_API simple_string get_value_string() const;
+    };
+
+    /**
+     * @brief Text of a STRING token with its escape sequences decoded.
+     * A literal without escapes is returned as its own value, no copy is made.
+     * Otherwise the decoded text is interned into SymbolTable::literals(), identical literals share one copy.
+     * @return false if the literal holds an invalid escape sequence
+     */
+    LUSTFRONTEND_API extern bool decode_string_literal(const Token& token, std::string_view& out_text);
+
+    /**
+     * @brief Decode the text of a STRING token into `out`, which holds at least `token.value.size()` chars.
+     * For callers keeping the text in storage of their own, nothing is interned.
+     * @return The decoded size, -1 if the literal holds an invalid escape sequence
+     */
+    LUSTFRONTEND_API extern int64_t decode_string_literal(const Token& token, char* out);
+
+    /**
+     * @brief Offset where a token's spelling starts, which is where lexing it again must start.
+     * `pos` of a STRING is past its opening quote and `pos` of a COMMENTVAL past the `//`.
+     */
+    constexpr int64_t token_start(TerminalTokenType type, int64_t pos) {
+        switch (type) {
+            case TerminalTokenType::STRING: return pos - 1;
+            case TerminalTokenType::COMMENTVAL: return pos - 2;
+            default: return pos;
+        }
+    }
+
+    /**
+     * @brief Where a tokenizer resumes lexing, see ITokenizer::save_state()
+     */
+    struct TokenizerState {
+        // Offset in the whole input, like Token::pos
+        int64_t pos = 0;
+        TerminalTokenType previous_token_type = TerminalTokenType::NONE;
+    };
+
+    /**
+     * @brief Structure-of-arrays storage of a whole token stream, 13 bytes per token plus 16 per numeric literal.
+     * Token text isn't stored, tokens are rebuilt as views into `source()` on access,
+     * so the buffer is valid as long as the tokenizer which produced it is alive.
+     * @note Offsets are 32-bit, sources larger than 4 GiB can't be stored
+     */
+    class LUSTFRONTEND_API TokenBuffer final {
+    public:
+        TokenBuffer() = default;
+        explicit TokenBuffer(std::string_view source);
+
+        std::string_view source() const;
+
+        size_t size() const;
+        bool empty() const;
+        void reserve(size_t new_cap);
+
+        TerminalTokenType type_at(size_t index) const;
+        uint32_t offset_at(size_t index) const;
+        uint32_t length_at(size_t index) const;
+        Symbol symbol_at(size_t index) const;
+        NumberLiteral number_at(size_t index) const;
+
+        /**
+         * @brief Rebuild the token at `index`, its value views `source()` (or the error message for ERROR tokens)
+         */
+        Token token_at(size_t index) const;
+
+        void push_back(const Token& token);
+
+        /**
+         * @brief Move the tokens of `other` to the end, both buffers must view the same source
+         */
+        void append(TokenBuffer&& other);
+
+        /**
+         * @brief Replace tokens [first, first + removed_count) with the tokens of `replacement` and move the offsets
+         * of the tokens after them by `delta`. The buffer then views the source of `replacement`, the edited text.
+         */
+        void splice(size_t first, size_t removed_count, TokenBuffer&& replacement, int64_t delta);
+
+    private:
+        std::string_view m_source;
+        vector<uint8_t> m_types;
+        vector<uint32_t> m_offsets;
+        vector<uint32_t> m_lengths;
+        // Symbol id of IDENT tokens, index in `m_numbers` of INT and FLOAT tokens, 1 for STRING tokens with escapes, 0 otherwise
+        vector<uint32_t> m_payloads;
+        vector<NumberLiteral> m_numbers;
+
+        // Errors are rare, their messages are kept aside and looked up by token index
+        vector<uint32_t> m_error_indices;
+        vector<std::string_view> m_error_messages;
+
+        // Literals of tokens removed by splice(), compacted once they are the majority of `m_numbers`
+        size_t m_dead_numbers = 0;
+    };
+
+    /**
+     * @brief Token-level diff of ITokenizer::apply_edit()
+     */
+    struct TokenEdit {
+        // False if the tokenizer can't be edited or the range isn't in the text
+        bool is_applied = false;
+        // Tokens [first, first + removed_count) of the old document were replaced with [first, first + inserted_count)
+        size_t first = 0;
+        size_t removed_count = 0;
+        size_t inserted_count = 0;
+        // The tokens after them are unchanged, their offsets moved by `delta`
+        int64_t delta = 0;
+    };
+
+    /**
+     * @brief What a tokenizer does with `//` comments
+     */
+    enum class CommentMode : uint8_t {
+        // Emit COMMENTVAL tokens
+        EMIT,
+        // Emit nothing, record the spans in ITokenizer::comments()
+        RECORD,
+        // Emit nothing, comments are skipped like whitespace
+        SKIP,
+    };
+
+    struct TokenizerOptions {
+        CommentMode comments = CommentMode::EMIT;
+    };
+
+    /**
+     * @brief A recorded comment, see CommentTable
+     */
+    struct CommentSpan {
+        // Offset of the text after `//` in the whole input, like Token::pos
+        int64_t pos = 0;
+        int64_t length = 0;
+    };
+
+    /**
+     * @brief Comments met by a tokenizer in CommentMode::RECORD, sorted by offset.
+     * Like a TokenBuffer it doesn't copy the text, views are rebuilt from the source on access.
+     */
+    class LUSTFRONTEND_API CommentTable final {
+    public:
+        size_t size() const;
+        bool empty() const;
+
+        CommentSpan span_at(size_t index) const;
+
+        /**
+         * @brief The comment at `index` viewed in `source`, which must start at offset 0 of the input
+         */
+        std::string_view text_at(size_t index, std::string_view source) const;
+
+        /**
+         * @brief Index of the first comment starting at or after `pos`, size() if there is none.
+         * The comments between two tokens are [lower_bound(end of the first), lower_bound(start of the second)).
+         */
+        size_t lower_bound(int64_t pos) const;
+
+        /**
+         * @brief Index of the comment whose text starts at `pos`, size() if there is none
          */
-        LUSTFRONTEND_API const char* get_value() const;
+        size_t find(int64_t pos) const;
+
+        /**
+         * @brief Record a comment. Comments at or after it are dropped first, a rewound tokenizer meets them again.
+         */
+        void push_back(const CommentSpan& span);
+
+        void append(CommentTable&& other);
+
+        /**
+         * @brief Replace the comments starting in [begin, end) with `replacement`, the ones after them move by `delta`
+         */
+        void splice(int64_t begin, int64_t end, CommentTable&& replacement, int64_t delta);
+
+    private:
+        vector<CommentSpan> m_spans;
     };
 
     class LUSTFRONTEND_API TokenStream final {
@@ -241,27 +482,123 @@ namespace lexer {
 
         ITokenizer* operator->();
 
+        bool is_null() const;
+
+        explicit operator bool() const;
+
     private:
         ITokenizer* m_data_src = nullptr;
     };
 
 
+    /**
+     * @brief Pull input for a streaming tokenizer, write at most `capacity` bytes to `buffer`
+     * @return The number of bytes written, 0 once the input is exhausted
+     */
+    using ReadCallback = std::function<size_t(char* buffer, size_t capacity)>;
+
     class LUSTFRONTEND_API ITokenizer {
     public:
         virtual ~ITokenizer() = default;
 
-        static TokenStream create(std::string_view in_text);
+        static TokenStream create(std::string_view in_text, const TokenizerOptions& options = {});
+
+        /**
+         * @brief Memory map the file at `path` (UTF-8) and lex it in place, the text is never copied.
+         * original_text() and token values view the mapping, which lives as long as the tokenizer.
+         * @return A null stream if the file can't be opened
+         */
+        static TokenStream create_from_file(const char* path, const TokenizerOptions& options = {});
+
+        /**
+         * @brief Lex input of unknown size pulled from `read`, only a window of `window_size` bytes is buffered (twice).
+         * original_text() is the current window, tokens keep offsets into the whole input.
+         * A token value stays valid until next_token() has been called twice more.
+         * @note A single token longer than the window is reported as an ERROR, tokenize_all() isn't supported
+         */
+        static TokenStream create_from_reader(ReadCallback read, size_t window_size = 64 << 10, const TokenizerOptions& options = {});
 
+        /**
+         * @brief create_from_reader() reading a file descriptor such as a pipe, the descriptor isn't closed
+         */
+        static TokenStream create_from_fd(int fd, size_t window_size = 64 << 10, const TokenizerOptions& options = {});
+
+        /**
+         * @brief The whole source for in-memory tokenizers, the currently buffered window for streaming ones
+         */
         virtual const std::string_view original_text() const = 0;
 
+        /**
+         * @brief Offset of original_text() in the whole input, only streaming tokenizers move it
+         */
+        virtual int64_t original_text_offset() const = 0;
+
         virtual Token next_token() = 0;
 
+        /**
+         * @brief Lex up to `max_count` tokens into `out` with a single virtual call, stops after END
+         * @return The number of tokens written
+         */
+        virtual size_t next_tokens(Token* out, size_t max_count) = 0;
+
+        /**
+         * @brief Lex everything left in one go, the last token of the buffer is END (or ERROR)
+         */
+        virtual TokenBuffer tokenize_all() = 0;
+
+        /**
+         * @brief Same result as tokenize_all(), but the text is cut into chunks at line breaks and lexed on `thread_count` threads.
+         * Only a multi-line string literal can cross a chunk boundary, the stitching step detects it
+         * and lexes that chunk again from the closing quote.
+         * @note Falls back to tokenize_all() when there is less than `min_chunk_size` bytes per chunk
+         */
+        virtual TokenBuffer tokenize_all_parallel(uint32_t thread_count, size_t min_chunk_size = 1 << 20) = 0;
+
         virtual bool is_cursor_valid() const = 0;
 
+        /**
+         * @brief Whether the tokenizer moves a window over its input, token values then only live for a couple of tokens
+         * (see create_from_reader()) and tokenize_all() isn't supported
+         */
+        virtual bool is_streaming() const = 0;
+
         /**
          * @brief Lookahead 1 token type state
          */
         virtual TerminalTokenType get_pervious_token_type() const = 0;
+
+        /**
+         * @brief Capture the position the next token is lexed from, restoring it later costs a few integer copies
+         */
+        virtual TokenizerState save_state() const = 0;
+
+        /**
+         * @brief Lex again from `state`, as if nothing after it had been lexed. The first char of a token (see token_start(),
+         * Token::pos is past the quote of a STRING) with the type of the token before it is a valid state too.
+         * @return false if `state` is out of reach, a streaming tokenizer only goes back to the start of its window
+         */
+        virtual bool restore_state(const TokenizerState& state) = 0;
+
+        /**
+         * @brief Comments recorded so far, always empty unless the tokenizer was created with CommentMode::RECORD
+         */
+        virtual const CommentTable& comments() const = 0;
+
+        /**
+         * @brief Tokens of the whole text, as tokenize_all() would lex them from its start, kept up to date by apply_edit().
+         * Built on the first call, next_token() then starts again from the beginning of the text.
+         * @note A streaming tokenizer doesn't keep its text, it returns an ERROR like tokenize_all()
+         */
+        virtual const TokenBuffer& document_tokens() = 0;
+
+        /**
+         * @brief Replace `removed_length` bytes at `offset` with `inserted_text`, like an editor keystroke.
+         * Only the tokens around the edit are lexed again: from the last token boundary before it until the
+         * new tokens converge with the old ones, the rest of document_tokens() is shifted in place.
+         * next_token() starts again from the beginning of the text.
+         * @return The token-level diff, not applied for a streaming tokenizer or a range out of the text
+         */
+        virtual TokenEdit apply_edit(int64_t offset, int64_t removed_length, std::string_view inserted_text) = 0;
     };
 
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "lust/lexer.hpp"
+#include "lust/lexer/token_table.hpp"
+
+namespace lust
+{
+namespace lexer
+{
+    using KeywordSpec = TokenSpec;
+
+    inline constexpr size_t keyword_count = [] {
+        size_t count = 0;
+        for (const TokenSpec& spec : token_specs) {
+            count += spec.kind == TokenKind::KEYWORD;
+        }
+        return count;
+    }();
+
+    /**
+     * @brief The keywords of token_specs, the perfect hash below is generated from them
+     */
+    inline constexpr std::array<KeywordSpec, keyword_count> keyword_specs = [] {
+        std::array<KeywordSpec, keyword_count> specs{};
+        size_t count = 0;
+        for (const TokenSpec& spec : token_specs) {
+            if (spec.kind == TokenKind::KEYWORD) {
+                specs[count++] = spec;
+            }
+        }
+        return specs;
+    }();
+
+    /**
+     * @brief Perfect hash over keyword_specs, built at compile time.
+     * The key is made of the first two chars, the last char and the length,
+     * so recognizing a keyword costs one multiply, one table load and one compare without any allocation.
+     */
+    class KeywordPerfectHash {
+    public:
+        static constexpr uint32_t TABLE_BITS = 6;
+        static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+        static constexpr uint8_t EMPTY_SLOT = 0xFF;
+        static constexpr uint32_t MAX_SEED_TRIALS = 1u << 16;
+
+        static constexpr uint32_t key(std::string_view text) {
+            return static_cast<uint32_t>(static_cast<unsigned char>(text[0]))
+                | static_cast<uint32_t>(static_cast<unsigned char>(text[1])) << 8
+                | static_cast<uint32_t>(static_cast<unsigned char>(text[text.size() - 1])) << 16
+                | static_cast<uint32_t>(text.size()) << 24;
+        }
+
+        static constexpr uint32_t slot(uint32_t key, uint32_t seed) {
+            return (key * seed) >> (32 - TABLE_BITS);
+        }
+
+        constexpr KeywordPerfectHash() {
+            for (const KeywordSpec& spec : keyword_specs) {
+                m_min_length = spec.spelling.size() < m_min_length ? spec.spelling.size() : m_min_length;
+                m_max_length = spec.spelling.size() > m_max_length ? spec.spelling.size() : m_max_length;
+            }
+
+            // Fibonacci hashing seeds, take the first one without collision
+            for (uint32_t trial = 0; trial < MAX_SEED_TRIALS; ++trial) {
+                const uint32_t seed = 0x9E3779B1u + 2 * trial;
+                if (try_seed(seed)) {
+                    m_seed = seed;
+                    return;
+                }
+            }
+        }
+
+        constexpr bool is_valid() const {
+            return m_seed != 0;
+        }
+
+        constexpr TerminalTokenType lookup(std::string_view text) const {
+            if (text.size() < m_min_length || text.size() > m_max_length) {
+                return TerminalTokenType::IDENT;
+            }
+
+            const uint8_t index = m_slots[slot(key(text), m_seed)];
+            if (index != EMPTY_SLOT && keyword_specs[index].spelling == text) {
+                return keyword_specs[index].type;
+            }
+
+            return TerminalTokenType::IDENT;
+        }
+
+    private:
+        constexpr bool try_seed(uint32_t seed) {
+            for (uint8_t& s : m_slots) {
+                s = EMPTY_SLOT;
+            }
+
+            for (size_t i = 0; i < keyword_count; ++i) {
+                uint8_t& s = m_slots[slot(key(keyword_specs[i].spelling), seed)];
+                if (s != EMPTY_SLOT) {
+                    return false;
+                }
+                s = static_cast<uint8_t>(i);
+            }
+
+            return true;
+        }
+
+        uint32_t m_seed = 0;
+        size_t m_min_length = SIZE_MAX;
+        size_t m_max_length = 0;
+        std::array<uint8_t, TABLE_SIZE> m_slots{};
+    };
+
+    inline constexpr KeywordPerfectHash keyword_perfect_hash{};
+
+    static_assert(keyword_count < KeywordPerfectHash::EMPTY_SLOT, "Too many keywords for the slot type");
+    static_assert(keyword_perfect_hash.is_valid(), "No collision-free seed found, enlarge KeywordPerfectHash::TABLE_BITS");
+    static_assert(keyword_perfect_hash.lookup("continue") == TerminalTokenType::CONTINUE);
+    static_assert(keyword_perfect_hash.lookup("contained") == TerminalTokenType::IDENT);
+
+}
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "lust/lexer.hpp"
+
+namespace lust
+{
+namespace lexer
+{
+    enum class TokenKind : uint8_t {
+        // Lexed by hand: identifiers, literals, END...
+        OTHER,
+        // Fixed spelling made of symbols, recognized by punctuator_dfa
+        PUNCTUATOR,
+        // Fixed spelling made of letters, recognized by keyword_perfect_hash
+        KEYWORD,
+    };
+
+    namespace token_flags
+    {
+        inline constexpr uint8_t UNARY = 1 << 0;
+        inline constexpr uint8_t ASSIGNMENT = 1 << 1;
+    }
+
+    struct TokenSpec {
+        TerminalTokenType type{};
+        // Name reported by token_type_to_string()
+        const char* name = nullptr;
+        std::string_view spelling{};
+        TokenKind kind = TokenKind::OTHER;
+        // token_flags, shared by every spelling of the type
+        uint8_t flags = 0;
+    };
+
+    /**
+     * @brief The single token list. The punctuator DFA, the keyword recognizer, token_type_to_string(),
+     * is_unary_token() and is_assignment_token() are all generated from it.
+     * Every TerminalTokenType has an entry, a type may have several spellings such as `||` and `or`.
+     */
+    inline constexpr TokenSpec token_specs[] = {
+        { TerminalTokenType::NONE, "NONE" },
+        { TerminalTokenType::LET, "LET", "let", TokenKind::KEYWORD },
+        { TerminalTokenType::CONST, "CONST", "const", TokenKind::KEYWORD },
+        { TerminalTokenType::MUT, "MUT", "mut", TokenKind::KEYWORD },
+        { TerminalTokenType::FN, "FN", "fn", TokenKind::KEYWORD },
+        { TerminalTokenType::STRUCT, "STRUCT", "struct", TokenKind::KEYWORD },
+        { TerminalTokenType::TRAIT, "TRAIT", "trait", TokenKind::KEYWORD },
+        { TerminalTokenType::IMPL, "IMPL", "impl", TokenKind::KEYWORD },
+        { TerminalTokenType::FOR, "FOR", "for", TokenKind::KEYWORD },
+        { TerminalTokenType::TYPE, "TYPE", "type", TokenKind::KEYWORD },
+        { TerminalTokenType::IF, "IF", "if", TokenKind::KEYWORD },
+        { TerminalTokenType::ELSE, "ELSE", "else", TokenKind::KEYWORD },
+        { TerminalTokenType::LOOP, "LOOP", "loop", TokenKind::KEYWORD },
+        { TerminalTokenType::WHILE, "WHILE", "while", TokenKind::KEYWORD },
+        { TerminalTokenType::BREAK, "BREAK", "break", TokenKind::KEYWORD },
+        { TerminalTokenType::CONTINUE, "CONTINUE", "continue", TokenKind::KEYWORD },
+        { TerminalTokenType::IN, "IN", "in", TokenKind::KEYWORD },
+        { TerminalTokenType::ENUM, "ENUM", "enum", TokenKind::KEYWORD },
+        { TerminalTokenType::RANGE, "RANGE", "..", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::RANGEEQ, "RANGEEQ", "..=", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::IDENT, "IDENT" },
+        { TerminalTokenType::EQ, "EQ", "=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::LPAREN, "LPAREN", "(", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::RPAREN, "RPAREN", ")", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::LBRACE, "LBRACE", "{", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::RBRACE, "RBRACE", "}", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::SEMICOLON, "SEMICOLON", ";", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::COLON, "COLON", ":", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::COLONCOLON, "COLONCOLON", "::", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::ARROW, "ARROW", "->", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::COMMA, "COMMA", ",", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::HASH, "HASH", "#", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::DOT, "DOT", ".", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::SQ, "SQ", "'", TokenKind::PUNCTUATOR },
+        // Opens a string literal, never emitted
+        { TerminalTokenType::DQ, "DQ", "\"", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::LBRACKET, "LBRACKET", "[", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::RBRACKET, "RBRACKET", "]", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::END, "END" },
+        { TerminalTokenType::OR, "OR", "||", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::OR, "OR", "or", TokenKind::KEYWORD },
+        { TerminalTokenType::AND, "AND", "&&", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::AND, "AND", "and", TokenKind::KEYWORD },
+        { TerminalTokenType::NOT, "NOT", "!", TokenKind::PUNCTUATOR, token_flags::UNARY },
+        { TerminalTokenType::NOT, "NOT", "not", TokenKind::KEYWORD, token_flags::UNARY },
+        { TerminalTokenType::EQEQ, "EQEQ", "==", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::NEQ, "NEQ", "!=", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::LT, "LT", "<", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::LTE, "LTE", "<=", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::GT, "GT", ">", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::GTE, "GTE", ">=", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::PLUS, "PLUS", "+", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::PLUSPLUS, "PLUSPLUS", "++", TokenKind::PUNCTUATOR, token_flags::UNARY },
+        { TerminalTokenType::MINUS, "MINUS", "-", TokenKind::PUNCTUATOR, token_flags::UNARY },
+        { TerminalTokenType::MINUSMINUS, "MINUSMINUS", "--", TokenKind::PUNCTUATOR, token_flags::UNARY },
+        { TerminalTokenType::STAR, "STAR", "*", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::STARSTAR, "STARSTAR", "**", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::SLASH, "SLASH", "/", TokenKind::PUNCTUATOR },
+        // Opens a comment, never emitted, see COMMENTVAL
+        { TerminalTokenType::COMMENT, "COMMENT", "//", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::BITOR, "BITOR", "|", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::BITXOR, "BITXOR", "^", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::BITAND, "BITAND", "&", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::BITINV, "BITINV", "~", TokenKind::PUNCTUATOR, token_flags::UNARY },
+        { TerminalTokenType::INT, "INT" },
+        { TerminalTokenType::FLOAT, "FLOAT" },
+        { TerminalTokenType::STRING, "STRING" },
+        { TerminalTokenType::NEWLINE, "NEWLINE" },
+        { TerminalTokenType::COMMENTVAL, "COMMENTVAL" },
+        { TerminalTokenType::SELF, "SELF", "self", TokenKind::KEYWORD },
+        { TerminalTokenType::ATTRIBUTE_START, "ATTRIBUTE_START", "#[", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::GLOBAL_ATTRIBUTE_START, "GLOBAL_ATTRIBUTE_START", "#!", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::ASYNC, "ASYNC", "async", TokenKind::KEYWORD },
+        { TerminalTokenType::AWAIT, "AWAIT", "await", TokenKind::KEYWORD },
+        { TerminalTokenType::PUB, "PUB", "pub", TokenKind::KEYWORD },
+        { TerminalTokenType::CRATE, "CRATE", "crate", TokenKind::KEYWORD },
+        { TerminalTokenType::SUPER, "SUPER", "super", TokenKind::KEYWORD },
+        { TerminalTokenType::MOD, "MOD", "mod", TokenKind::KEYWORD },
+        { TerminalTokenType::AS, "AS", "as", TokenKind::KEYWORD },
+        { TerminalTokenType::STATIC, "STATIC", "static", TokenKind::KEYWORD },
+        { TerminalTokenType::REF, "REF", "ref", TokenKind::KEYWORD },
+        { TerminalTokenType::TRUE, "TRUE", "true", TokenKind::KEYWORD },
+        { TerminalTokenType::FALSE, "FALSE", "false", TokenKind::KEYWORD },
+        { TerminalTokenType::PLUS_EQUAL, "PLUS_EQUAL", "+=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::MINUS_EQUAL, "MINUS_EQUAL", "-=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::STAR_EQUAL, "STAR_EQUAL", "*=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::SLASH_EQUAL, "SLASH_EQUAL", "/=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::PRECENTAGE_EQUAL, "PRECENTAGE_EQUAL", "%=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::AND_EQUAL, "AND_EQUAL", "&=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::OR_EQUAL, "OR_EQUAL", "|=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::XOR_EQUAL, "XOR_EQUAL", "^=", TokenKind::PUNCTUATOR, token_flags::ASSIGNMENT },
+        { TerminalTokenType::PRECENTAGE, "PRECENTAGE", "%", TokenKind::PUNCTUATOR },
+        { TerminalTokenType::RETURN, "RETURN", "return", TokenKind::KEYWORD },
+        { TerminalTokenType::ERROR, "ERROR" },
+        { TerminalTokenType::MAX_NUM, "MAX_NUM" },
+    };
+
+    inline constexpr size_t token_type_count = static_cast<size_t>(TerminalTokenType::MAX_NUM) + 1;
+
+    /**
+     * @brief Per-type attributes folded from token_specs, indexed by TerminalTokenType
+     */
+    struct TokenTypeInfo {
+        const char* name = nullptr;
+        uint8_t flags = 0;
+    };
+
+    inline constexpr std::array<TokenTypeInfo, token_type_count> token_type_infos = [] {
+        std::array<TokenTypeInfo, token_type_count> infos{};
+        for (const TokenSpec& spec : token_specs) {
+            TokenTypeInfo& info = infos[static_cast<size_t>(spec.type)];
+            info.name = info.name ? info.name : spec.name;
+            info.flags |= spec.flags;
+        }
+        return infos;
+    }();
+
+    static_assert([] {
+        for (const TokenTypeInfo& info : token_type_infos) {
+            if (info.name == nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }(), "Every TerminalTokenType needs an entry in token_specs");
+
+    /**
+     * @brief Longest-match recognizer of the punctuators of token_specs, built at compile time.
+     * Bytes are first mapped to a handful of classes, so the transition table is dense and small:
+     * matching costs two table loads per byte and no branch per operator.
+     */
+    class PunctuatorDfa {
+    public:
+        static constexpr size_t MAX_STATES = 64;
+        static constexpr size_t MAX_CLASSES = 32;
+
+        struct Match {
+            // NONE if no punctuator starts here
+            TerminalTokenType type = TerminalTokenType::NONE;
+            size_t length = 0;
+        };
+
+        constexpr PunctuatorDfa() {
+            // Class 0 is every byte which belongs to no punctuator, state 0 the start state.
+            // No transition leads back to the start, so 0 also means "no transition".
+            for (const TokenSpec& spec : token_specs) {
+                if (spec.kind != TokenKind::PUNCTUATOR) {
+                    continue;
+                }
+
+                uint8_t state = 0;
+                for (char c : spec.spelling) {
+                    uint8_t& char_class = m_classes[static_cast<unsigned char>(c)];
+                    if (char_class == 0) {
+                        if (m_class_count == MAX_CLASSES) {
+                            return;
+                        }
+                        char_class = static_cast<uint8_t>(m_class_count++);
+                    }
+
+                    uint8_t& next = m_next[state][char_class];
+                    if (next == 0) {
+                        if (m_state_count == MAX_STATES) {
+                            return;
+                        }
+                        next = static_cast<uint8_t>(m_state_count++);
+                    }
+                    state = next;
+                }
+
+                if (m_accept[state] != TerminalTokenType::NONE) {
+                    return;
+                }
+                m_accept[state] = spec.type;
+            }
+            m_is_valid = true;
+        }
+
+        /**
+         * @brief False if the tables are too small or two punctuators share a spelling
+         */
+        constexpr bool is_valid() const {
+            return m_is_valid;
+        }
+
+        constexpr size_t state_count() const {
+            return m_state_count;
+        }
+
+        /**
+         * @brief The longest punctuator starting at `p`, without reading at or past `end`
+         */
+        constexpr Match match(const char* p, const char* end) const {
+            Match longest;
+            uint8_t state = 0;
+            for (const char* cursor = p; cursor < end; ++cursor) {
+                state = m_next[state][m_classes[static_cast<unsigned char>(*cursor)]];
+                if (state == 0) {
+                    break;
+                }
+                if (m_accept[state] != TerminalTokenType::NONE) {
+                    longest = { m_accept[state], static_cast<size_t>(cursor - p + 1) };
+                }
+            }
+            return longest;
+        }
+
+        constexpr Match match(std::string_view text) const {
+            return match(text.data(), text.data() + text.size());
+        }
+
+    private:
+        std::array<uint8_t, 256> m_classes{};
+        std::array<std::array<uint8_t, MAX_CLASSES>, MAX_STATES> m_next{};
+        std::array<TerminalTokenType, MAX_STATES> m_accept{};
+        size_t m_class_count = 1;
+        size_t m_state_count = 1;
+        bool m_is_valid = false;
+    };
+
+    inline constexpr PunctuatorDfa punctuator_dfa{};
+
+    static_assert(punctuator_dfa.is_valid(), "Punctuator DFA doesn't fit, enlarge PunctuatorDfa::MAX_STATES or MAX_CLASSES");
+    static_assert(punctuator_dfa.match("..=").type == TerminalTokenType::RANGEEQ && punctuator_dfa.match("..=").length == 3);
+    static_assert(punctuator_dfa.match("..x").type == TerminalTokenType::RANGE && punctuator_dfa.match("..x").length == 2);
+    static_assert(punctuator_dfa.match("-->").type == TerminalTokenType::MINUSMINUS);
+    static_assert(punctuator_dfa.match("a").type == TerminalTokenType::NONE);
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     * Pages are loaded by the OS on first access, nothing is copied.
+     */
+    class LUSTFRONTEND_API MappedFile final {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Map `path` (UTF-8), check is_open() for the result
+         * @note An empty file opens successfully with an empty text()
+         */
+        static MappedFile open(const char* path);
+
+        bool is_open() const;
+
+        /**
+         * @brief The mapped bytes, valid until the mapping is closed. Moving the mapping keeps the view valid.
+         */
+        std::string_view text() const;
+
+        void close();
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        bool m_is_open = false;
+#if defined(_WIN32)
+        void* m_file_handle = nullptr;
+        void* m_mapping_handle = nullptr;
+#endif
+    };
+}
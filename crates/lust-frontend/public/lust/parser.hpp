@@ -2,12 +2,37 @@
 
 #include "lexer.hpp"
 #include "grammar.hpp"
+#include "grammar/flat_ast.hpp"
 #include "container/unique_ptr.hpp"
 
 namespace lust
 {
 namespace grammar
 {
+    /**
+     * A parsed program with the arena holding its nodes, dropping it frees the whole tree at once
+     */
+    class LUSTFRONTEND_API Ast {
+    public:
+        Ast() noexcept = default;
+        Ast(AstArena&& arena, AstArena&& literal_arena, AstPtr<ASTNode_Program> program) noexcept;
+
+        ASTNode_Program* get() const noexcept { return m_program.get(); }
+        ASTNode_Program* operator->() const noexcept { return m_program.get(); }
+        ASTNode_Program& operator*() const noexcept { return *m_program; }
+        explicit operator bool() const noexcept { return !m_program.is_null(); }
+
+        const AstArena& arena() const noexcept { return m_arena; }
+        /**
+         * @brief Decoded text of the string literals, see ASTNode_StringExpr::value
+         */
+        const AstArena& literal_arena() const noexcept { return m_literal_arena; }
+
+    private:
+        AstArena m_arena;
+        AstArena m_literal_arena;
+        AstPtr<ASTNode_Program> m_program;
+    };
 
     class LUSTFRONTEND_API IParser {
     public:
@@ -15,10 +40,21 @@ namespace grammar
 
         static lust::UniquePtr<IParser> create(lexer::TokenStream& token_stream);
 
+        /**
+         * @brief Parse from a pre-lexed token buffer, tokens are consumed by index without any virtual call
+         * @note `token_buffer` must outlive the parser
+         */
+        static lust::UniquePtr<IParser> create(const lexer::TokenBuffer& token_buffer);
+
         /**
          * Starting to parse token stream into AST
          */
-        virtual lust::UniquePtr<ASTNode_Program> parse() = 0;
+        virtual Ast parse() = 0;
+
+        /**
+         * Parse into the flat encoding, the node tree is only scaffolding and is freed before returning
+         */
+        virtual FlatAst parse_flat() = 0;
 
         /**
          * Check does error occurred during parsing
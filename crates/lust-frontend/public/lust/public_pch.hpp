@@ -15,6 +15,14 @@ extern "C" {
     bool lust_is_digit(char c);
     bool lust_is_alnum(char c);
 
+    /**
+     * @brief Decode the code point at `str[i]` of a NUL terminated string, `i` is left on its last byte
+     */
     uint32_t lust_decode_utf8(const char* str, size_t& i, bool& success);
 
+    /**
+     * @brief Same as lust_decode_utf8() for a string of `length` bytes, which needs no terminator
+     */
+    uint32_t lust_decode_utf8_n(const char* str, size_t length, size_t& i, bool& success);
+
 }
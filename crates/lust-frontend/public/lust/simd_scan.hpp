@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include "lustfrontend_export.h"
+#include "container/vector.hpp"
+
+namespace lust
+{
+namespace simd
+{
+    enum class SimdLevel : uint32_t {
+        SCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    LUSTFRONTEND_API extern const char* simd_level_to_name(SimdLevel level);
+
+    /**
+     * @brief The best level supported by the running CPU, detected via cpuid
+     */
+    LUSTFRONTEND_API extern SimdLevel detect_simd_level();
+
+    /**
+     * @brief The level used by the scanning functions below, defaults to detect_simd_level()
+     */
+    LUSTFRONTEND_API extern SimdLevel get_simd_level();
+
+    /**
+     * @brief Force a lower level, mostly useful for testing and benchmarking.
+     * @note A level the CPU doesn't support is clamped to detect_simd_level()
+     */
+    LUSTFRONTEND_API extern void set_simd_level(SimdLevel level);
+
+    /**
+     * @brief Find the first byte in [begin, end) which doesn't belong to `char_class_mask`, `end` if none
+     * @note Runs of SPACE, DIGIT and IDENT_CONTINUE are vectorized, other masks use the scalar loop
+     */
+    LUSTFRONTEND_API extern const char* skip_char_class(const char* begin, const char* end, uint8_t char_class_mask);
+
+    /**
+     * @brief Find the first '\n' or '\r' in [begin, end), `end` if none
+     */
+    LUSTFRONTEND_API extern const char* find_line_break(const char* begin, const char* end);
+
+    /**
+     * @brief Find the first '"' or '\\' in [begin, end), `end` if none
+     */
+    LUSTFRONTEND_API extern const char* find_quote_or_escape(const char* begin, const char* end);
+
+    /**
+     * @brief Append the offset from `begin` of the byte following every '\n' in [begin, end) to `line_starts`
+     */
+    LUSTFRONTEND_API extern void collect_line_starts(const char* begin, const char* end, vector<int64_t>& line_starts);
+
+    /**
+     * @brief Find the first byte of the first invalid UTF-8 sequence in [begin, end), `end` if the text is valid
+     * @note AVX2 validates 32 bytes per step with the lookup algorithm of simdjson, SSE2 only skips ASCII blocks
+     */
+    LUSTFRONTEND_API extern const char* find_invalid_utf8(const char* begin, const char* end);
+}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "lexer.hpp"
+#include "container/vector.hpp"
+
+namespace lust
+{
+namespace lexer
+{
+    /**
+     * @brief Line-start index of a source buffer, positions are resolved to lines with a binary search.
+     * The index is built on the first query with one vectorized pass over the source.
+     * @note Lazy building isn't thread safe, call line_count() once before sharing a map between threads
+     */
+    class LUSTFRONTEND_API SourceMap final {
+    public:
+        SourceMap() = default;
+        explicit SourceMap(std::string_view source);
+
+        std::string_view source() const;
+
+        /**
+         * @brief Lines are separated by '\n', a trailing '\n' starts an empty last line
+         */
+        size_t line_count() const;
+
+        /**
+         * @brief Offset of the first byte of the 0-based `line_index`
+         */
+        int64_t line_start(size_t line_index) const;
+
+        /**
+         * @brief 1-based line and byte column of `pos`, line and row stay -1 if `pos` isn't in [0, source().size()]
+         * @note A '\n' belongs to the line it ends
+         */
+        SourceLoc locate(int64_t pos) const;
+
+    private:
+        void ensure_built() const;
+
+        std::string_view m_source;
+        // Empty until built, then starts with 0
+        mutable vector<int64_t> m_line_starts;
+    };
+}
+}
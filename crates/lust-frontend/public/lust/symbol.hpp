@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+    /**
+     * @brief A string interned in SymbolTable::global(), equal strings get equal symbols.
+     * Comparing two symbols is an integer compare. Ids are dense, 0 is the empty string.
+     */
+    struct Symbol {
+        uint32_t id = 0;
+
+        constexpr bool empty() const { return id == 0; }
+
+        constexpr bool operator==(const Symbol& other) const { return id == other.id; }
+        constexpr bool operator!=(const Symbol& other) const { return id != other.id; }
+
+        /**
+         * @brief The interned text, valid for the lifetime of the program
+         */
+        LUSTFRONTEND_API std::string_view str() const;
+    };
+
+    /**
+     * @brief Concurrent string interner handing out dense 32-bit ids.
+     * Lookups are spread over sharded hash maps, each behind its own mutex, so lexers on
+     * several threads can intern into the same table. Resolving a symbol takes no lock.
+     * @note Interned strings are never freed
+     */
+    class LUSTFRONTEND_API SymbolTable final {
+    public:
+        SymbolTable();
+        ~SymbolTable();
+
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        /**
+         * @brief The table shared by the lexers and the parser
+         */
+        static SymbolTable& global();
+
+        /**
+         * @brief The table of decoded string literals, kept apart so identifier ids stay dense
+         */
+        static SymbolTable& literals();
+
+        /**
+         * @brief The symbol of `text`, the text is copied on its first occurrence. Thread safe.
+         */
+        Symbol intern(std::string_view text);
+
+        /**
+         * @brief Text of a symbol handed out by this table. Thread safe.
+         */
+        std::string_view resolve(Symbol symbol) const;
+
+        /**
+         * @brief The interned copy of `text`, valid for the lifetime of the table. Thread safe.
+         */
+        std::string_view intern_text(std::string_view text) { return resolve(intern(text)); }
+
+        /**
+         * @brief Number of distinct strings, the empty string included
+         */
+        size_t size() const;
+
+    private:
+        struct Impl;
+        Impl* m_impl;
+    };
+
+    /**
+     * @brief SymbolTable::global().intern(text)
+     */
+    LUSTFRONTEND_API extern Symbol intern(std::string_view text);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "lexer.hpp"
+#include "symbol.hpp"
+#include "container/unique_ptr.hpp"
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+namespace lexer
+{
+    /**
+     * @brief Fixed-capacity lookahead window between a token source and the parser.
+     * Tokens are pulled in batches into a ring of CAPACITY slots, so peek(n) never lexes a token twice and never allocates.
+     * COMMENTVAL tokens are dropped on the way in. Once END is pulled, it is repeated forever.
+     * @note The source must outlive the ring. A streaming tokenizer is pulled one token at a time and the values
+     * of its IDENT and STRING tokens are copied out of its window, they stay valid as long as the ring.
+     * Other values from a stream keep the lifetime rule of ITokenizer::create_from_reader().
+     */
+    class LUSTFRONTEND_API TokenRing final {
+    public:
+        // A power of two, peek(n) supports n < CAPACITY
+        static constexpr size_t CAPACITY = 32;
+
+        /**
+         * @brief Position of the next token to consume, see checkpoint()
+         */
+        struct Checkpoint {
+            // Tokens consumed before the checkpoint
+            uint64_t consumed = 0;
+            // Where the source resumes to lex that token again: its first char, or its index for a token buffer
+            TokenizerState state;
+        };
+
+        explicit TokenRing(TokenStream& token_stream);
+        explicit TokenRing(const TokenBuffer& token_buffer);
+
+        TokenRing(const TokenRing&) = delete;
+        TokenRing& operator=(const TokenRing&) = delete;
+
+        /**
+         * @brief The `n`-th token which hasn't been consumed yet, 0 is the next one
+         */
+        const Token& peek(size_t n = 0);
+
+        /**
+         * @brief Pop the next token
+         */
+        Token consume();
+
+        /**
+         * @brief Capture the position of peek(0), a few integer copies
+         */
+        Checkpoint checkpoint();
+
+        /**
+         * @brief Make the token at `checkpoint` the next one again.
+         * Tokens still held by the ring are given back without lexing, otherwise the source is rewound.
+         * @return false if the source can't go back that far, see ITokenizer::restore_state()
+         */
+        bool rollback(const Checkpoint& checkpoint);
+
+        /**
+         * @brief Text the token positions refer to, see ITokenizer::original_text()
+         */
+        std::string_view source_text() const;
+
+        /**
+         * @brief Offset of source_text() in the whole input, non-zero only for a streaming tokenizer which moved its window
+         */
+        int64_t source_text_offset() const;
+
+    private:
+        /**
+         * @brief Pull batches until at least `wanted` tokens are buffered or the source ended
+         */
+        void fill(size_t wanted);
+
+        /**
+         * @brief Pull at most `max_count` tokens into `out`, END included. `states` receives where each one starts.
+         */
+        size_t pull(Token* out, TokenizerState* states, size_t max_count);
+
+        /**
+         * @brief Point the value of a token from a streaming tokenizer at a copy, before the window moves
+         */
+        void keep_value(Token& token);
+
+        // Exactly one of the token sources is set
+        TokenStream* m_token_stream = nullptr;
+        const TokenBuffer* m_token_buffer = nullptr;
+        size_t m_buffer_index = 0;
+        bool m_is_streaming = false;
+        // Copies of the string literals pulled from a streaming tokenizer, created on the first one
+        UniquePtr<SymbolTable> m_stream_literals;
+
+        Token m_tokens[CAPACITY]{};
+        // Source state to lex each buffered token again
+        TokenizerState m_states[CAPACITY]{};
+        size_t m_head = 0;
+        size_t m_count = 0;
+        // Consumed tokens right before the head whose slots haven't been refilled yet
+        size_t m_retained = 0;
+        uint64_t m_consumed = 0;
+
+        // Type of the last token pulled from the source, comments included
+        TerminalTokenType m_last_pulled_type = TerminalTokenType::NONE;
+
+        bool m_end_pulled = false;
+        Token m_end_token{};
+        TokenizerState m_end_state{};
+    };
+}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "lustfrontend_export.h"
+
+namespace lust
+{
+namespace utf8
+{
+    /**
+     * @brief Decode the code point starting at `p` without reading at or past `end`.
+     * Overlong forms, surrogates and code points above U+10FFFF are rejected.
+     * @return Length of the sequence in bytes, 0 if it is invalid or cut by `end`
+     */
+    constexpr size_t decode(const char* p, const char* end, uint32_t& code_point) {
+        if (p >= end) {
+            return 0;
+        }
+
+        const uint8_t lead = static_cast<uint8_t>(p[0]);
+        if (lead < 0x80) {
+            code_point = lead;
+            return 1;
+        }
+
+        size_t length = 0;
+        // Valid range of the second byte, it rules out overlong forms, surrogates and values above U+10FFFF
+        uint8_t second_lo = 0x80;
+        uint8_t second_hi = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+            code_point = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            code_point = lead & 0x0F;
+            second_lo = lead == 0xE0 ? 0xA0 : 0x80;
+            second_hi = lead == 0xED ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            code_point = lead & 0x07;
+            second_lo = lead == 0xF0 ? 0x90 : 0x80;
+            second_hi = lead == 0xF4 ? 0x8F : 0xBF;
+        } else {
+            return 0;
+        }
+
+        if (end - p < static_cast<ptrdiff_t>(length)) {
+            return 0;
+        }
+
+        // Bytes are checked in order, a NUL terminator stops the decoding before anything behind it is read
+        for (size_t i = 1; i < length; ++i) {
+            const uint8_t c = static_cast<uint8_t>(p[i]);
+            const bool valid = i == 1 ? (c >= second_lo && c <= second_hi) : (c & 0xC0) == 0x80;
+            if (!valid) {
+                return 0;
+            }
+            code_point = (code_point << 6) | (c & 0x3F);
+        }
+
+        return length;
+    }
+
+    /**
+     * @brief Encode a scalar value (not a surrogate, at most U+10FFFF) to `out`, which holds at least 4 bytes
+     * @return Length of the sequence in bytes
+     */
+    constexpr size_t encode(uint32_t code_point, char* out) {
+        if (code_point < 0x80) {
+            out[0] = static_cast<char>(code_point);
+            return 1;
+        }
+        if (code_point < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+            out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 2;
+        }
+        if (code_point < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+            out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+
+    /**
+     * @brief Unicode identifier classes (UAX #31) backed by range tables.
+     * ASCII follows char_class.hpp, so '_' starts an identifier too.
+     */
+    LUSTFRONTEND_API extern bool is_xid_start(uint32_t code_point);
+    LUSTFRONTEND_API extern bool is_xid_continue(uint32_t code_point);
+}
+}
@@ -0,0 +1,90 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/grammar/ast_arena.hpp"
+#include "lust/symbol.hpp"
+
+#include <cstdint>
+
+const char test_data[] = R"LUST(
+fn add(a: i32, b: i32) -> i32 {
+    let sum = a + b;
+}
+let call = make<i32>(a, b);
+let less = a < b;
+)LUST";
+
+void entry() {
+    using namespace lust;
+    using namespace lust::grammar;
+
+    AstArena arena;
+    TEST_CHECK_OK_MSG(arena.block_count() == 0 && arena.bytes_reserved() == 0, "An empty arena shouldn't own memory.");
+
+    AstPtr<ASTNode_Attribute> attribute = arena.make<ASTNode_Attribute>();
+    TEST_CHECK_OK_MSG(attribute && arena.block_count() == 1, "make() should allocate the first block.");
+    AstPtr<IASTNode> base = attribute;
+    TEST_CHECK_OK_MSG(base.get() == attribute.get(), "Upcasting an AstPtr should keep the address.");
+
+    for (size_t alignment : { size_t(1), size_t(8), size_t(64) }) {
+        void* p = arena.allocate(3, alignment);
+        TEST_CHECK_OK_MSG(reinterpret_cast<uintptr_t>(p) % alignment == 0, "allocate() ignored the alignment " << alignment);
+    }
+
+    // Everything after a mark is given back, the next allocation reuses the space
+    const AstArena::Mark mark = arena.mark();
+    void* first = arena.allocate(16, 8);
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate(AstArena::BLOCK_SIZE / 2, 8);
+    }
+    TEST_CHECK_OK_MSG(arena.block_count() > 1, "Filling a block should chain a new one.");
+    arena.rollback(mark);
+    TEST_CHECK_OK_MSG(arena.block_count() == 1, "rollback() should free the blocks after the mark.");
+    TEST_CHECK_OK_MSG(arena.allocate(16, 8) == first, "rollback() should rewind the cursor.");
+
+    // Oversized requests get a block of their own
+    void* big = arena.allocate(AstArena::BLOCK_SIZE * 2, 16);
+    TEST_CHECK_OK_MSG(big != nullptr && arena.bytes_reserved() >= AstArena::BLOCK_SIZE * 3, "Oversized allocation failed.");
+
+    // Lists keep N elements in place then spill into the arena
+    AstList<uint32_t, 2> list;
+    list.push_back(arena, 1);
+    list.push_back(arena, 2);
+    TEST_CHECK_OK_MSG(list.is_inline() && list.size() == 2, "Two elements should fit in place.");
+    for (uint32_t i = 3; i <= 100; ++i) {
+        list.push_back(arena, list[0] + i - 1);
+    }
+    bool ordered = !list.is_inline() && list.size() == 100;
+    for (uint32_t i = 0; ordered && i < 100; ++i) {
+        ordered = list[i] == i + 1;
+    }
+    TEST_CHECK_OK_MSG(ordered, "Spilled list lost its order.");
+
+    // Two symbols share the space of the heap pointer, appending an element of the list itself while it spills
+    AstList<Symbol, 2> symbols;
+    static_assert(sizeof(symbols) == 16, "Two symbols should fit in the space of the heap pointer");
+    symbols.push_back(arena, intern("a"));
+    symbols.push_back(arena, intern("b"));
+    TEST_CHECK_OK_MSG(symbols.data() == reinterpret_cast<Symbol*>(reinterpret_cast<char*>(&symbols) + 8), "Two symbols should be stored inline.");
+    symbols.push_back(arena, symbols[0]);
+    TEST_CHECK_OK_MSG(!symbols.is_inline() && symbols.size() == 3 && symbols.back().str() == "a" && symbols[1].str() == "b",
+        "Appending an element of the list itself failed.");
+
+    AstList<uint32_t> tail;
+    tail.extend(arena, list);
+    TEST_CHECK_OK_MSG(tail.size() == 100 && tail.back() == 100, "extend() failed.");
+
+    AstArena moved(std::move(arena));
+    TEST_CHECK_OK_MSG(arena.block_count() == 0 && moved.block_count() > 0, "Moving an arena should hand over its blocks.");
+
+    // The parsed tree owns its arena
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+    lexer::TokenStream tokens = lexer::ITokenizer::create(source);
+    Ast program = IParser::create(tokens)->parse();
+    TEST_CHECK_OK_MSG(program && program->statements.size() == 3, "Parsing into the arena failed.");
+    TEST_CHECK_OK_MSG(program.arena().block_count() == 1, "A small program should fit in one block.");
+
+    Ast taken = std::move(program);
+    TEST_CHECK_OK_MSG(taken && taken->statements.size() == 3, "Moving an Ast should keep its nodes.");
+}
@@ -0,0 +1,114 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/grammar/ast_visitor.hpp"
+#include "lust/grammar/flat_ast.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Every allocation of the process is counted, walking the tree must not add any
+static std::atomic<size_t> g_allocations{ 0 };
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using namespace lust::grammar;
+
+size_t count_nodes(const IASTNode* node) {
+    size_t count = 1;
+    node->for_each_child([&count] (const IASTNode* child) {
+        count += count_nodes(child);
+    });
+    return count;
+}
+
+struct KindCounter : ASTVisitor<KindCounter> {
+    size_t nodes = 0;
+    size_t integers = 0;
+    size_t operators = 0;
+    size_t statements = 0;
+
+    void visit_node(const IASTNode& node) {
+        ++nodes;
+        visit_children(node);
+    }
+
+    void visit_integer_literal(const ASTNode_IntegerExpr& node) {
+        ++integers;
+        visit_operator(node);
+    }
+
+    // Literals and names reach here through the default forwarding
+    void visit_operator(const ASTNode_Operator& node) {
+        ++operators;
+        visit_node(node);
+    }
+
+    void visit_statement(const ASTNode_Statement& node) {
+        ++statements;
+        visit_node(node);
+    }
+};
+
+void entry() {
+    std::string source;
+    for (size_t i = 0; i < 180000; ++i) {
+        source += "let qa = qb + 1 * qc;\n";
+    }
+    source += "fn qf(qx: u8) -> u8 {\n    let qy = { qx + 2 };\n}\n";
+
+    lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create(source);
+    lust::UniquePtr<IParser> parser = IParser::create(tokens);
+    const Ast program = parser->parse();
+    TEST_MUST_BE_FALSE_MSG(parser->is_error_occurred(), "Test source should parse.");
+    const FlatAst flat = FlatAst::build(*program);
+
+    size_t flat_integers = 0;
+    size_t flat_operators = 0;
+    size_t flat_statements = 0;
+    for (NodeIndex node = 0; node < flat.size(); ++node) {
+        flat_integers += flat.kind(node) == GrammarRule::INTEGER_LITERAL;
+        flat_operators += flat.operator_type(node) != OperatorType::INVALID;
+        switch (flat.kind(node)) {
+            case GrammarRule::STATEMENT:
+            case GrammarRule::EXPR_STATEMENT:
+            case GrammarRule::VAR_DECL:
+            case GrammarRule::FUNCTION_DECL:
+            case GrammarRule::BLOCK:
+            case GrammarRule::EXPRESSION:
+                ++flat_statements;
+                break;
+            default:
+                break;
+        }
+    }
+
+    const size_t allocations_before = g_allocations.load();
+    const size_t counted = count_nodes(program.get());
+    KindCounter counter;
+    counter.visit(program.get());
+    const size_t allocations = g_allocations.load() - allocations_before;
+
+    TEST_CHECK_OK_MSG(counted >= 1000000, "Test tree is too small: " << counted << " nodes");
+    TEST_CHECK_OK_MSG(allocations == 0, "Walking the tree allocated " << allocations << " times");
+    TEST_CHECK_OK_MSG(counted == flat.size() && counter.nodes == counted, "for_each_child() and ASTVisitor disagree on the node count");
+    TEST_CHECK_OK_MSG(counter.integers == flat_integers && counter.operators == flat_operators, "Static dispatch reached the wrong overloads");
+    TEST_CHECK_OK_MSG(counter.statements == flat_statements, "Statement overloads are not forwarded");
+}
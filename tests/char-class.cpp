@@ -0,0 +1,32 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/public_pch.hpp"
+#include "lust/char_class.hpp"
+
+#include <cctype>
+#include <clocale>
+
+void entry() {
+    std::setlocale(LC_CTYPE, "C");
+
+    // The exported C entry points keep the answers of <cctype> in the C locale
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        const char c = static_cast<char>(byte);
+        const bool space = std::isspace(static_cast<int>(byte)) != 0;
+        const bool alpha = !(space || std::ispunct(static_cast<int>(byte)) || std::iscntrl(static_cast<int>(byte)));
+        const bool digit = std::isdigit(static_cast<int>(byte)) != 0;
+        const bool alnum = std::isalnum(static_cast<int>(byte)) != 0;
+
+        TEST_CHECK_OK_MSG(lust_is_space(c) == space, "lust_is_space() differs for byte " << byte);
+        TEST_CHECK_OK_MSG(lust_is_alpha(c) == alpha, "lust_is_alpha() differs for byte " << byte);
+        TEST_CHECK_OK_MSG(lust_is_digit(c) == digit, "lust_is_digit() differs for byte " << byte);
+        TEST_CHECK_OK_MSG(lust_is_alnum(c) == alnum, "lust_is_alnum() differs for byte " << byte);
+
+        TEST_CHECK_OK_MSG(lust::is_space(c) == space && lust::is_digit(c) == digit, "Inline predicates differ for byte " << byte);
+    }
+
+    // The lexer's classes, which deliberately differ from <cctype>
+    TEST_CHECK_OK_MSG(!lust::is_alpha('7') && lust::is_alnum('7'), "Digits are not letters.");
+    TEST_CHECK_OK_MSG(lust::is_alpha('\xC3') && lust::is_alnum('\xC3'), "UTF-8 bytes are letters for the lexer.");
+    TEST_CHECK_OK_MSG(lust::is_ident_start('_') && !lust::is_ident_start('1') && lust::is_ident_continue('1'), "Identifier classes are not correct.");
+}
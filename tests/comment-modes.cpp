@@ -0,0 +1,152 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using lust::lexer::CommentMode;
+using lust::lexer::TerminalTokenType;
+
+const char test_data[] = R"LUST(
+/// Entry point
+// of the program
+fn main() {
+    let a = 1; // trailing
+    let b = a / 2;
+    //
+}
+// last line without a break)LUST";
+
+lust::lexer::TokenizerOptions options_of(CommentMode mode) {
+    lust::lexer::TokenizerOptions options;
+    options.comments = mode;
+    return options;
+}
+
+struct LexResult {
+    std::vector<lust::lexer::Token> tokens;
+    std::vector<lust::lexer::Token> comments;
+};
+
+LexResult lex(lust::lexer::TokenStream& stream) {
+    LexResult result;
+    while (true) {
+        const lust::lexer::Token token = stream->next_token();
+        TEST_CHECK_OK_MSG(token.type != TerminalTokenType::ERROR, "Unexpected error: " << token.value);
+        (token.type == TerminalTokenType::COMMENTVAL ? result.comments : result.tokens).push_back(token);
+        if (token.type == TerminalTokenType::END) {
+            return result;
+        }
+    }
+}
+
+void check_same_tokens(const std::vector<lust::lexer::Token>& a, const std::vector<lust::lexer::Token>& b, const char* what) {
+    TEST_CHECK_OK_MSG(a.size() == b.size(), what << ": token count mismatched, " << a.size() << " vs " << b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        TEST_CHECK_OK_MSG(a[i].type == b[i].type && a[i].pos == b[i].pos, what << ": token " << i << " mismatched");
+    }
+}
+
+void check_table(const lust::lexer::CommentTable& table, const std::vector<lust::lexer::Token>& expected, std::string_view source, const char* what) {
+    TEST_CHECK_OK_MSG(table.size() == expected.size(), what << ": " << table.size() << " comments recorded, " << expected.size() << " expected");
+    for (size_t i = 0; i < expected.size(); ++i) {
+        TEST_CHECK_OK_MSG(table.span_at(i).pos == expected[i].pos && table.text_at(i, source) == expected[i].value,
+            what << ": comment " << i << " mismatched");
+    }
+}
+
+void entry() {
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+
+    lust::lexer::TokenStream emit = lust::lexer::ITokenizer::create(source);
+    const LexResult emitted = lex(emit);
+    TEST_CHECK_OK_MSG(emitted.comments.size() == 5 && emitted.comments[0].value == "/ Entry point", "EMIT should produce the comment tokens");
+    TEST_CHECK_OK_MSG(emit->comments().empty(), "EMIT records nothing");
+
+    lust::lexer::TokenStream skip = lust::lexer::ITokenizer::create(source, options_of(CommentMode::SKIP));
+    const LexResult skipped = lex(skip);
+    TEST_CHECK_OK_MSG(skipped.comments.empty() && skip->comments().empty(), "SKIP emits and records nothing");
+    check_same_tokens(skipped.tokens, emitted.tokens, "SKIP");
+
+    lust::lexer::TokenStream record = lust::lexer::ITokenizer::create(source, options_of(CommentMode::RECORD));
+    const LexResult recorded = lex(record);
+    TEST_CHECK_OK_MSG(recorded.comments.empty(), "RECORD emits no comment token");
+    check_same_tokens(recorded.tokens, emitted.tokens, "RECORD");
+    check_table(record->comments(), emitted.comments, source, "RECORD");
+
+    // Doc comments of `fn` lie between the token before it and itself
+    {
+        const lust::lexer::CommentTable& table = record->comments();
+        const size_t first = table.lower_bound(0);
+        const size_t last = table.lower_bound(recorded.tokens[0].pos);
+        TEST_CHECK_OK_MSG(recorded.tokens[0].type == TerminalTokenType::FN && first == 0 && last == 2, "Expected two comments before `fn`");
+        TEST_CHECK_OK_MSG(table.find(emitted.comments[1].pos) == 1 && table.find(emitted.comments[1].pos + 1) == table.size(), "find() by offset");
+    }
+
+    // Rewinding doesn't record comments twice
+    {
+        lust::lexer::TokenStream rewound = lust::lexer::ITokenizer::create(source, options_of(CommentMode::RECORD));
+        const lust::lexer::TokenizerState start = rewound->save_state();
+        lex(rewound);
+        TEST_CHECK_OK_MSG(rewound->restore_state(start), "Rewinding to the start should succeed");
+        lex(rewound);
+        check_table(rewound->comments(), emitted.comments, source, "Rewound");
+    }
+
+    // Streaming and parallel lexing record the same table
+    std::string big_source;
+    for (int i = 0; i < 4000; ++i) {
+        big_source += "// comment " + std::to_string(i) + "\nlet a" + std::to_string(i) + " = " + std::to_string(i) + "; // tail\n";
+    }
+
+    lust::lexer::TokenStream emit_big = lust::lexer::ITokenizer::create(big_source);
+    const LexResult expected = lex(emit_big);
+
+    {
+        size_t offset = 0;
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader([&](char* buffer, size_t capacity) {
+            const size_t size = std::min<size_t>({ capacity, 100, big_source.size() - offset });
+            std::copy_n(big_source.data() + offset, size, buffer);
+            offset += size;
+            return size;
+        }, 256, options_of(CommentMode::RECORD));
+        check_same_tokens(lex(stream).tokens, expected.tokens, "Stream");
+        check_table(stream->comments(), expected.comments, big_source, "Stream");
+    }
+
+    // A run of skipped comments longer than the window, each of them fits
+    {
+        std::string comment_run;
+        for (int i = 0; i < 10; ++i) {
+            comment_run += "// twenty-five bytes #" + std::to_string(i) + ".\n";
+        }
+        comment_run += "let x = 1; // tail cut by the window end\nlet y = x;";
+
+        lust::lexer::TokenStream emit_run = lust::lexer::ITokenizer::create(comment_run);
+        const LexResult expected_run = lex(emit_run);
+        for (CommentMode mode : { CommentMode::SKIP, CommentMode::RECORD }) {
+            size_t offset = 0;
+            lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader([&](char* buffer, size_t capacity) {
+                const size_t size = std::min<size_t>(capacity, comment_run.size() - offset);
+                std::copy_n(comment_run.data() + offset, size, buffer);
+                offset += size;
+                return size;
+            }, 64, options_of(mode));
+            check_same_tokens(lex(stream).tokens, expected_run.tokens, "Comment run");
+            check_table(stream->comments(), mode == CommentMode::RECORD ? expected_run.comments : std::vector<lust::lexer::Token>(), comment_run, "Comment run");
+        }
+    }
+
+    {
+        lust::lexer::TokenStream parallel = lust::lexer::ITokenizer::create(big_source, options_of(CommentMode::RECORD));
+        const lust::lexer::TokenBuffer buffer = parallel->tokenize_all_parallel(4, 1024);
+        std::vector<lust::lexer::Token> tokens;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            tokens.push_back(buffer.token_at(i));
+        }
+        check_same_tokens(tokens, expected.tokens, "Parallel");
+        check_table(parallel->comments(), expected.comments, big_source, "Parallel");
+    }
+}
@@ -0,0 +1,153 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/grammar/flat_ast.hpp"
+
+#include <string>
+
+const char test_data[] = R"LUST(
+#[derive(Debug), inline]
+pub(crate) async fn foo<T: Display>(val: XXX<u8>, val2: Abc) -> () {
+    let a: u8 = 123;
+    let mut b: Option<AnyType> = make<i32>(a, "text") + 2 * 3;
+    let c = { a + 1.5 };
+    let d = core::mem::take(a);
+}
+
+const TEST = 123.5;
+
+struct Foo<T> {
+    val: T,
+    next: Box<Foo>,
+}
+)LUST";
+
+// Pre-order walk of the node tree, the shape the flat form must reproduce
+void check_node(const lust::grammar::FlatAst& flat, lust::grammar::NodeIndex& index, const lust::grammar::IASTNode* node, lust::grammar::NodeIndex parent) {
+    const lust::grammar::NodeIndex self = index++;
+    TEST_CHECK_OK_MSG(self < flat.size(), "Flat tree has fewer nodes than the node tree.");
+    TEST_CHECK_OK_MSG(flat.kind(self) == node->get_type(), "Node " << self << " has the wrong kind.");
+    TEST_CHECK_OK_MSG(std::string_view(flat.get_name(self)) == std::string_view(node->get_name()), "Node " << self << " has the wrong name.");
+    TEST_CHECK_OK_MSG(flat.parent(self) == parent, "Node " << self << " has the wrong parent.");
+
+    size_t children = 0;
+    for (const lust::grammar::IASTNode* child : node->collect_self_nodes()) {
+        if (child) {
+            check_node(flat, index, child, self);
+            ++children;
+        }
+    }
+    TEST_CHECK_OK_MSG(flat.subtree_end(self) == index, "Node " << self << " has the wrong subtree.");
+    TEST_CHECK_OK_MSG(flat.child_count(self) == children, "Node " << self << " has the wrong children.");
+}
+
+void entry() {
+    using namespace lust;
+    using namespace lust::grammar;
+
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+    lexer::TokenStream tokens = lexer::ITokenizer::create(source);
+    UniquePtr<IParser> parser = IParser::create(tokens);
+    Ast program = parser->parse();
+    TEST_MUST_BE_FALSE_MSG(parser->is_error_occurred(), "Test source should parse.");
+
+    const FlatAst flat = FlatAst::build(*program);
+    NodeIndex index = 0;
+    check_node(flat, index, program.get(), NO_NODE);
+    TEST_CHECK_OK_MSG(index == flat.size(), "Flat tree has more nodes than the node tree.");
+
+    // Payloads
+    std::string idents;
+    size_t integer_sum = 0;
+    bool seen_float = false;
+    bool seen_string = false;
+    bool seen_mutable = false;
+    bool seen_async = false;
+    for (NodeIndex node = 0; node < flat.size(); ++node) {
+        switch (flat.kind(node)) {
+            case GrammarRule::VAR_DECL:
+            case GrammarRule::FUNCTION_DECL:
+            case GrammarRule::STRUCT:
+            case GrammarRule::PARAMETER:
+                idents += flat.identifier(node).str();
+                idents += ' ';
+                seen_async |= flat.kind(node) == GrammarRule::FUNCTION_DECL && (flat.flags(node) & FLAT_ASYNC);
+                seen_mutable |= flat.kind(node) == GrammarRule::VAR_DECL && (flat.flags(node) & FLAT_MUTABLE);
+                break;
+            case GrammarRule::INTEGER_LITERAL:
+                integer_sum += flat.integer_value(node);
+                break;
+            case GrammarRule::FLOAT_LITERAL:
+                seen_float |= flat.float_value(node) == 1.5;
+                break;
+            case GrammarRule::STRING_LITERAL:
+                seen_string |= flat.string_value(node) == "text";
+                break;
+            default:
+                break;
+        }
+    }
+    TEST_CHECK_OK_MSG(idents == "foo val val2 a b c d TEST Foo ", "Identifiers are not correct: " << idents);
+    TEST_CHECK_OK_MSG(integer_sum == 123 + 2 + 3, "Integer literals are not correct.");
+    TEST_CHECK_OK_MSG(seen_float && seen_string && seen_mutable && seen_async, "Literal or flag payload lost.");
+
+    bool seen_inline = false;
+    for (NodeIndex node = 0; node < flat.size(); ++node) {
+        if (flat.kind(node) == GrammarRule::ATTRIBUTE) {
+            const std::span<const Symbol> name = flat.qualified_name(node);
+            seen_inline |= name.size() == 1 && name[0].str() == "inline" && flat.attribute_args(node).empty();
+        }
+        if (flat.kind(node) == GrammarRule::FUNCTION_DECL) {
+            TEST_CHECK_OK_MSG(flat.visibility(node) == Visibility::CRATE, "Visibility lost.");
+        }
+        if (flat.kind(node) == GrammarRule::GENERIC_PARAM && flat.constraint_count(node) == 1) {
+            TEST_CHECK_OK_MSG(flat.constraint(node, 0).back().str() == "Display", "Generic constraint lost.");
+        }
+        if (flat.type_kind(node) == TypeExprKind::GENERIC && flat.parent(node) != NO_NODE && flat.kind(flat.parent(node)) == GrammarRule::STRUCT_FIELD) {
+            TEST_CHECK_OK_MSG(flat.qualified_name(node).size() == 1 && flat.qualified_name(node)[0].str() == "Box", "Generic type name lost.");
+        }
+    }
+    TEST_CHECK_OK_MSG(seen_inline, "Attribute payload lost.");
+
+    // Sibling links cover the children of the root
+    size_t statements = 0;
+    for (NodeIndex child = flat.first_child(0); child != NO_NODE; child = flat.next_sibling(child)) {
+        statements += flat.kind(child) != GrammarRule::ATTRIBUTE;
+    }
+    TEST_CHECK_OK_MSG(statements == program->statements.size(), "Sibling links are not correct.");
+
+    // Backwards scan, operands are folded before the operator using them
+    vector<uint8_t> is_constant;
+    vector<uint64_t> value;
+    is_constant.resize(flat.size());
+    value.resize(flat.size());
+    uint64_t folded = 0;
+    for (NodeIndex node = static_cast<NodeIndex>(flat.size()); node-- > 0;) {
+        if (flat.kind(node) == GrammarRule::INTEGER_LITERAL) {
+            is_constant[node] = 1;
+            value[node] = flat.integer_value(node);
+        } else if (flat.operator_type(node) == OperatorType::ARITHMETIC_MULTIPLY && flat.child_count(node) == 2) {
+            const NodeIndex left = flat.first_child(node);
+            const NodeIndex right = flat.next_sibling(left);
+            if (is_constant[left] && is_constant[right]) {
+                is_constant[node] = 1;
+                value[node] = value[left] * value[right];
+                folded = value[node];
+            }
+        }
+    }
+    TEST_CHECK_OK_MSG(folded == 6, "Constant folding over the flat tree failed.");
+
+    // Emitting the flat form directly gives the same tree
+    lexer::TokenStream tokens_again = lexer::ITokenizer::create(source);
+    const FlatAst direct = IParser::create(tokens_again)->parse_flat();
+    string_builder expected;
+    string_builder actual;
+    flat.serialize(expected);
+    direct.serialize(actual);
+    const simple_string expected_text = expected.build();
+    TEST_CHECK_OK_MSG(actual.view() == std::string_view(expected_text), "parse_flat() differs from FlatAst::build().");
+    TEST_CHECK_OK_MSG(std::string_view(expected_text).find("VAR_DECL b\n") != std::string_view::npos, "Serialization is missing a declaration.");
+    TEST_CHECK_OK_MSG(std::string_view(expected_text).find("FUNCTION_CALL core::mem::take\n") != std::string_view::npos, "Serialization is missing a qualified name.");
+}
@@ -0,0 +1,134 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+
+#include <random>
+#include <string>
+
+using lust::lexer::TerminalTokenType;
+
+void check_same_tokens(const lust::lexer::TokenBuffer& actual, const lust::lexer::TokenBuffer& expected, size_t step) {
+    TEST_CHECK_OK_MSG(actual.size() == expected.size(), "Step " << step << ": " << actual.size() << " tokens, " << expected.size() << " expected");
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const lust::lexer::Token a = actual.token_at(i);
+        const lust::lexer::Token b = expected.token_at(i);
+        TEST_CHECK_OK_MSG(a.type == b.type && a.pos == b.pos && a.value == b.value && a.symbol == b.symbol
+            && a.number.bits == b.number.bits && a.has_escapes == b.has_escapes,
+            "Step " << step << ": token " << i << " is " << lust::lexer::token_type_to_string(a.type) << " '" << a.value
+            << "', expected " << lust::lexer::token_type_to_string(b.type) << " '" << b.value << "'");
+    }
+}
+
+void check_same_comments(const lust::lexer::CommentTable& actual, const lust::lexer::CommentTable& expected, size_t step) {
+    TEST_CHECK_OK_MSG(actual.size() == expected.size(), "Step " << step << ": " << actual.size() << " comments, " << expected.size() << " expected");
+    for (size_t i = 0; i < expected.size(); ++i) {
+        TEST_CHECK_OK_MSG(actual.span_at(i).pos == expected.span_at(i).pos && actual.span_at(i).length == expected.span_at(i).length,
+            "Step " << step << ": comment " << i << " mismatched");
+    }
+}
+
+void entry() {
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "fn f" + std::to_string(i) + "(a: u8) -> u32 { let s = \"x\\ty\"; a..=0x1F + 2.5e3 // note\n}\n";
+    }
+
+    // Random keystrokes biased towards chars which change token boundaries, `\xC3` `\xA9` split and join a UTF-8 sequence
+    for (lust::lexer::CommentMode mode : { lust::lexer::CommentMode::EMIT, lust::lexer::CommentMode::RECORD }) {
+        lust::lexer::TokenizerOptions options;
+        options.comments = mode;
+
+        std::string mirror = text;
+        lust::lexer::TokenStream editor = lust::lexer::ITokenizer::create(mirror, options);
+        editor->document_tokens();
+
+        std::mt19937 rng(7);
+        const std::string_view alphabet = "ab1._=/\"\\\n .e+-x\xC3" "\xA9";
+        for (size_t step = 0; step < 400; ++step) {
+            const int64_t offset = std::uniform_int_distribution<int64_t>(0, mirror.size())(rng);
+            const int64_t removed = std::min<int64_t>(std::uniform_int_distribution<int64_t>(0, 3)(rng), mirror.size() - offset);
+            std::string inserted(std::uniform_int_distribution<size_t>(0, 3)(rng), ' ');
+            for (char& c : inserted) {
+                c = alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(rng)];
+            }
+
+            const lust::lexer::TokenEdit edit = editor->apply_edit(offset, removed, inserted);
+            TEST_CHECK_OK_MSG(edit.is_applied, "Step " << step << ": edit should be applied");
+            mirror.replace(offset, removed, inserted);
+
+            lust::lexer::TokenStream fresh = lust::lexer::ITokenizer::create(mirror, options);
+            const lust::lexer::TokenBuffer expected = fresh->tokenize_all();
+            check_same_tokens(editor->document_tokens(), expected, step);
+            check_same_comments(editor->comments(), fresh->comments(), step);
+            TEST_CHECK_OK_MSG(editor->original_text() == mirror, "Step " << step << ": text mismatched");
+        }
+    }
+
+    // Edits right after a string literal or a comment relex it from its quote or its `//`
+    {
+        struct Case {
+            std::string_view text;
+            std::string_view after;
+            std::string_view inserted;
+            int64_t removed;
+        };
+        const Case cases[] = {
+            { "x = \"abc\" + y", "\"abc\" ", "-", 1 },
+            { "x = \"abc\"+y", "\"abc\"", " ", 0 },
+            { "a // b c\nd", "// b c", "e", 0 },
+            { "a // b c\nd", "// b c\n", "", 1 },
+        };
+        for (size_t step = 0; step < std::size(cases); ++step) {
+            std::string mirror(cases[step].text);
+            const int64_t offset = static_cast<int64_t>(mirror.find(cases[step].after) + cases[step].after.size());
+            lust::lexer::TokenStream editor = lust::lexer::ITokenizer::create(mirror);
+            editor->document_tokens();
+
+            TEST_CHECK_OK_MSG(editor->apply_edit(offset, cases[step].removed, cases[step].inserted).is_applied, "Case " << step << ": edit should be applied");
+            mirror.replace(offset, cases[step].removed, cases[step].inserted);
+            check_same_tokens(editor->document_tokens(), lust::lexer::ITokenizer::create(mirror)->tokenize_all(), step);
+        }
+    }
+
+    // A keystroke in a large file relexes a couple of tokens
+    {
+        lust::lexer::TokenStream editor = lust::lexer::ITokenizer::create(text);
+        const size_t token_count = editor->document_tokens().size();
+        const int64_t offset = static_cast<int64_t>(text.find("f100(") + 2);
+
+        const lust::lexer::TokenEdit edit = editor->apply_edit(offset, 0, "7");
+        TEST_CHECK_OK_MSG(edit.is_applied && edit.removed_count <= 3 && edit.inserted_count <= 3 && edit.delta == 1,
+            "A keystroke should relex a few tokens, " << edit.removed_count << " removed, " << edit.inserted_count << " inserted");
+        TEST_CHECK_OK_MSG(editor->document_tokens().size() == token_count, "Token count changed");
+        TEST_CHECK_OK_MSG(editor->document_tokens().token_at(edit.first + 1).value == "f1700", "Edited token mismatched");
+
+        // Opening a string literal turns the rest of the file into a different stream
+        const lust::lexer::TokenEdit quote = editor->apply_edit(offset, 0, "\"");
+        TEST_CHECK_OK_MSG(quote.is_applied && quote.first + quote.removed_count == token_count, "Everything after a quote should be relexed");
+
+        // Closing it right away converges again
+        const lust::lexer::TokenEdit close = editor->apply_edit(offset + 1, 0, "\"");
+        TEST_CHECK_OK_MSG(close.is_applied && close.removed_count < 8, "Closing the string should converge quickly");
+
+        // next_token() starts over on the edited text
+        TEST_CHECK_OK_MSG(editor->next_token().type == TerminalTokenType::FN, "next_token() should restart from the beginning");
+
+        TEST_MUST_BE_FALSE_MSG(editor->apply_edit(static_cast<int64_t>(editor->original_text().size()) + 1, 0, "x").is_applied,
+            "An edit past the end should be rejected");
+    }
+
+    // A streaming tokenizer has no text to edit
+    {
+        bool done = false;
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader([&](char* buffer, size_t) -> size_t {
+            if (done) {
+                return 0;
+            }
+            done = true;
+            buffer[0] = 'a';
+            return 1;
+        });
+        TEST_MUST_BE_FALSE_MSG(stream->apply_edit(0, 0, "b").is_applied, "A stream can't be edited");
+        TEST_CHECK_OK_MSG(stream->document_tokens().type_at(0) == TerminalTokenType::ERROR, "A stream has no document tokens");
+    }
+}
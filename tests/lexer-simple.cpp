@@ -35,6 +35,13 @@ void entry() {
         if (token.type == lust::lexer::TerminalTokenType::ERROR) {
             throw TestError(token.get_value());
         }
+        const std::string_view source = lexer->original_text();
+        TEST_CHECK_OK_MSG(token.value.data() >= source.data() && token.value.data() + token.value.size() <= source.data() + source.size(),
+            "Token value should be a view into the source buffer: " << token.value);
+        TEST_CHECK_OK_MSG(source.substr(token.pos, token.value.size()) == token.value, "Token position doesn't match its value: " << token.value);
+        const lust::simple_string copy = token.get_value_string();
+        TEST_CHECK_OK_MSG(std::string_view(copy) == token.value && copy.data()[copy.size()] == '\0',
+            "Value copy should be null-terminated: " << token.value);
         std::cout << lust::lexer::token_type_to_string(token.type) << ": " << token.get_value() << std::endl;
     }
 }
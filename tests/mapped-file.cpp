@@ -0,0 +1,55 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+const char test_data[] = R"LUST(
+// Comment
+fn add(a: i32, b: i32) -> i32 {
+    let s = "escaped \" quote";
+    a + b
+}
+)LUST";
+
+void entry() {
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "lust-tests-mapped-file.lust";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(source.data(), static_cast<std::streamsize>(source.size()));
+    }
+
+    {
+        lust::lexer::TokenStream mapped = lust::lexer::ITokenizer::create_from_file(path.string().c_str());
+        TEST_CHECK_OK_MSG(mapped, "Mapping an existing file failed");
+        TEST_CHECK_OK_MSG(mapped->original_text() == source, "Mapped text mismatched");
+
+        lust::lexer::TokenStream copied = lust::lexer::ITokenizer::create(source);
+        while (true) {
+            lust::lexer::Token expected = copied->next_token();
+            lust::lexer::Token actual = mapped->next_token();
+            TEST_CHECK_OK_MSG(actual.type == expected.type && actual.value == expected.value && actual.pos == expected.pos,
+                "Token mismatched at " << expected.pos << ": " << actual.value << " vs " << expected.value);
+            if (expected.type == lust::lexer::TerminalTokenType::END) {
+                break;
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+
+    lust::lexer::TokenStream missing = lust::lexer::ITokenizer::create_from_file(path.string().c_str());
+    TEST_CHECK_OK_MSG(!missing, "Mapping a missing file should fail");
+
+    {
+        std::ofstream out(path, std::ios::binary);
+    }
+    lust::lexer::TokenStream empty = lust::lexer::ITokenizer::create_from_file(path.string().c_str());
+    TEST_CHECK_OK_MSG(empty, "Mapping an empty file failed");
+    TEST_CHECK_OK_MSG(empty->next_token().type == lust::lexer::TerminalTokenType::END, "Empty file should only have END");
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,134 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/grammar/operator_expr.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+using lust::lexer::NumberSuffix;
+using lust::lexer::TerminalTokenType;
+
+// The tokenizer owns a copy of the text, the returned token's value views into `stream`
+lust::lexer::Token lex_one(lust::lexer::TokenStream& stream, std::string_view text) {
+    stream = lust::lexer::ITokenizer::create(text);
+    return stream->next_token();
+}
+
+void check_integer(std::string_view text, uint64_t value, NumberSuffix suffix = NumberSuffix::NONE, bool is_overflow = false) {
+    lust::lexer::TokenStream stream = nullptr;
+    const lust::lexer::Token token = lex_one(stream, text);
+    TEST_CHECK_OK_MSG(token.type == TerminalTokenType::INT && token.value == text, "'" << text << "' should be one INT token, got "
+        << lust::lexer::token_type_to_string(token.type) << " '" << token.value << "'");
+    TEST_CHECK_OK_MSG(token.number.is_overflow == is_overflow, "Overflow flag mismatched for '" << text << "'");
+    TEST_CHECK_OK_MSG(is_overflow || token.number.integer() == value, "'" << text << "' decoded as " << token.number.integer());
+    TEST_CHECK_OK_MSG(token.number.suffix == suffix, "Suffix mismatched for '" << text << "'");
+}
+
+void check_float(std::string_view text, double value, NumberSuffix suffix = NumberSuffix::NONE) {
+    lust::lexer::TokenStream stream = nullptr;
+    const lust::lexer::Token token = lex_one(stream, text);
+    TEST_CHECK_OK_MSG(token.type == TerminalTokenType::FLOAT && token.value == text, "'" << text << "' should be one FLOAT token");
+    TEST_CHECK_OK_MSG(token.number.floating() == value, "'" << text << "' decoded as " << token.number.floating());
+    TEST_CHECK_OK_MSG(token.number.suffix == suffix, "Suffix mismatched for '" << text << "'");
+}
+
+void check_error(std::string_view text) {
+    lust::lexer::TokenStream stream = nullptr;
+    const lust::lexer::Token token = lex_one(stream, text);
+    TEST_CHECK_OK_MSG(token.type == TerminalTokenType::ERROR && token.pos == 0, "'" << text << "' should be rejected");
+}
+
+void entry() {
+    check_integer("0", 0);
+    check_integer("1234567", 1234567);
+    check_integer("1_000_000", 1000000);
+    check_integer("0xFF", 255);
+    check_integer("0xdead_BEEF", 0xDEADBEEF);
+    check_integer("0o777", 0777);
+    check_integer("0b1010_1010", 0xAA);
+    check_integer("18446744073709551615", std::numeric_limits<uint64_t>::max());
+    check_integer("18446744073709551616", 0, NumberSuffix::NONE, true);
+    check_integer("0x1_0000_0000_0000_0000", 0, NumberSuffix::NONE, true);
+    check_integer("255u8", 255, NumberSuffix::U8);
+    check_integer("256u8", 0, NumberSuffix::U8, true);
+    check_integer("128i8", 128, NumberSuffix::I8);
+    check_integer("0xFFu8", 255, NumberSuffix::U8);
+    check_integer("7usize", 7, NumberSuffix::USIZE);
+    // `f32` is made of hex digits
+    check_integer("0x1f32", 0x1F32);
+
+    check_float("1.5", 1.5);
+    check_float("3.141_592", 3.141592);
+    check_float("2.5e3", 2500.0);
+    check_float("1e-2", 0.01);
+    check_float("1E+2", 100.0);
+    check_float("1f32", 1.0, NumberSuffix::F32);
+    check_float("0.25f64", 0.25, NumberSuffix::F64);
+    check_float("1e-400", 0.0);
+    {
+        lust::lexer::TokenStream stream = nullptr;
+        const lust::lexer::Token huge = lex_one(stream, "1e400");
+        TEST_CHECK_OK_MSG(huge.type == TerminalTokenType::FLOAT && huge.number.is_overflow && std::isinf(huge.number.floating()), "'1e400' should overflow");
+        const lust::lexer::Token tiny_mantissa = lex_one(stream, "0.000001e310");
+        TEST_CHECK_OK_MSG(!tiny_mantissa.number.is_overflow && tiny_mantissa.number.floating() == 1e304, "'0.000001e310' is in range");
+    }
+
+    check_error("0x");
+    check_error("0b102");
+    check_error("0o8");
+    check_error("12abc");
+    check_error("1.5u8");
+    check_error("0b1f32");
+
+    // Ranges and member accesses don't start a fraction
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create("1..2 3.max");
+        const TerminalTokenType expected[] = { TerminalTokenType::INT, TerminalTokenType::RANGE, TerminalTokenType::INT,
+            TerminalTokenType::INT, TerminalTokenType::DOT, TerminalTokenType::IDENT, TerminalTokenType::END };
+        for (TerminalTokenType type : expected) {
+            const lust::lexer::Token token = stream->next_token();
+            TEST_CHECK_OK_MSG(token.type == type, "Expected " << lust::lexer::token_type_to_string(type) << ", found '" << token.value << "'");
+        }
+    }
+
+    // Literals survive the token buffer, chunks of a parallel lex included
+    {
+        std::string source;
+        for (int i = 0; i < 2000; ++i) {
+            source += "let a" + std::to_string(i) + " = " + std::to_string(i) + "u32 + 0x" + std::to_string(i) + " * 2.5;\n";
+        }
+
+        lust::lexer::TokenStream serial = lust::lexer::ITokenizer::create(source);
+        const lust::lexer::TokenBuffer expected = serial->tokenize_all();
+        lust::lexer::TokenStream parallel = lust::lexer::ITokenizer::create(source);
+        const lust::lexer::TokenBuffer actual = parallel->tokenize_all_parallel(4, 1024);
+
+        TEST_CHECK_OK_MSG(actual.size() == expected.size(), "Token count mismatched");
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const lust::lexer::NumberLiteral a = actual.number_at(i);
+            const lust::lexer::NumberLiteral b = expected.number_at(i);
+            TEST_CHECK_OK_MSG(a.bits == b.bits && a.suffix == b.suffix, "Literal mismatched at token " << i);
+            TEST_CHECK_OK_MSG(actual.token_at(i).number.bits == a.bits, "token_at() lost the literal at " << i);
+        }
+        TEST_CHECK_OK_MSG(expected.number_at(3).integer() == 0 && expected.number_at(3).suffix == NumberSuffix::U32, "Buffered literal mismatched");
+    }
+
+    // The AST keeps the decoded values
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create("let a = 0x2A; let b = 2.5f32;");
+        auto parser = lust::grammar::IParser::create(stream);
+        auto program = parser->parse();
+        TEST_CHECK_OK_MSG(!parser->is_error_occurred() && program->statements.size() == 2, "Literals should parse");
+
+        auto* a = lust::grammar::dyn_cast<lust::grammar::ASTNode_VarDecl>(program->statements[0].get());
+        auto* a_value = a ? lust::grammar::dyn_cast<lust::grammar::ASTNode_IntegerExpr>(a->evaluate_expression.get()) : nullptr;
+        TEST_CHECK_OK_MSG(a_value && a_value->value == 42, "Integer literal value lost");
+
+        auto* b = lust::grammar::dyn_cast<lust::grammar::ASTNode_VarDecl>(program->statements[1].get());
+        auto* b_value = b ? lust::grammar::dyn_cast<lust::grammar::ASTNode_FloatExpr>(b->evaluate_expression.get()) : nullptr;
+        TEST_CHECK_OK_MSG(b_value && b_value->value == 2.5 && b_value->suffix == NumberSuffix::F32, "Float literal value lost");
+    }
+}
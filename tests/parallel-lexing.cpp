@@ -0,0 +1,61 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+
+#include <string>
+
+const char test_block[] = R"LUST(
+// Comment with a "quote
+fn add(a: i32, b: i32) -> i32 {
+    let c: i32 = a + b * 123.5;
+    let s = "multi
+line // not a comment
+string with \" escapes \\";
+    let t = "escaped \
+newline";
+    c
+}
+)LUST";
+
+void check_same_tokens(std::string_view source, uint32_t thread_count, size_t min_chunk_size) {
+    lust::lexer::TokenStream sequential = lust::lexer::ITokenizer::create(source);
+    lust::lexer::TokenStream parallel = lust::lexer::ITokenizer::create(source);
+    const lust::lexer::TokenBuffer expected = sequential->tokenize_all();
+    const lust::lexer::TokenBuffer actual = parallel->tokenize_all_parallel(thread_count, min_chunk_size);
+
+    TEST_CHECK_OK_MSG(actual.size() == expected.size(), "Token count mismatched with " << thread_count << " threads: "
+        << actual.size() << " vs " << expected.size());
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+        lust::lexer::Token a = actual.token_at(i);
+        lust::lexer::Token e = expected.token_at(i);
+        TEST_CHECK_OK_MSG(a.type == e.type && a.pos == e.pos && a.value == e.value, "Token mismatched at " << i << " with "
+            << thread_count << " threads: " << lust::lexer::token_type_to_string(a.type) << " vs " << lust::lexer::token_type_to_string(e.type));
+    }
+
+    TEST_CHECK_OK_MSG(parallel->next_token().type == sequential->next_token().type, "Tokenizer state mismatched after lexing");
+}
+
+void entry() {
+    std::string source;
+    for (int i = 0; i < 64; ++i) {
+        source += test_block;
+    }
+    // A string literal spanning many chunks
+    source += "let long = \"";
+    for (int i = 0; i < 64; ++i) {
+        source += "still inside\n";
+    }
+    source += "\";\n";
+
+    for (uint32_t threads : { 1u, 2u, 3u, 8u, 16u }) {
+        check_same_tokens(source, threads, 16);
+    }
+
+    // Lexing stops at the same error
+    check_same_tokens(source + "let s = \"unterminated\n" + source, 4, 16);
+    check_same_tokens(source + "let c = `;\n" + source, 4, 16);
+
+    // Small input falls back to the sequential path
+    check_same_tokens(test_block, 4, 1 << 20);
+}
@@ -0,0 +1,60 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/char_class.hpp"
+#include "lust/simd_scan.hpp"
+
+#include <random>
+
+namespace
+{
+    using namespace lust::simd;
+
+    // Compare every scanning function on every start offset against the scalar implementation
+    void check_level(SimdLevel level, const std::string& buffer) {
+        const char* const begin = buffer.data();
+        const char* const end = begin + buffer.size();
+        const uint8_t masks[] = { lust::char_class::SPACE, lust::char_class::DIGIT, lust::char_class::IDENT_CONTINUE };
+
+        for (size_t offset = 0; offset <= buffer.size(); ++offset) {
+            const char* p = begin + offset;
+            for (uint8_t mask : masks) {
+                set_simd_level(SimdLevel::SCALAR);
+                const char* expected = skip_char_class(p, end, mask);
+                set_simd_level(level);
+                TEST_CHECK_OK_MSG(skip_char_class(p, end, mask) == expected,
+                    simd_level_to_name(level) << " skip_char_class(" << int(mask) << ") mismatched at offset " << offset);
+            }
+
+            set_simd_level(SimdLevel::SCALAR);
+            const char* expected_line_break = find_line_break(p, end);
+            const char* expected_quote = find_quote_or_escape(p, end);
+            set_simd_level(level);
+            TEST_CHECK_OK_MSG(find_line_break(p, end) == expected_line_break,
+                simd_level_to_name(level) << " find_line_break mismatched at offset " << offset);
+            TEST_CHECK_OK_MSG(find_quote_or_escape(p, end) == expected_quote,
+                simd_level_to_name(level) << " find_quote_or_escape mismatched at offset " << offset);
+        }
+    }
+}
+
+void entry() {
+    // Long runs of every class, with boundary bytes around the vector width
+    const std::string alphabet = std::string("aZ_9 \t\r\n\v\f\"\\/@[`{:") + "\x80\xC3\xA9\xFF\x7F";
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<size_t> run(1, 40);
+
+    std::string buffer;
+    while (buffer.size() < 4096) {
+        buffer.append(run(rng), alphabet[pick(rng)]);
+    }
+
+    const SimdLevel supported = detect_simd_level();
+    for (uint32_t level = 0; level <= static_cast<uint32_t>(supported); ++level) {
+        check_level(static_cast<SimdLevel>(level), buffer);
+        std::cout << "Checked " << simd_level_to_name(static_cast<SimdLevel>(level)) << std::endl;
+    }
+
+    set_simd_level(supported);
+}
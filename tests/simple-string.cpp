@@ -2,6 +2,8 @@
 #include "single_file_test.hpp"
 #include "lust/container/simple_string.hpp"
 
+#include <string>
+
 void entry() {
     using namespace lust;
 
@@ -79,4 +81,23 @@ void entry() {
     // Test SSO
     simple_string str16("SSO");
     TEST_CHECK_OK_MSG(str16.data() < (void*)(&str16 + sizeof(simple_string)), "Small string optimization is not correct.");
+
+    // Inline capacity boundary, the last byte holds the inline length
+    std::string_view longest_inline = std::string_view("0123456789012345678901234567890123456789").substr(0, SSO_BUFFER_SIZE);
+    simple_string str17(longest_inline);
+    TEST_CHECK_OK_MSG(str17.length() == SSO_BUFFER_SIZE && std::string_view(str17) == longest_inline, "Longest inline string is not correct.");
+    TEST_CHECK_OK_MSG(str17.data() == reinterpret_cast<char*>(&str17), "Longest inline string should not allocate.");
+
+    str17 += "x";
+    TEST_CHECK_OK_MSG(str17.length() == SSO_BUFFER_SIZE + 1 && str17.data() != reinterpret_cast<char*>(&str17), "Growing past the inline buffer should allocate.");
+    TEST_CHECK_OK_MSG(std::string_view(str17) == std::string(longest_inline) + "x", "Content is not kept when moving to the heap.");
+
+    // Heap and inline strings swap and move as plain bytes
+    simple_string str18("short");
+    str17.swap(str18);
+    TEST_CHECK_OK_MSG(str17 == "short" && str18.length() == SSO_BUFFER_SIZE + 1, "Swapping heap and inline strings failed.");
+    simple_string str19(std::move(str18));
+    TEST_CHECK_OK_MSG(str18.is_empty() && str19.length() == SSO_BUFFER_SIZE + 1, "Moving a heap string failed.");
+    str19 = "back inline";
+    TEST_CHECK_OK_MSG(str19 == "back inline" && str19.data() == reinterpret_cast<char*>(&str19), "Assigning a short string should go back inline.");
 }
@@ -0,0 +1,62 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/container/simple_string.hpp"
+#include "lust/container/small_vector.hpp"
+#include "lust/container/unique_ptr.hpp"
+#include "lust/symbol.hpp"
+
+void entry() {
+    using namespace lust;
+
+    // Up to N elements stay in place
+    small_vector<Symbol, 2> symbols;
+    static_assert(sizeof(symbols) == 16, "Two symbols should fit in the space of the heap pointer");
+    symbols.push_back(intern("a"));
+    symbols.push_back(intern("b"));
+    TEST_CHECK_OK_MSG(symbols.is_inline() && symbols.size() == 2 && symbols.data() == reinterpret_cast<Symbol*>(reinterpret_cast<char*>(&symbols) + 8),
+        "Two symbols should be stored inline.");
+
+    symbols.push_back(intern("c"));
+    TEST_CHECK_OK_MSG(!symbols.is_inline() && symbols.capacity() >= 3 && symbols[0].str() == "a" && symbols.back().str() == "c", "Spilling to the heap failed.");
+
+    small_vector<Symbol, 2> copied(symbols);
+    TEST_CHECK_OK_MSG(copied.size() == 3 && copied[1] == symbols[1] && copied.data() != symbols.data(), "Copy constructor failed.");
+
+    // Inline and heap elements survive moves and swaps
+    small_vector<simple_string, 2> strings;
+    strings.push_back("a string long enough to live on the heap");
+    small_vector<simple_string, 2> spilled;
+    for (int i = 0; i < 5; ++i) {
+        spilled.emplace_back("spilled");
+    }
+    strings.swap(spilled);
+    TEST_CHECK_OK_MSG(strings.size() == 5 && !strings.is_inline() && spilled.size() == 1 && spilled.is_inline(), "Swapping inline and heap vectors failed.");
+    TEST_CHECK_OK_MSG(spilled[0] == "a string long enough to live on the heap" && strings[4] == "spilled", "Swapped content is not correct.");
+
+    small_vector<simple_string, 2> moved(std::move(spilled));
+    TEST_CHECK_OK_MSG(moved.size() == 1 && spilled.empty() && moved.front() == "a string long enough to live on the heap", "Moving an inline vector failed.");
+    moved = std::move(strings);
+    TEST_CHECK_OK_MSG(moved.size() == 5 && strings.empty() && strings.is_inline(), "Move assigning a heap vector failed.");
+
+    // Appending an element of the vector itself while it spills
+    moved.pop_back();
+    moved.pop_back();
+    moved.pop_back();
+    moved.clear();
+    moved.push_back("first of two, long enough for the heap");
+    moved.push_back("second");
+    small_vector<simple_string, 2> inline_only(moved);
+    inline_only.push_back(inline_only[0]);
+    TEST_CHECK_OK_MSG(inline_only.size() == 3 && inline_only.back() == "first of two, long enough for the heap", "Appending an element of the vector itself failed.");
+
+    // Move-only elements
+    small_vector<UniquePtr<simple_string>, 2> params;
+    for (int i = 0; i < 3; ++i) {
+        params.push_back(make_unique<simple_string>("param"));
+    }
+    size_t count = 0;
+    for (const auto& param : params) {
+        count += param.get() != nullptr;
+    }
+    TEST_CHECK_OK_MSG(count == 3, "Move-only elements failed.");
+}
@@ -0,0 +1,57 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/source_map.hpp"
+#include "lust/simd_scan.hpp"
+
+#include <random>
+#include <string>
+
+// Walk from the start, a '\n' belongs to the line it ends
+lust::lexer::SourceLoc reference_locate(std::string_view text, int64_t pos) {
+    lust::lexer::SourceLoc loc;
+    loc.line = 1;
+    loc.row = 1;
+    for (int64_t i = 0; i < pos; ++i) {
+        if (text[i] == '\n') {
+            ++loc.line;
+            loc.row = 1;
+        } else {
+            ++loc.row;
+        }
+    }
+    return loc;
+}
+
+void check_all_positions(std::string_view text) {
+    const lust::lexer::SourceMap map(text);
+    for (int64_t pos = 0; pos <= static_cast<int64_t>(text.size()); ++pos) {
+        const lust::lexer::SourceLoc expected = reference_locate(text, pos);
+        const lust::lexer::SourceLoc actual = map.locate(pos);
+        TEST_CHECK_OK_MSG(actual.line == expected.line && actual.row == expected.row, "Location mismatched at " << pos << ": L"
+            << actual.line << ":" << actual.row << " vs L" << expected.line << ":" << expected.row);
+    }
+}
+
+void entry() {
+    check_all_positions("");
+    check_all_positions("\n");
+    check_all_positions("fn main() {\r\n    let a = 1;\n}");
+
+    const lust::lexer::SourceMap map("ab\ncd\n");
+    TEST_CHECK_OK_MSG(map.line_count() == 3 && map.line_start(1) == 3 && map.line_start(2) == 6, "Line starts mismatched");
+    TEST_CHECK_OK_MSG(map.locate(0).row == 1, "The first byte is in column 1");
+    TEST_CHECK_OK_MSG(map.locate(-1).line == -1 && map.locate(7).line == -1, "Positions out of the source are unknown");
+
+    std::mt19937 rng(3);
+    std::string random_text(3000, ' ');
+    for (char& c : random_text) {
+        c = "ab\n\r "[std::uniform_int_distribution<int>(0, 4)(rng)];
+    }
+
+    const lust::simd::SimdLevel supported = lust::simd::detect_simd_level();
+    for (uint32_t level = 0; level <= static_cast<uint32_t>(supported); ++level) {
+        lust::simd::set_simd_level(static_cast<lust::simd::SimdLevel>(level));
+        check_all_positions(random_text);
+    }
+    lust::simd::set_simd_level(supported);
+}
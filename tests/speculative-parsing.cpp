@@ -0,0 +1,115 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/token_ring.hpp"
+#include "lust/grammar/operator_expr.hpp"
+
+#include <cstring>
+#include <string>
+
+const char test_data[] = R"LUST(
+let call = make<i32, Foo<u8>>(a, b);
+// The `<` can't start generic arguments here
+let less = a < b;
+let chained = a < b && c > d;
+)LUST";
+
+// The checkpoint is taken on the first token of type `target` after the first token
+void check_rollback(lust::lexer::TokenRing& ring, const char* label, lust::lexer::TerminalTokenType target = lust::lexer::TerminalTokenType::NONE) {
+    ring.consume();
+    while (target != lust::lexer::TerminalTokenType::NONE && ring.peek(0).type != target) {
+        ring.consume();
+    }
+    const lust::lexer::TokenRing::Checkpoint checkpoint = ring.checkpoint();
+    const lust::lexer::Token expected = ring.peek(0);
+
+    // Close enough to be given back from the ring, then far enough to rewind the source
+    for (size_t distance : { size_t(3), lust::lexer::TokenRing::CAPACITY * 2 }) {
+        for (size_t i = 0; i < distance; ++i) {
+            ring.consume();
+        }
+        TEST_CHECK_OK_MSG(ring.rollback(checkpoint), label << ": rollback over " << distance << " tokens failed");
+        const lust::lexer::Token& token = ring.peek(0);
+        TEST_CHECK_OK_MSG(token.type == expected.type && token.pos == expected.pos && token.value == expected.value,
+            label << ": wrong token after a rollback over " << distance << " tokens");
+    }
+}
+
+void entry() {
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        stream->next_token();
+        const lust::lexer::TokenizerState state = stream->save_state();
+        const lust::lexer::Token first = stream->next_token();
+        stream->next_token();
+        stream->next_token();
+        TEST_CHECK_OK_MSG(stream->restore_state(state), "Restoring an in-memory tokenizer shouldn't fail");
+        const lust::lexer::Token again = stream->next_token();
+        TEST_CHECK_OK_MSG(again.type == first.type && again.pos == first.pos, "Tokenizer didn't resume from the saved state");
+        TEST_MUST_BE_FALSE_MSG(stream->restore_state({ static_cast<int64_t>(source.size()) + 1 }), "A state past the source can't be restored");
+    }
+
+    {
+        std::string long_source;
+        for (int i = 0; i < 20; ++i) {
+            long_source += source;
+        }
+
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(long_source);
+        lust::lexer::TokenRing stream_ring(stream);
+        check_rollback(stream_ring, "stream");
+
+        lust::lexer::TokenStream batch = lust::lexer::ITokenizer::create(long_source);
+        const lust::lexer::TokenBuffer buffer = batch->tokenize_all();
+        lust::lexer::TokenRing buffer_ring(buffer);
+        check_rollback(buffer_ring, "buffer");
+    }
+
+    {
+        // Rewinding the source to a string literal or to a comment lexes it again from its quote or its `//`
+        std::string literal_source;
+        for (int i = 0; i < 20; ++i) {
+            literal_source += "let s = \"hello world\"; // a b\nlet t = u;\n";
+        }
+
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(literal_source);
+        lust::lexer::TokenRing ring(stream);
+        check_rollback(ring, "string", lust::lexer::TerminalTokenType::STRING);
+
+        lust::lexer::TokenStream tokenizer = lust::lexer::ITokenizer::create(literal_source);
+        lust::lexer::TerminalTokenType previous = lust::lexer::TerminalTokenType::NONE;
+        size_t restored = 0;
+        for (lust::lexer::Token token = tokenizer->next_token(); token.type != lust::lexer::TerminalTokenType::END; token = tokenizer->next_token()) {
+            if (token.type == lust::lexer::TerminalTokenType::STRING || token.type == lust::lexer::TerminalTokenType::COMMENTVAL) {
+                const lust::lexer::TokenizerState resume = tokenizer->save_state();
+                TEST_CHECK_OK_MSG(tokenizer->restore_state({ lust::lexer::token_start(token.type, token.pos), previous }), "Restoring a token start failed");
+                const lust::lexer::Token again = tokenizer->next_token();
+                TEST_CHECK_OK_MSG(again.type == token.type && again.pos == token.pos && again.value == token.value,
+                    lust::lexer::token_type_to_string(token.type) << " at " << token.pos << " lexed again as " << lust::lexer::token_type_to_string(again.type) << " '" << again.value << "'");
+                TEST_CHECK_OK_MSG(tokenizer->restore_state(resume), "Restoring the saved state failed");
+                ++restored;
+            }
+            previous = token.type;
+        }
+        TEST_CHECK_OK_MSG(restored == 40, "Every literal and comment should be lexed again");
+    }
+
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        auto parser = lust::grammar::IParser::create(stream);
+        auto program = parser->parse();
+        TEST_CHECK_OK_MSG(!parser->is_error_occurred() && program && program->statements.size() == 3, "Speculative parsing shouldn't report errors");
+
+        auto* call_decl = lust::grammar::dyn_cast<lust::grammar::ASTNode_VarDecl>(program->statements[0].get());
+        auto* call = call_decl ? lust::grammar::dyn_cast<lust::grammar::ASTNode_QualifiedName>(call_decl->evaluate_expression.get()) : nullptr;
+        TEST_CHECK_OK_MSG(call && call->operator_type == lust::grammar::OperatorType::FUNCTION_CALL && call->generic_params.size() == 2,
+            "`make<i32, Foo<u8>>(a, b)` should be a generic call");
+
+        auto* less_decl = lust::grammar::dyn_cast<lust::grammar::ASTNode_VarDecl>(program->statements[1].get());
+        TEST_CHECK_OK_MSG(less_decl && less_decl->evaluate_expression->operator_type == lust::grammar::OperatorType::LOGICAL_RELATION_LESS_THAN,
+            "`a < b` should stay a comparison");
+    }
+}
@@ -0,0 +1,83 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+
+const char test_block[] = R"LUST(
+// Comment
+#[derive(Debug)]
+struct Foo<T> {
+    val: T,
+}
+
+fn add(a: i32, b: i32) -> i32 {
+    let c: i32 = a + b * 123.5;
+    let r = 1..=10;
+    let s = "escaped \" quote";
+    c
+}
+)LUST";
+
+// Hand out the source in small random pieces, like a pipe would
+lust::lexer::ReadCallback make_reader(const std::string& source, uint32_t seed) {
+    return [&source, offset = size_t(0), rng = std::mt19937(seed)](char* buffer, size_t capacity) mutable -> size_t {
+        const size_t piece = std::min<size_t>({ capacity, source.size() - offset, std::uniform_int_distribution<size_t>(1, 37)(rng) });
+        std::memcpy(buffer, source.data() + offset, piece);
+        offset += piece;
+        return piece;
+    };
+}
+
+void entry() {
+    std::string source;
+    for (int i = 0; i < 32; ++i) {
+        source += test_block;
+    }
+
+    for (size_t window_size : { 48u, 64u, 1000u, 1u << 16 }) {
+        lust::lexer::TokenStream expected_stream = lust::lexer::ITokenizer::create(source);
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader(make_reader(source, window_size), window_size);
+
+        TEST_CHECK_OK_MSG(stream->original_text().size() <= window_size, "The window is larger than requested");
+
+        lust::lexer::Token previous{};
+        std::string previous_value;
+        while (true) {
+            lust::lexer::Token expected = expected_stream->next_token();
+            lust::lexer::Token actual = stream->next_token();
+            TEST_CHECK_OK_MSG(actual.type == expected.type && actual.value == expected.value && actual.pos == expected.pos,
+                "Token mismatched at " << expected.pos << " with a " << window_size << " bytes window: "
+                << lust::lexer::token_type_to_string(actual.type) << " '" << actual.value << "' vs '" << expected.value << "'");
+
+            // The previous token survives one more refill
+            TEST_CHECK_OK_MSG(previous.value == previous_value, "Previous token value was overwritten");
+            previous = actual;
+            previous_value = std::string(actual.value);
+
+            if (expected.type == lust::lexer::TerminalTokenType::END) {
+                break;
+            }
+        }
+    }
+
+    {
+        lust::lexer::TokenStream expected_stream = lust::lexer::ITokenizer::create(source);
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader(make_reader(source, 1), 256);
+        auto expected_program = lust::grammar::IParser::create(expected_stream)->parse();
+        auto program = lust::grammar::IParser::create(stream)->parse();
+        TEST_CHECK_OK_MSG(program->statements.size() == expected_program->statements.size(), "Parsing a stream mismatched");
+    }
+
+    {
+        const std::string long_ident = "let " + std::string(100, 'x') + " = 1;";
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader(make_reader(long_ident, 2), 32);
+        TEST_CHECK_OK_MSG(stream->next_token().type == lust::lexer::TerminalTokenType::LET, "First token should be LET");
+        lust::lexer::Token error = stream->next_token();
+        TEST_CHECK_OK_MSG(error.type == lust::lexer::TerminalTokenType::ERROR && error.pos == 4, "A token longer than the window should be an error");
+    }
+}
@@ -0,0 +1,69 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/container/simple_string.hpp"
+#include "lust/container/string_builder.hpp"
+#include "lust/grammar/qualified_name.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+void entry() {
+    using namespace lust;
+
+    // Appending one char at a time reallocates a logarithmic number of times
+    simple_string grown;
+    std::string expected;
+    size_t reallocations = 0;
+    const char* previous_data = grown.data();
+    for (size_t i = 0; i < 10000; ++i) {
+        const char c = static_cast<char>('a' + i % 26);
+        grown.append(std::string_view(&c, 1));
+        expected += c;
+        if (grown.data() != previous_data) {
+            ++reallocations;
+            previous_data = grown.data();
+        }
+    }
+    TEST_CHECK_OK_MSG(std::string_view(grown) == expected, "Appended content is not correct.");
+    TEST_CHECK_OK_MSG(reallocations < 16, "Appending should grow geometrically, reallocated " << reallocations << " times.");
+    TEST_CHECK_OK_MSG(grown.capacity() >= grown.size() && grown.size() == grown.length(), "Size or capacity is not correct.");
+
+    // reserve() allocates once, clear() keeps the buffer
+    simple_string reserved;
+    reserved.reserve(100);
+    const char* reserved_data = reserved.data();
+    TEST_CHECK_OK_MSG(reserved.capacity() == 100 && reserved.is_empty(), "reserve() should allocate the exact capacity.");
+    for (int i = 0; i < 10; ++i) {
+        reserved += "0123456789";
+    }
+    TEST_CHECK_OK_MSG(reserved.data() == reserved_data && reserved.size() == 100, "Appending within the reserved capacity should not reallocate.");
+    reserved.clear();
+    TEST_CHECK_OK_MSG(reserved.is_empty() && reserved.capacity() == 100 && reserved == "", "clear() should keep the buffer.");
+
+    const simple_string constant("const");
+    TEST_CHECK_OK_MSG(constant.length() == 5 && std::string_view(constant) == "const", "A const string should be readable.");
+
+    // The builder formats numbers and reuses its buffer from one build to the next
+    string_builder builder;
+    builder << "x=" << 42 << ", y=" << -7 << ", c=" << 'c' << ", max=" << std::numeric_limits<uint64_t>::max()
+        << ", min=" << std::numeric_limits<int64_t>::min();
+    TEST_CHECK_OK_MSG(builder.view() == "x=42, y=-7, c=c, max=18446744073709551615, min=-9223372036854775808",
+        "Builder output is not correct: " << builder.view());
+    const char* builder_data = builder.view().data();
+    const simple_string first = builder.build();
+    TEST_CHECK_OK_MSG(builder.is_empty() && first == "x=42, y=-7, c=c, max=18446744073709551615, min=-9223372036854775808",
+        "build() should copy the text out and start over.");
+
+    builder << "second build, still longer than the inline buffer";
+    TEST_CHECK_OK_MSG(builder.view().data() == builder_data, "The builder should reuse its buffer.");
+    TEST_CHECK_OK_MSG(builder.build() == "second build, still longer than the inline buffer", "Second build is not correct.");
+
+    // Qualified names render as written in the source
+    grammar::AstArena arena;
+    grammar::QualifiedName name{ intern("parse"), {} };
+    name.name_spaces.push_back(arena, intern("lust"));
+    name.name_spaces.push_back(arena, intern("grammar"));
+    append_qualified_name(builder, name);
+    TEST_CHECK_OK_MSG(builder.build() == "lust::grammar::parse", "Qualified name rendering is not correct.");
+}
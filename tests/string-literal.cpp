@@ -0,0 +1,126 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/symbol.hpp"
+#include "lust/grammar/operator_expr.hpp"
+
+#include <string>
+
+using lust::lexer::TerminalTokenType;
+
+void check_decoded(std::string_view literal, std::string_view expected) {
+    lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(literal);
+    const lust::lexer::Token token = stream->next_token();
+    TEST_CHECK_OK_MSG(token.type == TerminalTokenType::STRING, literal << " should be a STRING token");
+
+    std::string_view text;
+    TEST_CHECK_OK_MSG(lust::lexer::decode_string_literal(token, text), literal << " should decode");
+    TEST_CHECK_OK_MSG(text == expected, literal << " decoded as '" << text << "'");
+}
+
+void check_invalid(std::string_view literal) {
+    lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(literal);
+    const lust::lexer::Token token = stream->next_token();
+    std::string_view text;
+    TEST_CHECK_OK_MSG(token.type == TerminalTokenType::STRING && token.has_escapes, literal << " should lex with escapes");
+    TEST_MUST_BE_FALSE_MSG(lust::lexer::decode_string_literal(token, text), literal << " should be rejected");
+}
+
+const lust::grammar::ASTNode_StringExpr* string_of(const lust::grammar::ASTNode_Program& program, size_t index) {
+    auto* decl = lust::grammar::dyn_cast<lust::grammar::ASTNode_VarDecl>(program.statements[index].get());
+    return decl ? lust::grammar::dyn_cast<lust::grammar::ASTNode_StringExpr>(decl->evaluate_expression.get()) : nullptr;
+}
+
+void entry() {
+    // Escape-free literals are slices of the source
+    {
+        const std::string_view source = "\"plain text\"";
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        const lust::lexer::Token token = stream->next_token();
+        std::string_view text;
+        TEST_MUST_BE_FALSE_MSG(token.has_escapes, "A plain literal has no escapes");
+        TEST_CHECK_OK_MSG(lust::lexer::decode_string_literal(token, text) && text.data() == token.value.data() && text == "plain text",
+            "A plain literal should decode to its own text");
+    }
+
+    check_decoded(R"("a\nb\tc\rd")", "a\nb\tc\rd");
+    check_decoded(R"("quote \" backslash \\ apostrophe \'")", "quote \" backslash \\ apostrophe '");
+    check_decoded(R"("\x41\x7f")", "A\x7f");
+    check_decoded(R"("\u{e9}\u{20AC}\u{1F600}")", "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+    check_decoded(R"("nul\0byte")", std::string_view("nul\0byte", 8));
+
+    check_invalid(R"("\q")");
+    check_invalid(R"("\x80")");
+    check_invalid(R"("\x4")");
+    check_invalid(R"("\u41")");
+    check_invalid(R"("\u{}")");
+    check_invalid(R"("\u{D800}")");
+    check_invalid(R"("\u{110000}")");
+    check_invalid(R"("\u{0000041}")");
+    check_invalid(R"("\u{41")");
+
+    // Equal decoded literals share one pooled copy
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(R"("tab\there" "tab\u{9}here")");
+        const lust::lexer::Token first = stream->next_token();
+        const lust::lexer::Token second = stream->next_token();
+        std::string_view first_text;
+        std::string_view second_text;
+        TEST_CHECK_OK_MSG(lust::lexer::decode_string_literal(first, first_text) && lust::lexer::decode_string_literal(second, second_text),
+            "Both literals should decode");
+        TEST_CHECK_OK_MSG(first_text == "tab\there" && first_text.data() == second_text.data(), "Equal literals should share their text");
+    }
+
+    // The escape flag survives the token buffer
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(R"(let a = "x\ny"; let b = "xy";)");
+        const lust::lexer::TokenBuffer buffer = stream->tokenize_all();
+        size_t strings = 0;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            const lust::lexer::Token token = buffer.token_at(i);
+            if (token.type == TerminalTokenType::STRING) {
+                TEST_CHECK_OK_MSG(token.has_escapes == (strings == 0), "Escape flag lost for token " << i);
+                ++strings;
+            }
+        }
+        TEST_CHECK_OK_MSG(strings == 2, "Expected two string literals");
+    }
+
+    // A program repeating its messages holds one copy of each
+    {
+        std::string source;
+        for (int i = 0; i < 2000; ++i) {
+            source += i % 2 ? "let a = \"Error:\\tfile not found\\n\";\n" : "let b = \"plain message\";\n";
+        }
+
+        const size_t pooled_before = lust::SymbolTable::literals().size();
+        lust::grammar::Ast program;
+        {
+            lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+            auto parser = lust::grammar::IParser::create(stream);
+            program = parser->parse();
+            TEST_CHECK_OK_MSG(!parser->is_error_occurred() && program->statements.size() == 2000, "Literals should parse");
+        }
+
+        // The tree holds its literals, it outlives the tokenizer and the global pool doesn't grow
+        const lust::grammar::ASTNode_StringExpr* plain = string_of(*program, 0);
+        const lust::grammar::ASTNode_StringExpr* escaped = string_of(*program, 1);
+        TEST_CHECK_OK_MSG(plain && plain->value == "plain message", "Plain literal value lost");
+        TEST_CHECK_OK_MSG(escaped && escaped->value == "Error:\tfile not found\n", "Escaped literal value lost");
+        TEST_CHECK_OK_MSG(lust::SymbolTable::literals().size() == pooled_before, "Parsed literals went into the global pool");
+
+        for (size_t i = 2; i < program->statements.size(); ++i) {
+            const lust::grammar::ASTNode_StringExpr* value = string_of(*program, i);
+            TEST_CHECK_OK_MSG(value && value->value.data() == (i % 2 ? escaped : plain)->value.data(), "Literal " << i << " has its own copy");
+        }
+    }
+
+    // Invalid escapes are reported by the parser
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(R"(let a = "\z";)");
+        auto parser = lust::grammar::IParser::create(stream);
+        parser->parse();
+        TEST_CHECK_OK_MSG(parser->is_error_occurred(), "An invalid escape should be an error");
+    }
+}
@@ -0,0 +1,59 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/symbol.hpp"
+#include "lust/lexer.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+void entry() {
+    lust::SymbolTable table;
+    TEST_CHECK_OK_MSG(table.size() == 1 && table.intern("").empty(), "The empty string should be symbol 0");
+
+    const lust::Symbol foo = table.intern("foo");
+    TEST_CHECK_OK_MSG(table.intern(std::string("foo")) == foo && table.intern("bar") != foo, "Equal strings should share a symbol");
+    TEST_CHECK_OK_MSG(table.resolve(foo) == "foo", "Symbol text mismatched");
+
+    // Every thread interns the same names in a different order, they must agree on the ids
+    constexpr size_t NAME_COUNT = 20000;
+    constexpr size_t THREAD_COUNT = 4;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < NAME_COUNT; ++i) {
+        names.push_back("name_" + std::to_string(i) + std::string(i % 40, 'x'));
+    }
+
+    std::vector<std::vector<lust::Symbol>> results(THREAD_COUNT, std::vector<lust::Symbol>(NAME_COUNT));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < NAME_COUNT; ++i) {
+                const size_t rotated = (i + t * 5003) % NAME_COUNT;
+                const size_t index = t % 2 == 0 ? rotated : NAME_COUNT - 1 - rotated;
+                results[t][index] = table.intern(names[index]);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    TEST_CHECK_OK_MSG(table.size() == NAME_COUNT + 3, "Ids should be dense, got " << table.size() << " symbols");
+    std::vector<bool> seen(table.size(), false);
+    for (size_t i = 0; i < NAME_COUNT; ++i) {
+        const lust::Symbol symbol = results[0][i];
+        for (size_t t = 1; t < THREAD_COUNT; ++t) {
+            TEST_CHECK_OK_MSG(results[t][i] == symbol, "Threads disagree on the symbol of " << names[i]);
+        }
+        TEST_CHECK_OK_MSG(symbol.id < seen.size() && !seen[symbol.id], "Symbol " << symbol.id << " handed out twice");
+        seen[symbol.id] = true;
+        TEST_CHECK_OK_MSG(table.resolve(symbol) == names[i], "Symbol text mismatched for " << names[i]);
+    }
+
+    // Identifiers are interned by the lexer, keywords aren't
+    auto lexer = lust::lexer::ITokenizer::create("let value = value + other;");
+    lust::lexer::TokenBuffer buffer = lexer->tokenize_all();
+    TEST_CHECK_OK_MSG(buffer.symbol_at(0).empty(), "Keywords shouldn't carry a symbol");
+    TEST_CHECK_OK_MSG(buffer.symbol_at(1) == buffer.symbol_at(3) && buffer.symbol_at(1) != buffer.symbol_at(5), "Identifier symbols mismatched");
+    TEST_CHECK_OK_MSG(buffer.symbol_at(1) == lust::intern("value") && buffer.symbol_at(1).str() == "value", "Lexer should use the global table");
+}
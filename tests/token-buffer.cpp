@@ -0,0 +1,56 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+
+const char test_data[] = R"LUST(
+// Comment
+#[derive(Debug)]
+struct Foo<T> {
+    val: T,
+}
+
+fn add(a: i32, b: i32) -> i32 {
+    let c: i32 = a + b * 123.5;
+    let s = "escaped \" quote";
+    c
+}
+)LUST";
+
+void entry() {
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+
+    lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+    lust::lexer::TokenStream batch = lust::lexer::ITokenizer::create(source);
+    const lust::lexer::TokenBuffer buffer = batch->tokenize_all();
+
+    TEST_CHECK_OK_MSG(buffer.source() == batch->original_text(), "Token buffer should view the tokenizer's source");
+
+    size_t index = 0;
+    while (true) {
+        lust::lexer::Token expected = stream->next_token();
+        TEST_CHECK_OK_MSG(index < buffer.size(), "Token buffer is shorter than the token stream");
+
+        lust::lexer::Token actual = buffer.token_at(index);
+        TEST_CHECK_OK_MSG(actual.type == expected.type, "Token type mismatched at " << index << ": "
+            << lust::lexer::token_type_to_string(actual.type) << " vs " << lust::lexer::token_type_to_string(expected.type));
+        TEST_CHECK_OK_MSG(actual.value == expected.value, "Token value mismatched at " << index << ": " << actual.value << " vs " << expected.value);
+        TEST_CHECK_OK_MSG(actual.pos == expected.pos, "Token position mismatched at " << index);
+
+        ++index;
+        if (expected.type == lust::lexer::TerminalTokenType::END) {
+            break;
+        }
+    }
+    TEST_CHECK_OK_MSG(index == buffer.size(), "Token buffer is longer than the token stream");
+
+    lust::lexer::TokenStream parser_stream = lust::lexer::ITokenizer::create(source);
+    lust::UniquePtr<lust::grammar::IParser> stream_parser = lust::grammar::IParser::create(parser_stream);
+    lust::UniquePtr<lust::grammar::IParser> buffer_parser = lust::grammar::IParser::create(buffer);
+
+    auto stream_program = stream_parser->parse();
+    auto buffer_program = buffer_parser->parse();
+    TEST_CHECK_OK_MSG(!stream_parser->is_error_occurred(), "Parsing the token stream failed");
+    TEST_CHECK_OK_MSG(!buffer_parser->is_error_occurred(), "Parsing the token buffer failed");
+    TEST_CHECK_OK_MSG(stream_program->statements.size() == buffer_program->statements.size(), "Parsing results mismatched");
+}
@@ -0,0 +1,150 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/parser.hpp"
+#include "lust/token_ring.hpp"
+#include "lust/grammar/operator_expr.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every allocation of the process is counted, the ring must not add any
+static std::atomic<size_t> g_allocations{ 0 };
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+const char test_data[] = R"LUST(
+// Comment
+#[derive(Debug)]
+pub(crate) struct Foo<T> {
+    val: T,
+}
+
+fn add(a: i32, b: i32) -> i32 {
+    // Another comment
+    let c: i32 = a + b * 123.5;
+    let s = "escaped \" quote";
+    c
+}
+)LUST";
+
+// Token values view the text of `stream`, which must outlive them
+std::vector<lust::lexer::Token> reference_tokens(lust::lexer::TokenStream& stream) {
+    std::vector<lust::lexer::Token> tokens;
+    while (true) {
+        const lust::lexer::Token token = stream->next_token();
+        if (token.type != lust::lexer::TerminalTokenType::COMMENTVAL) {
+            tokens.push_back(token);
+        }
+        if (token.type == lust::lexer::TerminalTokenType::END) {
+            return tokens;
+        }
+    }
+}
+
+bool same_token(const lust::lexer::Token& a, const lust::lexer::Token& b) {
+    return a.type == b.type && a.pos == b.pos && a.value == b.value && a.symbol == b.symbol;
+}
+
+void check_ring(lust::lexer::TokenRing& ring, const std::vector<lust::lexer::Token>& expected, const char* label) {
+    for (size_t i = 0; i < expected.size() + 3; ++i) {
+        for (size_t k = 0; k < lust::lexer::TokenRing::CAPACITY; ++k) {
+            const lust::lexer::Token& want = expected[std::min(i + k, expected.size() - 1)];
+            TEST_CHECK_OK_MSG(same_token(ring.peek(k), want), label << ": peek(" << k << ") mismatched at token " << i);
+        }
+        const lust::lexer::Token token = ring.consume();
+        TEST_CHECK_OK_MSG(same_token(token, expected[std::min(i, expected.size() - 1)]), label << ": consume() mismatched at token " << i);
+    }
+}
+
+void entry() {
+    const std::string_view source(test_data, sizeof(test_data) - 1);
+    lust::lexer::TokenStream reference = lust::lexer::ITokenizer::create(source);
+    const std::vector<lust::lexer::Token> expected = reference_tokens(reference);
+    TEST_CHECK_OK_MSG(expected.size() > lust::lexer::TokenRing::CAPACITY, "The source should need several batches");
+
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        lust::lexer::TokenRing ring(stream);
+        const size_t allocations = g_allocations;
+        check_ring(ring, expected, "stream");
+        TEST_CHECK_OK_MSG(g_allocations == allocations, "The ring allocated " << g_allocations - allocations << " times over a stream");
+    }
+
+    {
+        lust::lexer::TokenStream batch = lust::lexer::ITokenizer::create(source);
+        const lust::lexer::TokenBuffer buffer = batch->tokenize_all();
+        lust::lexer::TokenRing ring(buffer);
+        const size_t allocations = g_allocations;
+        check_ring(ring, expected, "buffer");
+        TEST_CHECK_OK_MSG(g_allocations == allocations, "The ring allocated " << g_allocations - allocations << " times over a buffer");
+    }
+
+    {
+        // A small window makes the stream refill while tokens are buffered, positions stay absolute
+        size_t read_offset = 0;
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader([&](char* buffer, size_t capacity) {
+            const size_t size = std::min<size_t>(std::min<size_t>(capacity, 7), source.size() - read_offset);
+            std::memcpy(buffer, source.data() + read_offset, size);
+            read_offset += size;
+            return size;
+        }, 64);
+        lust::lexer::TokenRing ring(stream);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const lust::lexer::Token& ahead = ring.peek(3);
+            const lust::lexer::Token& want = expected[std::min(i + 3, expected.size() - 1)];
+            const bool has_kept_value = want.type == lust::lexer::TerminalTokenType::IDENT || want.type == lust::lexer::TerminalTokenType::STRING;
+            TEST_CHECK_OK_MSG(ahead.type == want.type && ahead.pos == want.pos && ahead.symbol == want.symbol
+                && (!has_kept_value || ahead.value == want.value), "reader: peek(3) mismatched at token " << i);
+            TEST_CHECK_OK_MSG(ring.consume().type == expected[i].type, "reader: consume() mismatched at token " << i);
+        }
+    }
+
+    {
+        // The ring prefetches far past the two tokens a 64-byte window keeps alive, literal values are copied out
+        std::string literals;
+        for (int i = 0; i < 20; ++i) {
+            literals += "let s" + std::to_string(i) + " = \"literal number " + std::to_string(i) + "\";\n";
+        }
+        size_t read_offset = 0;
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create_from_reader([&](char* buffer, size_t capacity) {
+            const size_t size = std::min<size_t>(capacity, literals.size() - read_offset);
+            std::memcpy(buffer, literals.data() + read_offset, size);
+            read_offset += size;
+            return size;
+        }, 64);
+        auto parser = lust::grammar::IParser::create(stream);
+        auto program = parser->parse();
+        TEST_CHECK_OK_MSG(!parser->is_error_occurred() && program && program->statements.size() == 20, "Parsing from a small window failed");
+        for (size_t i = 0; i < program->statements.size(); ++i) {
+            const auto* var = static_cast<const lust::grammar::ASTNode_VarDecl*>(program->statements[i].get());
+            const auto* literal = static_cast<const lust::grammar::ASTNode_StringExpr*>(var->evaluate_expression.get());
+            TEST_CHECK_OK_MSG(var->identifier.str() == "s" + std::to_string(i) && literal->value == "literal number " + std::to_string(i),
+                "Statement " << i << " decoded '" << literal->value << "' from a small window");
+        }
+    }
+
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        auto parser = lust::grammar::IParser::create(stream);
+        auto program = parser->parse();
+        TEST_CHECK_OK_MSG(!parser->is_error_occurred() && program, "`pub(crate)` should be parsed with lookahead");
+    }
+}
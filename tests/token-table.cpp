@@ -0,0 +1,50 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/lexer/token_table.hpp"
+
+#include <string>
+
+using lust::lexer::TerminalTokenType;
+using lust::lexer::TokenKind;
+
+void entry() {
+    // Every spelling of the table lexes back to its own type
+    for (const lust::lexer::TokenSpec& spec : lust::lexer::token_specs) {
+        if (spec.kind == TokenKind::OTHER || spec.type == TerminalTokenType::COMMENT || spec.type == TerminalTokenType::DQ) {
+            continue;
+        }
+
+        const std::string source = std::string(spec.spelling) + " x";
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create(source);
+        const lust::lexer::Token token = stream->next_token();
+        TEST_CHECK_OK_MSG(token.type == spec.type && token.value == spec.spelling,
+            "'" << spec.spelling << "' lexed as " << lust::lexer::token_type_to_string(token.type) << " '" << token.value << "'");
+        TEST_CHECK_OK_MSG(stream->next_token().type == TerminalTokenType::IDENT, "'" << spec.spelling << "' ate the next token");
+    }
+
+    // Longest match, then a new token
+    {
+        lust::lexer::TokenStream stream = lust::lexer::ITokenizer::create("a/=b..=c->d#[e]---f");
+        const TerminalTokenType expected[] = {
+            TerminalTokenType::IDENT, TerminalTokenType::SLASH_EQUAL, TerminalTokenType::IDENT, TerminalTokenType::RANGEEQ,
+            TerminalTokenType::IDENT, TerminalTokenType::ARROW, TerminalTokenType::IDENT, TerminalTokenType::ATTRIBUTE_START,
+            TerminalTokenType::IDENT, TerminalTokenType::RBRACKET, TerminalTokenType::MINUSMINUS, TerminalTokenType::MINUS,
+            TerminalTokenType::IDENT, TerminalTokenType::END,
+        };
+        for (TerminalTokenType type : expected) {
+            const lust::lexer::Token token = stream->next_token();
+            TEST_CHECK_OK_MSG(token.type == type, "Expected " << lust::lexer::token_type_to_string(type) << ", found '" << token.value << "'");
+        }
+    }
+
+    // Names and classes come from the same table
+    TEST_CHECK_OK_MSG(std::string_view(lust::lexer::token_type_to_string(TerminalTokenType::GLOBAL_ATTRIBUTE_START)) == "GLOBAL_ATTRIBUTE_START", "Name mismatched");
+    TEST_CHECK_OK_MSG(std::string_view(lust::lexer::token_type_to_string(TerminalTokenType::RETURN)) == "RETURN", "Keyword name mismatched");
+    TEST_CHECK_OK_MSG(lust::lexer::is_unary_token(TerminalTokenType::NOT) && lust::lexer::is_unary_token(TerminalTokenType::BITINV)
+        && !lust::lexer::is_unary_token(TerminalTokenType::PLUS), "Unary classes mismatched");
+    TEST_CHECK_OK_MSG(lust::lexer::is_assignment_token(TerminalTokenType::SLASH_EQUAL) && !lust::lexer::is_assignment_token(TerminalTokenType::EQEQ),
+        "Assignment classes mismatched");
+    TEST_CHECK_OK_MSG(lust::lexer::lookup_keyword("not") == TerminalTokenType::NOT && lust::lexer::lookup_keyword("nothing") == TerminalTokenType::IDENT,
+        "Keywords mismatched");
+}
@@ -0,0 +1,109 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/lexer.hpp"
+#include "lust/simd_scan.hpp"
+#include "lust/utf8.hpp"
+
+#include <random>
+#include <string>
+
+size_t decode_length(std::string_view bytes) {
+    uint32_t code_point = 0;
+    return lust::utf8::decode(bytes.data(), bytes.data() + bytes.size(), code_point);
+}
+
+void check_decoder() {
+    uint32_t code_point = 0;
+    const std::string_view euro = "\xE2\x82\xAC";
+    TEST_CHECK_OK_MSG(lust::utf8::decode(euro.data(), euro.data() + euro.size(), code_point) == 3 && code_point == 0x20AC, "Failed to decode U+20AC");
+    TEST_CHECK_OK_MSG(decode_length("\xF4\x8F\xBF\xBF") == 4, "U+10FFFF is valid");
+
+    TEST_CHECK_OK_MSG(decode_length("\xC0\x80") == 0, "Overlong 2 byte form accepted");
+    TEST_CHECK_OK_MSG(decode_length("\xE0\x80\x80") == 0, "Overlong 3 byte form accepted");
+    TEST_CHECK_OK_MSG(decode_length("\xF0\x80\x80\x80") == 0, "Overlong 4 byte form accepted");
+    TEST_CHECK_OK_MSG(decode_length("\xED\xA0\x80") == 0, "Surrogate accepted");
+    TEST_CHECK_OK_MSG(decode_length("\xF4\x90\x80\x80") == 0, "Code point above U+10FFFF accepted");
+    TEST_CHECK_OK_MSG(decode_length("\xE2\x82") == 0, "Cut sequence accepted");
+    TEST_CHECK_OK_MSG(decode_length("\x80") == 0, "Lone continuation accepted");
+}
+
+const char* reference_find_invalid(const char* p, const char* end) {
+    while (p < end) {
+        const size_t length = decode_length(std::string_view(p, end - p));
+        if (length == 0) {
+            return p;
+        }
+        p += length;
+    }
+    return end;
+}
+
+void check_validator() {
+    const std::string_view alphabet[] = { "a", "let ", "\n", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xE5\x8F\x98" };
+    const char corruptions[] = { '\x80', '\xBF', '\xC0', '\xC2', '\xE0', '\xED', '\xF0', '\xF4', '\xF5', '\xFF', 'a' };
+
+    std::mt19937 rng(11);
+    const lust::simd::SimdLevel supported = lust::simd::detect_simd_level();
+
+    for (int trial = 0; trial < 2000; ++trial) {
+        std::string text;
+        const size_t pieces = std::uniform_int_distribution<size_t>(0, 80)(rng);
+        for (size_t i = 0; i < pieces; ++i) {
+            text += alphabet[std::uniform_int_distribution<size_t>(0, std::size(alphabet) - 1)(rng)];
+        }
+        // Corrupt a byte most of the time, sometimes cut the text in the middle of a sequence
+        if (!text.empty() && trial % 4 != 0) {
+            text[std::uniform_int_distribution<size_t>(0, text.size() - 1)(rng)] = corruptions[std::uniform_int_distribution<size_t>(0, std::size(corruptions) - 1)(rng)];
+        }
+        if (!text.empty() && trial % 5 == 0) {
+            text.resize(std::uniform_int_distribution<size_t>(0, text.size())(rng));
+        }
+
+        const char* const begin = text.data();
+        const char* const end = begin + text.size();
+        const char* const expected = reference_find_invalid(begin, end);
+
+        for (uint32_t level = 0; level <= static_cast<uint32_t>(supported); ++level) {
+            lust::simd::set_simd_level(static_cast<lust::simd::SimdLevel>(level));
+            const char* const actual = lust::simd::find_invalid_utf8(begin, end);
+            TEST_CHECK_OK_MSG(actual == expected, "Validator mismatched at level " << lust::simd::simd_level_to_name(static_cast<lust::simd::SimdLevel>(level))
+                << ": " << (actual - begin) << " vs " << (expected - begin) << " in " << text.size() << " bytes");
+        }
+    }
+
+    lust::simd::set_simd_level(supported);
+}
+
+void check_tokenizer() {
+    {
+        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create("let \xE5\x8F\x98\xE9\x87\x8F_1 = \xCF\x80;");
+        TEST_CHECK_OK_MSG(tokens->next_token().type == lust::lexer::TerminalTokenType::LET, "Expected LET");
+        lust::lexer::Token ident = tokens->next_token();
+        TEST_CHECK_OK_MSG(ident.type == lust::lexer::TerminalTokenType::IDENT && ident.value == "\xE5\x8F\x98\xE9\x87\x8F_1", "Unicode identifier not lexed: " << ident.value);
+        TEST_CHECK_OK_MSG(tokens->next_token().type == lust::lexer::TerminalTokenType::EQ, "Expected EQ");
+        lust::lexer::Token pi = tokens->next_token();
+        TEST_CHECK_OK_MSG(pi.type == lust::lexer::TerminalTokenType::IDENT && pi.value == "\xCF\x80", "Greek identifier not lexed");
+    }
+
+    {
+        // U+2192 RIGHTWARDS ARROW isn't an identifier character
+        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create("a\xE2\x86\x92" "b");
+        TEST_CHECK_OK_MSG(tokens->next_token().value == "a", "Identifier should stop before a symbol");
+        TEST_CHECK_OK_MSG(tokens->next_token().type == lust::lexer::TerminalTokenType::ERROR, "A symbol should be an unexpected character");
+    }
+
+    {
+        lust::lexer::TokenStream tokens = lust::lexer::ITokenizer::create("let s = \"ab\xFF\";");
+        tokens->next_token();
+        tokens->next_token();
+        tokens->next_token();
+        lust::lexer::Token error = tokens->next_token();
+        TEST_CHECK_OK_MSG(error.type == lust::lexer::TerminalTokenType::ERROR && error.pos == 11, "Invalid UTF-8 in a string should be an error at its position");
+    }
+}
+
+void entry() {
+    check_decoder();
+    check_validator();
+    check_tokenizer();
+}
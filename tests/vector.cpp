@@ -0,0 +1,70 @@
+#include "assert.hpp"
+#include "single_file_test.hpp"
+#include "lust/container/simple_string.hpp"
+#include "lust/container/unique_ptr.hpp"
+#include "lust/container/vector.hpp"
+#include "lust/grammar.hpp"
+
+#include <stdexcept>
+
+void entry() {
+    using namespace lust;
+
+    // An empty vector owns nothing and iterates over nothing
+    vector<uint32_t> empty;
+    TEST_CHECK_OK_MSG(empty.data() == nullptr && empty.capacity() == 0 && empty.begin() == empty.end(), "Default constructor should not allocate.");
+    vector<const grammar::IASTNode*> nodes = grammar::ASTNode_Program().collect_self_nodes();
+    TEST_CHECK_OK_MSG(nodes.empty() && nodes.capacity() == 0, "An empty child list should not allocate.");
+
+    vector<uint32_t> numbers;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        numbers.push_back(i);
+    }
+    TEST_CHECK_OK_MSG(numbers.size() == 1000 && numbers.capacity() >= 1000 && numbers[999] == 999 && numbers.back() == 999, "push_back failed.");
+    numbers.pop_back();
+    TEST_CHECK_OK_MSG(numbers.size() == 999 && numbers.end() - numbers.begin() == 999, "pop_back failed.");
+
+    bool threw = false;
+    try {
+        numbers.at(999);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    TEST_CHECK_OK_MSG(threw, "at() should check the bounds.");
+
+    // Appending an element of the vector itself while it grows
+    vector<simple_string> strings;
+    strings.push_back("a string long enough to live on the heap");
+    while (strings.size() < strings.capacity()) {
+        strings.push_back("filler");
+    }
+    strings.push_back(strings[0]);
+    TEST_CHECK_OK_MSG(strings.back() == "a string long enough to live on the heap", "Appending an element of the vector itself failed.");
+
+    vector<simple_string> copy(strings);
+    TEST_CHECK_OK_MSG(copy.size() == strings.size() && copy[0] == strings[0] && copy.data() != strings.data(), "Copy constructor failed.");
+
+    vector<simple_string> sliced = copy.slice(1, 3);
+    TEST_CHECK_OK_MSG(sliced.size() == 2 && sliced[0] == "filler", "slice() failed.");
+
+    const size_t total = copy.size() + sliced.size();
+    copy.extend(std::move(sliced));
+    TEST_CHECK_OK_MSG(copy.size() == total && copy.back() == "filler", "extend() failed.");
+
+    vector<simple_string> moved(std::move(copy));
+    TEST_CHECK_OK_MSG(moved.size() == total && copy.empty() && copy.data() == nullptr, "Move constructor failed.");
+
+    moved.resize(2);
+    TEST_CHECK_OK_MSG(moved.size() == 2 && moved[1] == "filler", "Shrinking resize() failed.");
+    moved.resize(4);
+    TEST_CHECK_OK_MSG(moved.size() == 4 && moved[3].is_empty(), "Growing resize() should value-initialize.");
+    moved.clear();
+    TEST_CHECK_OK_MSG(moved.empty() && moved.capacity() >= 4, "clear() should keep the storage.");
+
+    // Move-only elements
+    vector<UniquePtr<simple_string>> owned;
+    for (int i = 0; i < 10; ++i) {
+        owned.push_back(make_unique<simple_string>("owned"));
+    }
+    TEST_CHECK_OK_MSG(owned.size() == 10 && owned[9].get() != nullptr, "Move-only push_back failed.");
+}